@@ -0,0 +1,170 @@
+#include "AllocationTracker.h"
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#ifdef _WINDOWS
+	#include <Windows.h>
+#else
+	#include <execinfo.h>
+#endif
+
+using namespace std;
+
+#define ALLOCATION_SKIP_FRAMES 3 //CaptureStack, RecordCallsite and operator new
+#ifdef _WINDOWS
+	#define ALLOCATION_NOINLINE __declspec(noinline)
+#else
+	#define ALLOCATION_NOINLINE __attribute__((noinline))
+#endif
+
+//AllocationCallsite - one sampled call stack and what was allocated from it
+struct AllocationCallsite {
+	unsigned int hash; //0 marks an empty slot
+	int depth;
+	void* stack[ALLOCATION_STACK_DEPTH];
+	unsigned long long samples;
+	unsigned long long bytes;
+};
+
+//AllocationThread - everything operator new touches, kept per thread so it needs no lock
+struct AllocationThread {
+	AllocationStats stats;
+	unsigned int sampleEvery;
+	unsigned int untilSample;
+	bool recording; //set while a stack is captured, so allocations made by the capture itself are not sampled
+	unsigned long long droppedSamples; //samples whose stack did not fit in the table
+	AllocationCallsite callsites[ALLOCATION_MAX_CALLSITES];
+};
+
+//Zero initialised without a constructor, so it is usable from the first allocation of every thread
+static thread_local AllocationThread allocationThread;
+
+static ALLOCATION_NOINLINE int CaptureStack(void** stack, int depth) {
+#ifdef _WINDOWS
+	return CaptureStackBackTrace(ALLOCATION_SKIP_FRAMES, depth, stack, nullptr);
+#else
+	void* frames[ALLOCATION_STACK_DEPTH + ALLOCATION_SKIP_FRAMES];
+	int captured = backtrace(frames, depth + ALLOCATION_SKIP_FRAMES) - ALLOCATION_SKIP_FRAMES;
+	if (captured <= 0) {
+		return 0;
+	}
+	memcpy(stack, frames + ALLOCATION_SKIP_FRAMES, captured * sizeof(void*));
+	return captured;
+#endif
+}
+
+static ALLOCATION_NOINLINE void RecordCallsite(AllocationThread& thread, size_t size) {
+	thread.recording = true;
+	void* stack[ALLOCATION_STACK_DEPTH];
+	int depth = CaptureStack(stack, ALLOCATION_STACK_DEPTH);
+	thread.recording = false;
+
+	unsigned int hash = 2166136261u;
+	for (int i = 0; i < depth; i++) {
+		hash = (hash ^ (unsigned int)(size_t)stack[i]) * 16777619u;
+	}
+	hash |= 1;
+	//Open addressing, a stack that finds no free slot in the whole table is dropped
+	for (int probe = 0; probe < ALLOCATION_MAX_CALLSITES; probe++) {
+		AllocationCallsite& callsite = thread.callsites[(hash + probe) % ALLOCATION_MAX_CALLSITES];
+		if (callsite.hash == 0) {
+			callsite.hash = hash;
+			callsite.depth = depth;
+			memcpy(callsite.stack, stack, depth * sizeof(void*));
+		}
+		else if (callsite.hash != hash || callsite.depth != depth || memcmp(callsite.stack, stack, depth * sizeof(void*)) != 0) {
+			continue;
+		}
+		callsite.samples++;
+		callsite.bytes += size;
+		return;
+	}
+	thread.droppedSamples++;
+}
+
+void* operator new(size_t size) {
+	AllocationThread& thread = allocationThread;
+	thread.stats.allocations++;
+	thread.stats.bytes += size;
+	if (thread.sampleEvery != 0 && !thread.recording && --thread.untilSample == 0) {
+		thread.untilSample = thread.sampleEvery;
+		RecordCallsite(thread, size);
+	}
+	void* memory = malloc(size ? size : 1);
+	if (memory == nullptr) {
+		throw bad_alloc();
+	}
+	return memory;
+}
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+void operator delete(void* memory) noexcept {
+	if (memory != nullptr) {
+		allocationThread.stats.frees++;
+	}
+	free(memory);
+}
+void operator delete[](void* memory) noexcept {
+	operator delete(memory);
+}
+void operator delete(void* memory, size_t) noexcept { //sized forms, so compilers that call them still count the free
+	operator delete(memory);
+}
+void operator delete[](void* memory, size_t) noexcept {
+	operator delete(memory);
+}
+
+AllocationStats ThreadAllocationStats() {
+	return allocationThread.stats;
+}
+
+void SetAllocationSampling(unsigned int every) {
+	allocationThread.sampleEvery = every;
+	allocationThread.untilSample = every;
+}
+
+void ResetAllocationCallsites() {
+	memset(allocationThread.callsites, 0, sizeof(allocationThread.callsites));
+	allocationThread.droppedSamples = 0;
+}
+
+void PrintAllocationCallsites(FILE* out, int top) {
+	AllocationThread& thread = allocationThread;
+	unsigned int every = thread.sampleEvery;
+	thread.sampleEvery = 0; //printing allocates, keep it out of the table
+
+	//Selection of the top entries straight from the table, so nothing is copied
+	bool printed[ALLOCATION_MAX_CALLSITES] = { false };
+	unsigned long long total = 0;
+	for (int i = 0; i < ALLOCATION_MAX_CALLSITES; i++) {
+		total += thread.callsites[i].samples;
+	}
+	fprintf(out, "allocation callsites: %llu samples, %llu more dropped because the table was full\n", total, thread.droppedSamples);
+	for (int rank = 0; rank < top; rank++) {
+		int best = -1;
+		for (int i = 0; i < ALLOCATION_MAX_CALLSITES; i++) {
+			if (thread.callsites[i].samples > 0 && !printed[i] && (best < 0 || thread.callsites[i].samples > thread.callsites[best].samples)) {
+				best = i;
+			}
+		}
+		if (best < 0) {
+			break;
+		}
+		printed[best] = true;
+		const AllocationCallsite& callsite = thread.callsites[best];
+		fprintf(out, "  #%d  %llu samples, %llu bytes\n", rank + 1, callsite.samples, callsite.bytes);
+#ifdef _WINDOWS
+		for (int i = 0; i < callsite.depth; i++) {
+			fprintf(out, "        %p\n", callsite.stack[i]);
+		}
+#else
+		char** symbols = backtrace_symbols(callsite.stack, callsite.depth);
+		for (int i = 0; i < callsite.depth; i++) {
+			fprintf(out, "        %s\n", symbols != nullptr ? symbols[i] : "?");
+		}
+		free(symbols);
+#endif
+	}
+	thread.sampleEvery = every;
+}
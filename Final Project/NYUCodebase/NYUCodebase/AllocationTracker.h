@@ -0,0 +1,45 @@
+
+#pragma once
+
+#include <stdio.h>
+
+/*
+ *
+ * Allocation tracking - the global operator new/delete count every allocation of the calling thread, and can record
+ * the call stack of every Nth allocation so a report can show where a frame's allocations come from.
+ * Counters and samples are per thread, so the capture writer and loader threads never show up in the game's numbers.
+ *
+ */
+
+#define ALLOCATION_MAX_CALLSITES 256 //distinct call stacks kept, later ones are only counted
+#define ALLOCATION_STACK_DEPTH 10 //frames kept for each call stack
+
+//AllocationStats - allocations made by a thread since it started
+struct AllocationStats {
+	unsigned long long allocations;
+	unsigned long long bytes;
+	unsigned long long frees;
+};
+
+/* ThreadAllocationStats()
+	\description - Counters of the calling thread, take the difference of two reads to count a frame or a pass
+*/
+AllocationStats ThreadAllocationStats();
+
+/* SetAllocationSampling()
+	\description - Records the call stack of every Nth allocation the calling thread makes
+	\param every - sample interval, 1 records every allocation and 0 stops sampling
+*/
+void SetAllocationSampling(unsigned int every);
+
+/* ResetAllocationCallsites()
+	\description - Forgets the call stacks sampled so far on the calling thread
+*/
+void ResetAllocationCallsites();
+
+/* PrintAllocationCallsites()
+	\description - Prints the call stacks sampled on the calling thread, most allocations first
+	\param out   - where to print
+	\param top   - number of call stacks to print
+*/
+void PrintAllocationCallsites(FILE* out, int top);
@@ -0,0 +1,194 @@
+#include "AssetLoader.h"
+#include "AssetPack.h"
+#include "Profiler.h"
+#include <algorithm>
+
+using namespace std;
+
+AssetLoader::AssetLoader(int threads) : stopping(false) {
+	int cores = (int)thread::hardware_concurrency();
+	if (cores > 0) {
+		threads = min(threads, cores);
+	}
+	for (int i = 0; i < threads; i++) {
+		workers.push_back(thread(&AssetLoader::Work, this));
+	}
+}
+
+AssetLoader::~AssetLoader() {
+	{
+		lock_guard<mutex> guard(lock);
+		stopping = true;
+		queue.clear();
+	}
+	queued.notify_all();
+	for (size_t i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+	for (size_t i = 0; i < slots.size(); i++) {
+		textureCache.Free(slots[i].image);
+		if (slots[i].sound != nullptr) {
+			Mix_FreeChunk(slots[i].sound);
+		}
+		if (slots[i].music != nullptr) {
+			Mix_FreeMusic(slots[i].music);
+		}
+	}
+}
+
+AssetHandle AssetLoader::QueueImage(const char* filePath) {
+	return Enqueue(ASSET_IMAGE, filePath);
+}
+
+AssetHandle AssetLoader::QueueSound(const char* filePath) {
+	return Enqueue(ASSET_SOUND, filePath);
+}
+
+AssetHandle AssetLoader::QueueMusic(const char* filePath) {
+	return Enqueue(ASSET_MUSIC, filePath);
+}
+
+AssetHandle AssetLoader::Enqueue(AssetType type, const char* filePath) {
+	AssetSlot slot;
+	slot.type = type;
+	slot.filePath = filePath;
+	slot.ready = false;
+	slot.image.pixels = nullptr;
+	slot.image.mapping = nullptr;
+	slot.sound = nullptr;
+	slot.music = nullptr;
+	AssetHandle handle;
+	{
+		lock_guard<mutex> guard(lock);
+		handle = slots.size();
+		slots.push_back(slot);
+		if (!workers.empty()) {
+			queue.push_back(handle);
+		}
+	}
+	if (workers.empty()) { //no pool, load it now
+		Load(handle);
+	}
+	else {
+		queued.notify_one();
+	}
+	return handle;
+}
+
+//Runs on a worker (or the caller with no pool), the slot's fields are only written back once the load is done
+void AssetLoader::Load(AssetHandle handle) {
+	AssetType type;
+	string filePath;
+	{
+		lock_guard<mutex> guard(lock);
+		type = slots[handle].type;
+		filePath = slots[handle].filePath;
+	}
+	DecodedImage image;
+	image.pixels = nullptr;
+	image.mapping = nullptr;
+	Mix_Chunk* sound = nullptr;
+	Mix_Music* music = nullptr;
+	if (type == ASSET_IMAGE) {
+		PROFILE_ZONE("LoadImage");
+		textureCache.Load(filePath.c_str(), image);
+	}
+	else if (type == ASSET_SOUND) {
+		PROFILE_ZONE("LoadSound");
+		lock_guard<mutex> guard(mixerLock);
+		AssetSpan packed = assetPack.Find(filePath.c_str());
+		if (packed.data != nullptr) {
+			sound = Mix_LoadWAV_RW(SDL_RWFromConstMem(packed.data, (int)packed.size), 1);
+		}
+		else {
+			sound = Mix_LoadWAV(filePath.c_str());
+		}
+	}
+	else {
+		PROFILE_ZONE("LoadMusic");
+		lock_guard<mutex> guard(mixerLock);
+		AssetSpan packed = assetPack.Find(filePath.c_str());
+		if (packed.data != nullptr) { //the music streams from the pack while it plays, the pack stays mapped until exit
+			music = Mix_LoadMUS_RW(SDL_RWFromConstMem(packed.data, (int)packed.size), 1);
+		}
+		else {
+			music = Mix_LoadMUS(filePath.c_str());
+		}
+	}
+	{
+		lock_guard<mutex> guard(lock);
+		AssetSlot& slot = slots[handle];
+		slot.image = image;
+		slot.sound = sound;
+		slot.music = music;
+		slot.ready = true;
+	}
+	finished.notify_all();
+}
+
+void AssetLoader::Work() {
+	while (true) {
+		AssetHandle handle;
+		{
+			unique_lock<mutex> guard(lock);
+			queued.wait(guard, [this] { return stopping || !queue.empty(); });
+			if (stopping) {
+				return;
+			}
+			handle = queue.front();
+			queue.pop_front();
+		}
+		Load(handle);
+	}
+}
+
+bool AssetLoader::Ready(AssetHandle handle) {
+	lock_guard<mutex> guard(lock);
+	return slots[handle].ready;
+}
+
+void AssetLoader::Wait(AssetHandle handle) {
+	unique_lock<mutex> guard(lock);
+	finished.wait(guard, [this, handle] { return slots[handle].ready; });
+}
+
+void AssetLoader::WaitAll() {
+	unique_lock<mutex> guard(lock);
+	finished.wait(guard, [this] {
+		for (size_t i = 0; i < slots.size(); i++) {
+			if (!slots[i].ready) {
+				return false;
+			}
+		}
+		return true;
+	});
+}
+
+DecodedImage AssetLoader::TakeImage(AssetHandle handle) {
+	Wait(handle);
+	lock_guard<mutex> guard(lock);
+	DecodedImage image = slots[handle].image;
+	slots[handle].image.pixels = nullptr;
+	slots[handle].image.mapping = nullptr;
+	return image;
+}
+
+Mix_Chunk* AssetLoader::TakeSound(AssetHandle handle) {
+	Wait(handle);
+	lock_guard<mutex> guard(lock);
+	Mix_Chunk* sound = slots[handle].sound;
+	slots[handle].sound = nullptr;
+	return sound;
+}
+
+Mix_Music* AssetLoader::TakeMusic(AssetHandle handle) {
+	Wait(handle);
+	lock_guard<mutex> guard(lock);
+	Mix_Music* music = slots[handle].music;
+	slots[handle].music = nullptr;
+	return music;
+}
+
+int AssetLoader::Threads() const {
+	return workers.size();
+}
@@ -0,0 +1,107 @@
+
+#pragma once
+
+#include <SDL_mixer.h>
+#include "TextureCache.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define ASSET_LOADER_THREADS 4 //most worker threads, fewer on machines with fewer cores
+
+//AssetHandle - a load started by an AssetLoader, like a future: check Ready or Wait, then Take the result once
+typedef int AssetHandle;
+
+//AssetLoader - decodes images and loads sounds and music on a pool of worker threads.
+//Decoded pixels wait in the loader until the GL thread takes them and uploads them, so nothing here touches OpenGL.
+class AssetLoader {
+public:
+	/* AssetLoader()
+		\description   - Constructor, starts the worker threads
+		\param threads - worker threads (capped at the machine's cores), 0 to load everything on the calling thread as it is asked for
+	*/
+	AssetLoader(int threads);
+
+	/* ~AssetLoader()
+		\description - Drops loads that have not started, waits for the ones that have and frees anything that was never taken
+	*/
+	~AssetLoader();
+
+	/* QueueImage()
+		\description    - Queues an image to be loaded as RGBA (through textureCache, so usually without decoding it)
+		\param filePath - image file
+	*/
+	AssetHandle QueueImage(const char* filePath);
+
+	/* QueueSound()
+		\description    - Queues a sound effect (Mix_LoadWAV), audio must already be open
+		\param filePath - sound file
+	*/
+	AssetHandle QueueSound(const char* filePath);
+
+	/* QueueMusic()
+		\description    - Queues a song (Mix_LoadMUS), audio must already be open
+		\param filePath - music file
+	*/
+	AssetHandle QueueMusic(const char* filePath);
+
+	/* Ready()
+		\description - True once the load has finished, successfully or not
+	*/
+	bool Ready(AssetHandle handle);
+
+	/* Wait()
+		\description - Blocks until the load has finished
+	*/
+	void Wait(AssetHandle handle);
+
+	/* WaitAll()
+		\description - Blocks until every load queued so far has finished
+	*/
+	void WaitAll();
+
+	/* TakeImage()
+		\description - Hands over a finished image, the caller frees it with textureCache.Free (or gives it to a TextureAtlas).
+		               Its pixels are NULL if the image could not be loaded
+	*/
+	DecodedImage TakeImage(AssetHandle handle);
+
+	/* TakeSound()
+		\description - Hands over a finished sound, the caller frees it with Mix_FreeChunk. NULL if it could not be loaded
+	*/
+	Mix_Chunk* TakeSound(AssetHandle handle);
+
+	/* TakeMusic()
+		\description - Hands over a finished song, the caller frees it with Mix_FreeMusic. NULL if it could not be loaded
+	*/
+	Mix_Music* TakeMusic(AssetHandle handle);
+
+	int Threads() const;
+private:
+	enum AssetType { ASSET_IMAGE, ASSET_SOUND, ASSET_MUSIC };
+	//AssetSlot - one queued load and, once it is ready, its result
+	struct AssetSlot {
+		AssetType type;
+		std::string filePath;
+		bool ready;
+		DecodedImage image;
+		Mix_Chunk* sound;
+		Mix_Music* music;
+	};
+
+	AssetHandle Enqueue(AssetType type, const char* filePath);
+	void Load(AssetHandle handle);
+	void Work();
+
+	std::deque<AssetSlot> slots; //a deque so slots never move while a worker fills one in
+	std::deque<AssetHandle> queue; //loads no worker has started yet
+	std::vector<std::thread> workers;
+	std::mutex lock; //guards slots, queue and stopping
+	std::condition_variable queued; //a load was queued, or the loader is stopping
+	std::condition_variable finished; //a load finished
+	std::mutex mixerLock; //SDL_mixer loads one file at a time, it sets up its decoders on first use without locking
+	bool stopping;
+};
@@ -0,0 +1,198 @@
+#include "Benchmark.h"
+#include "Simulation.h"
+#include "AllocationTracker.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+
+using namespace std;
+
+/*
+ *
+ * Inputs
+ *
+ */
+
+//BenchmarkOptions - what the benchmark was asked to run
+struct BenchmarkOptions {
+	int ticks;
+	unsigned int seed;
+	bool randomInput; //random buttons instead of the scripted players
+	int guns[2]; //gun forced on each player at the start of every match, -1 to keep the default
+};
+
+unsigned char ScriptedButtons(const SimState& state, int player) {
+	const SimCharacter& self = state.players[player];
+	const SimCharacter& other = state.players[1 - player];
+	unsigned char buttons = 0;
+	float distance = other.position[0] - self.position[0];
+	if (distance > 0.5f) {
+		buttons |= INPUT_RIGHT;
+	}
+	else if (distance < -0.5f) {
+		buttons |= INPUT_LEFT;
+	}
+	if (self.collisionFlags[1] || self.collisionFlags[2]) {
+		buttons |= INPUT_JUMP;
+	}
+	if (fabs(distance) < 12.0f) {
+		buttons |= INPUT_SHOOT;
+	}
+	return buttons;
+}
+
+//Random player: holds a random set of movement and shoot buttons, changing every 100 ticks
+static unsigned char RandomButtons(SimRandom& random, unsigned int tick, unsigned char& held) {
+	if (tick % 100 == 0) {
+		held = (unsigned char)(SimulationRandom(random) & (INPUT_LEFT | INPUT_RIGHT | INPUT_JUMP | INPUT_SHOOT));
+	}
+	return held;
+}
+
+static void StartMatch(SimState& state, const BenchmarkOptions& options, int match) {
+	SimulationInit(state, options.seed + match);
+	for (int player = 0; player < 2; player++) {
+		if (options.guns[player] >= 0) {
+			SimulationSetGun(state, player, options.guns[player]);
+		}
+	}
+}
+
+/*
+ *
+ * Benchmark passes
+ *
+ */
+
+//BenchmarkResult - totals from one pass over options.ticks ticks
+struct BenchmarkResult {
+	double seconds;
+	double phaseSeconds[4]; //move, shoot, collision, cleanup
+	int matches;
+	unsigned long long shots;
+	int peakBullets;
+	unsigned long long allocations;
+	unsigned long long allocatedBytes;
+	unsigned int checksum;
+};
+
+//Runs every tick with SimulationTick, or phase by phase with a timer around each phase when timePhases is set
+static BenchmarkResult RunPass(const BenchmarkOptions& options, bool timePhases) {
+	typedef chrono::high_resolution_clock Clock;
+	BenchmarkResult result;
+	memset(&result, 0, sizeof(result));
+
+	SimState state;
+	SimEvents events;
+	SimInput input;
+	SimRandom inputRandom;
+	inputRandom.state = options.seed * 2654435761u + 1;
+	unsigned char held[2] = { 0, 0 };
+	StartMatch(state, options, 0);
+	result.checksum = 2166136261u;
+
+	AllocationStats allocationsBefore = ThreadAllocationStats();
+	Clock::time_point start = Clock::now();
+	for (int tick = 0; tick < options.ticks; tick++) {
+		for (int player = 0; player < 2; player++) {
+			input.buttons[player] = options.randomInput ? RandomButtons(inputRandom, tick, held[player]) : ScriptedButtons(state, player);
+		}
+		if (timePhases) {
+			Clock::time_point t0 = Clock::now();
+			SimulationMovePlayers(state, input);
+			Clock::time_point t1 = Clock::now();
+			SimulationShoot(state, input, events);
+			Clock::time_point t2 = Clock::now();
+			SimulationMoveBullets(state);
+			Clock::time_point t3 = Clock::now();
+			SimulationCollision(state);
+			Clock::time_point t4 = Clock::now();
+			SimulationCleanup(state);
+			Clock::time_point t5 = Clock::now();
+			result.phaseSeconds[0] += chrono::duration<double>((t1 - t0) + (t3 - t2)).count(); //players and bullets both count as move
+			result.phaseSeconds[1] += chrono::duration<double>(t2 - t1).count();
+			result.phaseSeconds[2] += chrono::duration<double>(t4 - t3).count();
+			result.phaseSeconds[3] += chrono::duration<double>(t5 - t4).count();
+		}
+		else {
+			SimulationTick(state, input, events);
+		}
+		result.shots += (events.shotSound[0] != GUN_SOUND_NONE) + (events.shotSound[1] != GUN_SOUND_NONE);
+		if ((int)state.bullets.size() > result.peakBullets) {
+			result.peakBullets = state.bullets.size();
+		}
+		if (SimulationWinner(state) != 0) { //start a rematch on the next seed
+			result.checksum = result.checksum * 16777619u ^ SimulationChecksum(state);
+			result.matches++;
+			StartMatch(state, options, result.matches);
+		}
+	}
+	result.seconds = chrono::duration<double>(Clock::now() - start).count();
+	AllocationStats allocationsAfter = ThreadAllocationStats();
+	result.allocations = allocationsAfter.allocations - allocationsBefore.allocations;
+	result.allocatedBytes = allocationsAfter.bytes - allocationsBefore.bytes;
+	result.checksum = result.checksum * 16777619u ^ SimulationChecksum(state);
+	return result;
+}
+
+int RunBenchmark(int argc, char* argv[]) {
+	BenchmarkOptions options;
+	options.ticks = 1000000;
+	options.seed = 1;
+	options.randomInput = false;
+	options.guns[0] = -1;
+	options.guns[1] = -1;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--bench") == 0) {
+			if (i + 1 < argc && argv[i + 1][0] != '-') {
+				options.ticks = atoi(argv[++i]);
+			}
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			options.seed = (unsigned int)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+			options.randomInput = (strcmp(argv[++i], "random") == 0);
+		}
+		else if (strcmp(argv[i], "--gun1") == 0 && i + 1 < argc) {
+			options.guns[0] = atoi(argv[++i]) % GUN_COUNT;
+		}
+		else if (strcmp(argv[i], "--gun2") == 0 && i + 1 < argc) {
+			options.guns[1] = atoi(argv[++i]) % GUN_COUNT;
+		}
+		else {
+			fprintf(stderr, "unknown benchmark argument: %s\n", argv[i]);
+			return 1;
+		}
+	}
+	if (options.ticks <= 0) {
+		fprintf(stderr, "tick count must be positive\n");
+		return 1;
+	}
+
+	BenchmarkResult throughput = RunPass(options, false); //untimed phases so the timers do not slow down ticks/s
+	BenchmarkResult phases = RunPass(options, true);
+
+	printf("{\n");
+	printf("  \"ticks\": %d,\n", options.ticks);
+	printf("  \"seed\": %u,\n", options.seed);
+	printf("  \"input\": \"%s\",\n", options.randomInput ? "random" : "scripted");
+	printf("  \"guns\": [%d, %d],\n", options.guns[0], options.guns[1]);
+	printf("  \"seconds\": %.6f,\n", throughput.seconds);
+	printf("  \"ticks_per_second\": %.1f,\n", options.ticks / throughput.seconds);
+	printf("  \"matches_finished\": %d,\n", throughput.matches);
+	printf("  \"shots\": %llu,\n", throughput.shots);
+	printf("  \"peak_bullets\": %d,\n", throughput.peakBullets);
+	printf("  \"phase_ns_per_tick\": {\"move\": %.2f, \"shoot\": %.2f, \"collision\": %.2f, \"bullet_cleanup\": %.2f},\n",
+		1e9 * phases.phaseSeconds[0] / options.ticks, 1e9 * phases.phaseSeconds[1] / options.ticks,
+		1e9 * phases.phaseSeconds[2] / options.ticks, 1e9 * phases.phaseSeconds[3] / options.ticks);
+	printf("  \"allocations\": %llu,\n", throughput.allocations);
+	printf("  \"allocated_bytes\": %llu,\n", throughput.allocatedBytes);
+	printf("  \"allocations_per_tick\": %.4f,\n", (double)throughput.allocations / options.ticks);
+	printf("  \"checksum\": \"%08x\",\n", throughput.checksum);
+	printf("  \"deterministic\": %s\n", (throughput.checksum == phases.checksum) ? "true" : "false");
+	printf("}\n");
+	return (throughput.checksum == phases.checksum) ? 0 : 2;
+}
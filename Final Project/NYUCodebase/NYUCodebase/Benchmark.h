@@ -0,0 +1,18 @@
+
+#pragma once
+
+#include "Simulation.h"
+
+/* RunBenchmark()
+	\description - Runs scripted matches through the simulation core without a window and prints the results as JSON
+	\param argc  - argument count from main
+	\param argv  - arguments from main: --bench [ticks] [--seed n] [--input scripted|random] [--gun1 n] [--gun2 n]
+*/
+int RunBenchmark(int argc, char* argv[]);
+
+/* ScriptedButtons()
+	\description  - Buttons for a scripted player: walks towards the other player, jumps when it runs into a wall and shoots when it is close enough
+	\param state  - current simulation state
+	\param player - index of the player to control (0 or 1)
+*/
+unsigned char ScriptedButtons(const SimState& state, int player);
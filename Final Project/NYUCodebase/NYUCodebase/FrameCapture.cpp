@@ -0,0 +1,357 @@
+#include "FrameCapture.h"
+#include "stb_image.h"
+#include "Profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifdef _WINDOWS
+	#include <direct.h>
+#endif
+
+using namespace std;
+
+/*
+ *
+ * PNG writing
+ *
+ */
+
+static unsigned int crcTable[256];
+
+static bool BuildCrcTable() {
+	for (unsigned int n = 0; n < 256; n++) {
+		unsigned int c = n;
+		for (int k = 0; k < 8; k++) {
+			c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+		}
+		crcTable[n] = c;
+	}
+	return true;
+}
+
+static unsigned int Crc(unsigned int crc, const unsigned char* data, size_t length) {
+	for (size_t i = 0; i < length; i++) {
+		crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return crc;
+}
+
+static void PutBigEndian(vector<unsigned char>& out, unsigned int value) {
+	out.push_back((unsigned char)(value >> 24));
+	out.push_back((unsigned char)(value >> 16));
+	out.push_back((unsigned char)(value >> 8));
+	out.push_back((unsigned char)value);
+}
+
+static void WriteChunk(FILE* file, const char* type, const vector<unsigned char>& data) {
+	vector<unsigned char> header;
+	PutBigEndian(header, (unsigned int)data.size());
+	header.insert(header.end(), type, type + 4);
+	unsigned int crc = Crc(0xFFFFFFFFu, header.data() + 4, 4);
+	crc = Crc(crc, data.data(), data.size()) ^ 0xFFFFFFFFu;
+	vector<unsigned char> footer;
+	PutBigEndian(footer, crc);
+	fwrite(header.data(), 1, header.size(), file);
+	fwrite(data.data(), 1, data.size(), file);
+	fwrite(footer.data(), 1, footer.size(), file);
+}
+
+bool WritePNG(const char* path, const unsigned char* pixels, int width, int height, bool flip) {
+	static const bool tableBuilt = BuildCrcTable(); //built once, even when the writer thread gets here first
+	(void)tableBuilt;
+	FILE* file = fopen(path, "wb");
+	if (file == nullptr) {
+		return false;
+	}
+	const unsigned char signature[8] = { 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+	fwrite(signature, 1, 8, file);
+
+	vector<unsigned char> header;
+	PutBigEndian(header, width);
+	PutBigEndian(header, height);
+	header.push_back(8); //bit depth
+	header.push_back(6); //RGBA
+	header.push_back(0);
+	header.push_back(0);
+	header.push_back(0);
+	WriteChunk(file, "IHDR", header);
+
+	//Every row is filter byte 0 followed by the pixels, wrapped in a zlib stream of stored blocks
+	size_t rowBytes = (size_t)width * 4;
+	vector<unsigned char> raw;
+	raw.reserve((rowBytes + 1) * height);
+	for (int y = 0; y < height; y++) {
+		const unsigned char* row = pixels + rowBytes * (flip ? height - 1 - y : y);
+		raw.push_back(0);
+		raw.insert(raw.end(), row, row + rowBytes);
+	}
+	vector<unsigned char> data;
+	data.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+	data.push_back(0x78);
+	data.push_back(0x01);
+	size_t offset = 0;
+	do {
+		size_t block = raw.size() - offset < 65535 ? raw.size() - offset : 65535;
+		data.push_back(offset + block == raw.size() ? 1 : 0);
+		data.push_back((unsigned char)block);
+		data.push_back((unsigned char)(block >> 8));
+		data.push_back((unsigned char)~block);
+		data.push_back((unsigned char)(~block >> 8));
+		data.insert(data.end(), raw.begin() + offset, raw.begin() + offset + block);
+		offset += block;
+	} while (offset < raw.size());
+	unsigned int a = 1;
+	unsigned int b = 0;
+	for (size_t i = 0; i < raw.size(); i++) {
+		a = (a + raw[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+	PutBigEndian(data, (b << 16) | a);
+	WriteChunk(file, "IDAT", data);
+	WriteChunk(file, "IEND", vector<unsigned char>());
+	bool ok = !ferror(file);
+	fclose(file);
+	return ok;
+}
+
+/*
+ *
+ * FrameCapture
+ *
+ */
+
+bool PrepareCaptureDirectory(const string& directory) {
+#ifdef _WINDOWS
+	_mkdir(directory.c_str());
+#else
+	mkdir(directory.c_str(), 0755);
+#endif
+	FILE* manifest = fopen((directory + "/frames.txt").c_str(), "w"); //Finish writes the real manifest over it
+	if (manifest == nullptr) {
+		fprintf(stderr, "FrameCapture: unable to write in %s\n", directory.c_str());
+		return false;
+	}
+	fclose(manifest);
+	return true;
+}
+
+FrameCapture::FrameCapture(int width, int height, const string& directory, int every) : width(width), height(height), directory(directory),
+	every(every > 0 ? every : 1), frame(0), next(0), failed(0), stopping(false), finished(false) {
+	glGenBuffers(PBO_COUNT, buffers);
+	for (int i = 0; i < PBO_COUNT; i++) {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers[i]);
+		glBufferData(GL_PIXEL_PACK_BUFFER, width * height * 4, nullptr, GL_STREAM_READ);
+		bufferFrame[i] = -1;
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	writer = thread(&FrameCapture::WriterLoop, this);
+}
+
+FrameCapture::~FrameCapture() {
+	Finish();
+	glDeleteBuffers(PBO_COUNT, buffers);
+}
+
+void FrameCapture::Capture() {
+	if (finished) {
+		return;
+	}
+	if (frame++ % every != 0) {
+		return;
+	}
+	if (bufferFrame[next] != -1) { //the oldest frame is still in this buffer, pass it on before reusing it
+		Collect(next);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers[next]);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr); //returns straight away, the copy happens on the GPU
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	bufferFrame[next] = frame - 1;
+	next = (next + 1) % PBO_COUNT;
+}
+
+void FrameCapture::Collect(int slot) {
+	WriteJob job;
+	char name[32];
+	sprintf(name, "frame_%05d.png", bufferFrame[slot]);
+	job.name = name;
+	job.path = directory + "/" + name;
+	job.pixels.resize(width * height * 4);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers[slot]);
+	const unsigned char* mapped = (const unsigned char*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+	if (mapped != nullptr) {
+		memcpy(job.pixels.data(), mapped, job.pixels.size());
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	bufferFrame[slot] = -1;
+	if (mapped == nullptr) {
+		return;
+	}
+	unique_lock<mutex> lock(queueLock);
+	queue.push_back(move(job));
+	queueChanged.notify_one();
+}
+
+void FrameCapture::Finish() {
+	if (finished) {
+		return;
+	}
+	finished = true;
+	for (int i = 0; i < PBO_COUNT; i++) { //oldest first so frames reach the writer in order
+		int slot = (next + i) % PBO_COUNT;
+		if (bufferFrame[slot] != -1) {
+			Collect(slot);
+		}
+	}
+	{
+		unique_lock<mutex> lock(queueLock);
+		stopping = true;
+		queueChanged.notify_one();
+	}
+	writer.join();
+
+	FILE* manifest = fopen((directory + "/frames.txt").c_str(), "w");
+	if (manifest == nullptr) {
+		fprintf(stderr, "FrameCapture: unable to write %s/frames.txt\n", directory.c_str());
+		return;
+	}
+	for (size_t i = 0; i < written.size(); i++) {
+		fprintf(manifest, "%s\n", written[i].c_str());
+	}
+	fclose(manifest);
+}
+
+int FrameCapture::Written() const {
+	unique_lock<mutex> lock(queueLock);
+	return written.size();
+}
+
+int FrameCapture::Failed() const {
+	unique_lock<mutex> lock(queueLock);
+	return failed;
+}
+
+void FrameCapture::WriterLoop() {
+	while (true) {
+		WriteJob job;
+		{
+			unique_lock<mutex> lock(queueLock);
+			while (queue.empty() && !stopping) {
+				queueChanged.wait(lock);
+			}
+			if (queue.empty()) { //stopping and nothing left to write
+				return;
+			}
+			job = move(queue.front());
+			queue.pop_front();
+		}
+		PROFILE_ZONE("WritePNG");
+		bool ok = WritePNG(job.path.c_str(), job.pixels.data(), width, height, true);
+		if (!ok) {
+			fprintf(stderr, "FrameCapture: unable to write %s\n", job.path.c_str());
+		}
+		unique_lock<mutex> lock(queueLock);
+		if (ok) { //only frames that reached the disk go in frames.txt
+			written.push_back(job.name);
+		}
+		else {
+			failed++;
+		}
+	}
+}
+
+/*
+ *
+ * Golden image comparison
+ *
+ */
+
+int RunCompare(int argc, char* argv[]) {
+	const char* golden = nullptr;
+	const char* captured = nullptr;
+	int tolerance = 2; //largest per channel difference that still counts as the same pixel
+	double maxBadPixels = 0.0; //fraction of pixels allowed to be over the tolerance
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--compare") == 0 && i + 2 < argc) {
+			golden = argv[++i];
+			captured = argv[++i];
+		}
+		else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+			tolerance = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--max-bad-pixels") == 0 && i + 1 < argc) {
+			maxBadPixels = atof(argv[++i]);
+		}
+		else {
+			fprintf(stderr, "unknown compare argument: %s\n", argv[i]);
+			return 1;
+		}
+	}
+	if (golden == nullptr) {
+		fprintf(stderr, "usage: --compare <golden dir> <capture dir> [--tolerance n] [--max-bad-pixels fraction]\n");
+		return 1;
+	}
+
+	FILE* manifest = fopen((string(golden) + "/frames.txt").c_str(), "r");
+	if (manifest == nullptr) {
+		fprintf(stderr, "no frames.txt in %s\n", golden);
+		return 1;
+	}
+	int compared = 0;
+	int failed = 0;
+	int worstDifference = 0;
+	char name[256];
+	while (fscanf(manifest, "%255s", name) == 1) {
+		string goldenPath = string(golden) + "/" + name;
+		string capturedPath = string(captured) + "/" + name;
+		int gw, gh, cw, ch, comp;
+		unsigned char* expected = stbi_load(goldenPath.c_str(), &gw, &gh, &comp, STBI_rgb_alpha);
+		unsigned char* actual = stbi_load(capturedPath.c_str(), &cw, &ch, &comp, STBI_rgb_alpha);
+		compared++;
+		if (expected == nullptr || actual == nullptr || gw != cw || gh != ch) {
+			fprintf(stderr, "%s: missing or a different size\n", name);
+			failed++;
+		}
+		else {
+			//Pixels over the tolerance are painted red in the diff image, matching pixels are a dimmed copy of the golden frame
+			vector<unsigned char> diff(gw * gh * 4);
+			int badPixels = 0;
+			for (int p = 0; p < gw * gh; p++) {
+				int largest = 0;
+				for (int c = 0; c < 4; c++) {
+					int difference = abs(expected[p * 4 + c] - actual[p * 4 + c]);
+					if (difference > largest) {
+						largest = difference;
+					}
+				}
+				if (largest > worstDifference) {
+					worstDifference = largest;
+				}
+				bool bad = largest > tolerance;
+				badPixels += bad;
+				diff[p * 4 + 0] = bad ? 255 : expected[p * 4 + 0] / 4;
+				diff[p * 4 + 1] = bad ? 0 : expected[p * 4 + 1] / 4;
+				diff[p * 4 + 2] = bad ? 0 : expected[p * 4 + 2] / 4;
+				diff[p * 4 + 3] = 255;
+			}
+			if (badPixels > maxBadPixels * gw * gh) {
+				fprintf(stderr, "%s: %d pixels over tolerance %d\n", name, badPixels, tolerance);
+				WritePNG((string(captured) + "/diff_" + name).c_str(), diff.data(), gw, gh, false);
+				failed++;
+			}
+		}
+		stbi_image_free(expected);
+		stbi_image_free(actual);
+	}
+	fclose(manifest);
+
+	printf("{\n");
+	printf("  \"compared\": %d,\n", compared);
+	printf("  \"failed\": %d,\n", failed);
+	printf("  \"tolerance\": %d,\n", tolerance);
+	printf("  \"worst_difference\": %d\n", worstDifference);
+	printf("}\n");
+	return (failed == 0 && compared > 0) ? 0 : 3;
+}
@@ -0,0 +1,96 @@
+
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL.h>
+#include <SDL_opengl.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//FrameCapture - reads frames back through a ring of pixel buffer objects and writes them as PNGs on a background thread
+class FrameCapture {
+public:
+	/* FrameCapture()
+		\description     - Constructor (needs a current GL context)
+		\param width     - width of the framebuffer being captured
+		\param height    - height of the framebuffer being captured
+		\param directory - directory the frames are written to as frame_NNNNN.png, see PrepareCaptureDirectory
+		\param every     - capture one frame out of every this many
+	*/
+	FrameCapture(int width, int height, const std::string& directory, int every = 1);
+
+	/* ~FrameCapture()
+		\description - Destructor, finishes any frames still in flight
+	*/
+	~FrameCapture();
+
+	/* Capture()
+		\description - Call once per frame after Draw and before the swap. Starts reading the frame into a pixel buffer
+		               and hands the frame read PBO_COUNT captures ago to the writer thread.
+	*/
+	void Capture();
+
+	/* Finish()
+		\description - Collects every frame still in a pixel buffer, waits for the writer and writes frames.txt listing the captures
+	*/
+	void Finish();
+
+	int Written() const; //frames the writer has written so far
+	int Failed() const; //frames the writer was unable to write
+private:
+	//WriteJob - one frame waiting for the writer thread (rows are bottom-up, as glReadPixels returns them)
+	struct WriteJob {
+		std::string name;
+		std::string path;
+		std::vector<unsigned char> pixels;
+	};
+
+	void Collect(int slot);
+	void WriterLoop();
+
+	static const int PBO_COUNT = 3; //a frame is mapped two captures after it was read, by then the GPU is done with it
+	int width;
+	int height;
+	std::string directory;
+	int every;
+	int frame;
+	GLuint buffers[PBO_COUNT];
+	int bufferFrame[PBO_COUNT]; //frame number held by each buffer, -1 when empty
+	int next; //buffer the next capture reads into
+
+	std::thread writer;
+	mutable std::mutex queueLock; //guards queue, written and failed, which the writer thread updates
+	std::condition_variable queueChanged;
+	std::deque<WriteJob> queue;
+	std::vector<std::string> written; //names of the frames written, in the order they were written
+	int failed;
+	bool stopping;
+	bool finished;
+};
+
+/* PrepareCaptureDirectory()
+	\description - Creates directory if it is missing and checks that files can be written in it
+	\return      - false (after printing why) if frames could not be captured there
+*/
+bool PrepareCaptureDirectory(const std::string& directory);
+
+/* WritePNG()
+	\description  - Writes RGBA pixels to a PNG file (stored deflate blocks, no compression, so writing stays cheap)
+	\param path   - file to write
+	\param pixels - width * height RGBA pixels
+	\param flip   - true if the rows are bottom-up (glReadPixels order)
+*/
+bool WritePNG(const char* path, const unsigned char* pixels, int width, int height, bool flip);
+
+/* RunCompare()
+	\description - Compares captured frames against golden frames and writes diff_frame_NNNNN.png for the ones that differ
+	\param argc  - argument count from main
+	\param argv  - arguments from main: --compare <golden dir> <capture dir> [--tolerance n] [--max-bad-pixels fraction]
+*/
+int RunCompare(int argc, char* argv[]);
@@ -0,0 +1,78 @@
+#include "FrameScratch.h"
+#include <stdlib.h>
+#include <new>
+
+using namespace std;
+
+FrameScratch frameScratch(FRAME_SCRATCH_BYTES);
+
+FrameScratch::FrameScratch(size_t capacity) : current(0), capacity(capacity), used(0), framePeak(0), lastFramePeak(0), peak(0), overflows(0) {
+	for (int i = 0; i < 2; i++) {
+		buffers[i] = (char*)malloc(capacity); //malloc aligns for every fundamental type
+		if (buffers[i] == nullptr) {
+			throw bad_alloc();
+		}
+	}
+}
+
+FrameScratch::~FrameScratch() {
+	free(buffers[0]);
+	free(buffers[1]);
+}
+
+void FrameScratch::BeginFrame() {
+	lastFramePeak = framePeak;
+	current = 1 - current;
+	used = 0;
+	framePeak = 0;
+}
+
+void* FrameScratch::Allocate(size_t size, size_t alignment) {
+	size_t start = (used + alignment - 1) & ~(alignment - 1);
+	if (start + size > capacity) {
+		overflows++;
+		void* memory = malloc(size ? size : 1);
+		if (memory == nullptr) {
+			throw bad_alloc();
+		}
+		return memory;
+	}
+	used = start + size;
+	if (used > framePeak) {
+		framePeak = used;
+		if (used > peak) {
+			peak = used;
+		}
+	}
+	return buffers[current] + start;
+}
+
+void FrameScratch::Deallocate(void* memory, size_t size) {
+	char* bytes = (char*)memory;
+	bool inBuffer = false;
+	for (int i = 0; i < 2; i++) {
+		inBuffer = inBuffer || (bytes >= buffers[i] && bytes < buffers[i] + capacity);
+	}
+	if (!inBuffer) { //an overflow allocation
+		free(memory);
+	}
+	else if (bytes + size == buffers[current] + used) {
+		used = bytes - buffers[current];
+	}
+}
+
+size_t FrameScratch::Capacity() const {
+	return capacity;
+}
+
+size_t FrameScratch::FramePeak() const {
+	return lastFramePeak;
+}
+
+size_t FrameScratch::Peak() const {
+	return peak;
+}
+
+int FrameScratch::Overflows() const {
+	return overflows;
+}
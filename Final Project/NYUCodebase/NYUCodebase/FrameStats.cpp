@@ -0,0 +1,94 @@
+#include "FrameStats.h"
+#include <string.h>
+
+using namespace std;
+
+static const char* phaseNames[FRAME_PHASES] = { "update", "draw", "swap", "total" };
+
+FrameStats::FrameStats(float budget, int history) : budget(budget), frames(0), hitchCount(0), recent(history > 0 ? history : 1), recentNext(0) {
+	memset(buckets, 0, sizeof(buckets));
+	memset(maximum, 0, sizeof(maximum));
+	hitches.reserve(FRAME_MAX_HITCHES);
+	hitchHistory.reserve(FRAME_MAX_HITCHES * recent.size());
+}
+
+void FrameStats::Record(float update, float draw, float swap, int mode) {
+	FrameSample sample;
+	sample.frame = frames++;
+	sample.mode = mode;
+	sample.milliseconds[FRAME_UPDATE] = update;
+	sample.milliseconds[FRAME_DRAW] = draw;
+	sample.milliseconds[FRAME_SWAP] = swap;
+	sample.milliseconds[FRAME_TOTAL] = update + draw + swap;
+	for (int phase = 0; phase < FRAME_PHASES; phase++) {
+		int bucket = (int)(sample.milliseconds[phase] / FRAME_BUCKET_MS);
+		buckets[phase][bucket < FRAME_BUCKETS ? bucket : FRAME_BUCKETS - 1]++;
+		if (sample.milliseconds[phase] > maximum[phase]) {
+			maximum[phase] = sample.milliseconds[phase];
+		}
+	}
+	recent[recentNext] = sample;
+	recentNext = (recentNext + 1) % recent.size();
+
+	if (sample.milliseconds[FRAME_TOTAL] > budget) {
+		hitchCount++;
+		if (hitches.size() < FRAME_MAX_HITCHES) { //copying the ring is the only work done on a hitch, printing waits for the summary
+			FrameHitch hitch;
+			hitch.frame = sample;
+			hitch.historyStart = (int)hitchHistory.size();
+			hitch.historyCount = frames < (int)recent.size() ? frames : recent.size();
+			for (int i = hitch.historyCount; i > 0; i--) {
+				hitchHistory.push_back(recent[(recentNext - i + recent.size()) % recent.size()]);
+			}
+			hitches.push_back(hitch);
+		}
+	}
+}
+
+float FrameStats::Percentile(int phase, float fraction) const {
+	if (frames == 0) {
+		return 0;
+	}
+	unsigned int target = (unsigned int)(fraction * frames);
+	if (target >= (unsigned int)frames) {
+		target = frames - 1;
+	}
+	unsigned int seen = 0;
+	for (int bucket = 0; bucket < FRAME_BUCKETS; bucket++) {
+		seen += buckets[phase][bucket];
+		if (seen > target) {
+			float upper = (float)((bucket + 1) * FRAME_BUCKET_MS); //report the top of the bucket, never more than the real max
+			return upper < maximum[phase] ? upper : maximum[phase];
+		}
+	}
+	return maximum[phase];
+}
+
+void FrameStats::PrintSummary(FILE* out, const char* const* modeNames) const {
+	fprintf(out, "frame times over %d frames (budget %.2f ms, %d hitches)\n", frames, budget, hitchCount);
+	fprintf(out, "  %-7s %8s %8s %8s %8s\n", "phase", "p50", "p95", "p99", "max");
+	for (int phase = 0; phase < FRAME_PHASES; phase++) {
+		fprintf(out, "  %-7s %8.2f %8.2f %8.2f %8.2f\n", phaseNames[phase], Percentile(phase, 0.50f), Percentile(phase, 0.95f),
+			Percentile(phase, 0.99f), maximum[phase]);
+	}
+	for (size_t i = 0; i < hitches.size(); i++) {
+		const FrameHitch& hitch = hitches[i];
+		fprintf(out, "hitch at frame %d in %s: %.2f ms\n", hitch.frame.frame, modeNames[hitch.frame.mode], hitch.frame.milliseconds[FRAME_TOTAL]);
+		for (int j = hitch.historyStart; j < hitch.historyStart + hitch.historyCount; j++) {
+			const FrameSample& sample = hitchHistory[j];
+			fprintf(out, "    frame %6d %-14s update %7.2f  draw %7.2f  swap %7.2f\n", sample.frame, modeNames[sample.mode],
+				sample.milliseconds[FRAME_UPDATE], sample.milliseconds[FRAME_DRAW], sample.milliseconds[FRAME_SWAP]);
+		}
+	}
+	if (hitchCount > (int)hitches.size()) {
+		fprintf(out, "(%d more hitches not shown)\n", hitchCount - (int)hitches.size());
+	}
+}
+
+int FrameStats::Frames() const {
+	return frames;
+}
+
+int FrameStats::Hitches() const {
+	return hitchCount;
+}
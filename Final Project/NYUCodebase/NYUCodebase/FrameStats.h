@@ -0,0 +1,71 @@
+
+#pragma once
+
+#include <stdio.h>
+#include <vector>
+
+//Phases of a frame that FrameStats keeps histograms for
+#define FRAME_UPDATE 0
+#define FRAME_DRAW 1
+#define FRAME_SWAP 2
+#define FRAME_TOTAL 3
+#define FRAME_PHASES 4
+
+#define FRAME_BUCKET_MS 0.1 //width of a histogram bucket
+#define FRAME_BUCKETS 1000 //buckets cover 0-100ms, slower frames land in the last bucket (max stays exact)
+#define FRAME_MAX_HITCHES 32 //hitch snapshots kept for the summary, later hitches are only counted
+
+//FrameSample - how long each phase of one frame took
+struct FrameSample {
+	int frame;
+	int mode; //game mode once the frame's Update was done
+	float milliseconds[FRAME_PHASES];
+};
+
+//FrameHitch - a frame over budget and the frames leading up to it
+struct FrameHitch {
+	FrameSample frame;
+	int historyStart; //index of the oldest frame in FrameStats' hitch history, which ends with the hitch frame itself
+	int historyCount;
+};
+
+//FrameStats - histograms of update, draw and swap times and snapshots of frames that went over budget
+class FrameStats {
+public:
+	/* FrameStats()
+		\description   - Constructor
+		\param budget  - frame time in milliseconds above which a frame counts as a hitch
+		\param history - number of frames kept in each hitch snapshot
+	*/
+	FrameStats(float budget, int history);
+
+	/* Record()
+		\description - Adds one frame's phase times (milliseconds) and the game mode it ended in
+	*/
+	void Record(float update, float draw, float swap, int mode);
+
+	/* Percentile()
+		\description - Phase time in milliseconds that the given fraction (0-1) of frames came in under
+	*/
+	float Percentile(int phase, float fraction) const;
+
+	/* PrintSummary()
+		\description    - Prints p50/p95/p99/max for every phase and the hitch snapshots
+		\param out      - where to print
+		\param modeNames - name of each game mode, indexed by mode
+	*/
+	void PrintSummary(FILE* out, const char* const* modeNames) const;
+
+	int Frames() const;
+	int Hitches() const;
+private:
+	float budget;
+	int frames;
+	int hitchCount;
+	unsigned int buckets[FRAME_PHASES][FRAME_BUCKETS];
+	float maximum[FRAME_PHASES];
+	std::vector<FrameSample> recent; //ring of the last history frames
+	int recentNext;
+	std::vector<FrameHitch> hitches;
+	std::vector<FrameSample> hitchHistory; //every snapshot's frames back to back, reserved up front so a hitch never allocates
+};
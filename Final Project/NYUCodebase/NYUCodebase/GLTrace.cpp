@@ -0,0 +1,189 @@
+#include "GLTrace.h"
+
+#ifdef GL_TRACE
+
+#include <string.h>
+#include <vector>
+
+using namespace std;
+
+#define TRACE_MAX_ATTRIBUTES 16
+
+static const char* callNames[TRACE_CALLS] = { "glUseProgram", "glBindTexture", "glUniform*", "glVertexAttribPointer",
+	"glEnable/DisableVertexAttribArray", "glDrawArrays", "glTexImage2D" };
+static const char* patternNames[TRACE_PATTERNS] = { "glUseProgram of the bound program right before glUniform* (ShaderProgram::Set*)",
+	"glUniform* of a value that is already set", "glTexImage2D after the first frame" };
+
+//TraceCounts - calls and redundant calls of every traced entry point, and how often each pattern was seen
+struct TraceCounts {
+	unsigned long long calls[TRACE_CALLS];
+	unsigned long long redundant[TRACE_CALLS];
+	unsigned long long patterns[TRACE_PATTERNS];
+};
+
+//UniformValue - last value uploaded to one uniform of one program
+struct UniformValue {
+	GLuint program;
+	GLint location;
+	int count;
+	GLfloat values[16];
+};
+
+//AttributePointer - what an attribute array currently points at
+struct AttributePointer {
+	GLint size;
+	GLenum type;
+	GLboolean normalized;
+	GLsizei stride;
+	const GLvoid* pointer;
+	bool enabled;
+};
+
+//Shadow copy of the GL state, nothing is ever read back from GL
+static GLuint currentProgram = 0;
+static GLuint currentTexture = 0; //the game only uses texture unit 0 and GL_TEXTURE_2D
+static vector<UniformValue> uniforms;
+static AttributePointer attributes[TRACE_MAX_ATTRIBUTES];
+static bool useProgramPending = false; //the last call was a redundant glUseProgram
+
+static TraceCounts frameCounts;
+static TraceCounts totalCounts;
+static int frames = 0;
+static FILE* frameReport = nullptr;
+
+static void Count(int call, bool redundant) {
+	frameCounts.calls[call]++;
+	if (redundant) {
+		frameCounts.redundant[call]++;
+	}
+	useProgramPending = (call == TRACE_USE_PROGRAM && redundant);
+}
+
+void GLTraceUseProgram(GLuint program) {
+	Count(TRACE_USE_PROGRAM, program == currentProgram);
+	currentProgram = program;
+}
+
+void GLTraceBindTexture(GLenum target, GLuint texture) {
+	bool redundant = (target == GL_TEXTURE_2D && texture == currentTexture);
+	Count(TRACE_BIND_TEXTURE, redundant);
+	if (target == GL_TEXTURE_2D) {
+		currentTexture = texture;
+	}
+}
+
+void GLTraceUniform(GLint location, const GLfloat* values, int count) {
+	if (useProgramPending) {
+		frameCounts.patterns[TRACE_USE_BEFORE_UNIFORM]++;
+	}
+	UniformValue* uniform = nullptr;
+	for (size_t i = 0; i < uniforms.size(); i++) {
+		if (uniforms[i].program == currentProgram && uniforms[i].location == location) {
+			uniform = &uniforms[i];
+			break;
+		}
+	}
+	if (uniform == nullptr) {
+		UniformValue added;
+		added.program = currentProgram;
+		added.location = location;
+		added.count = 0;
+		uniforms.push_back(added);
+		uniform = &uniforms.back();
+	}
+	bool redundant = (uniform->count == count && memcmp(uniform->values, values, count * sizeof(GLfloat)) == 0);
+	Count(TRACE_UNIFORM, redundant);
+	if (redundant) {
+		frameCounts.patterns[TRACE_SAME_UNIFORM]++;
+	}
+	uniform->count = count;
+	memcpy(uniform->values, values, count * sizeof(GLfloat));
+}
+
+void GLTraceVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer) {
+	if (index >= TRACE_MAX_ATTRIBUTES) {
+		Count(TRACE_VERTEX_ATTRIB_POINTER, false);
+		return;
+	}
+	AttributePointer& attribute = attributes[index];
+	bool redundant = (attribute.pointer == pointer && attribute.size == size && attribute.type == type && attribute.normalized == normalized &&
+		attribute.stride == stride);
+	Count(TRACE_VERTEX_ATTRIB_POINTER, redundant);
+	attribute.size = size;
+	attribute.type = type;
+	attribute.normalized = normalized;
+	attribute.stride = stride;
+	attribute.pointer = pointer;
+}
+
+void GLTraceEnableVertexAttribArray(GLuint index, bool enable) {
+	if (index >= TRACE_MAX_ATTRIBUTES) {
+		Count(TRACE_ENABLE_VERTEX_ATTRIB, false);
+		return;
+	}
+	Count(TRACE_ENABLE_VERTEX_ATTRIB, attributes[index].enabled == enable);
+	attributes[index].enabled = enable;
+}
+
+void GLTraceDrawArrays(GLsizei count) {
+	Count(TRACE_DRAW_ARRAYS, count == 0);
+}
+
+void GLTraceTexImage2D() {
+	Count(TRACE_TEX_IMAGE, false);
+	if (frames > 0) {
+		frameCounts.patterns[TRACE_TEXTURE_UPLOAD_IN_FRAME]++;
+	}
+}
+
+void GLTraceEndFrame() {
+	if (frameReport == nullptr) {
+		frameReport = fopen("gltrace_frames.csv", "w");
+		if (frameReport != nullptr) {
+			fprintf(frameReport, "frame");
+			for (int call = 0; call < TRACE_CALLS; call++) {
+				fprintf(frameReport, ",%s,%s redundant", callNames[call], callNames[call]);
+			}
+			fprintf(frameReport, ",useProgram before uniform,same uniform value,texture upload in frame\n");
+		}
+	}
+	if (frameReport != nullptr) {
+		fprintf(frameReport, "%d", frames);
+		for (int call = 0; call < TRACE_CALLS; call++) {
+			fprintf(frameReport, ",%llu,%llu", frameCounts.calls[call], frameCounts.redundant[call]);
+		}
+		for (int pattern = 0; pattern < TRACE_PATTERNS; pattern++) {
+			fprintf(frameReport, ",%llu", frameCounts.patterns[pattern]);
+		}
+		fprintf(frameReport, "\n");
+	}
+	for (int call = 0; call < TRACE_CALLS; call++) {
+		totalCounts.calls[call] += frameCounts.calls[call];
+		totalCounts.redundant[call] += frameCounts.redundant[call];
+	}
+	for (int pattern = 0; pattern < TRACE_PATTERNS; pattern++) {
+		totalCounts.patterns[pattern] += frameCounts.patterns[pattern];
+	}
+	memset(&frameCounts, 0, sizeof(frameCounts));
+	frames++;
+}
+
+void GLTracePrintSummary(FILE* out) {
+	if (frameReport != nullptr) {
+		fflush(frameReport);
+	}
+	int perFrame = frames > 0 ? frames : 1;
+	fprintf(out, "GL calls over %d frames (per frame lines in gltrace_frames.csv)\n", frames);
+	fprintf(out, "  %-34s %12s %12s %10s %10s\n", "call", "calls", "redundant", "redundant%", "per frame");
+	for (int call = 0; call < TRACE_CALLS; call++) {
+		unsigned long long calls = totalCounts.calls[call];
+		fprintf(out, "  %-34s %12llu %12llu %9.1f%% %10.1f\n", callNames[call], calls, totalCounts.redundant[call],
+			calls > 0 ? 100.0 * totalCounts.redundant[call] / calls : 0.0, (double)calls / perFrame);
+	}
+	fprintf(out, "patterns\n");
+	for (int pattern = 0; pattern < TRACE_PATTERNS; pattern++) {
+		fprintf(out, "  %10llu  %s\n", totalCounts.patterns[pattern], patternNames[pattern]);
+	}
+}
+
+#endif
@@ -0,0 +1,56 @@
+
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include <stdio.h>
+
+/*
+ *
+ * GL call tracing - debug builds that define GL_TRACE route every Counted* call (RenderStats.h) through these functions.
+ * They keep a shadow copy of the GL state the game touches and count, per frame, the calls that changed nothing:
+ * binding the program or texture that is already bound, uploading a uniform value that is already set, pointing an
+ * attribute at the array it already reads from, or enabling an attribute array that is already enabled.
+ *
+ */
+
+//Traced GL entry points, in the order the report lists them
+#define TRACE_USE_PROGRAM 0
+#define TRACE_BIND_TEXTURE 1
+#define TRACE_UNIFORM 2
+#define TRACE_VERTEX_ATTRIB_POINTER 3
+#define TRACE_ENABLE_VERTEX_ATTRIB 4
+#define TRACE_DRAW_ARRAYS 5
+#define TRACE_TEX_IMAGE 6
+#define TRACE_CALLS 7
+
+//Patterns the report flags
+#define TRACE_USE_BEFORE_UNIFORM 0 //glUseProgram of the current program straight before a glUniform* (ShaderProgram::Set* does this on every call)
+#define TRACE_SAME_UNIFORM 1 //glUniform* of a value the program already has
+#define TRACE_TEXTURE_UPLOAD_IN_FRAME 2 //glTexImage2D after the first frame
+#define TRACE_PATTERNS 3
+
+#ifdef GL_TRACE
+
+void GLTraceUseProgram(GLuint program);
+void GLTraceBindTexture(GLenum target, GLuint texture);
+void GLTraceUniform(GLint location, const GLfloat* values, int count);
+void GLTraceVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer);
+void GLTraceEnableVertexAttribArray(GLuint index, bool enable);
+void GLTraceDrawArrays(GLsizei count);
+void GLTraceTexImage2D();
+
+/* GLTraceEndFrame()
+	\description - Closes the current frame and writes its line to the per-frame report (gltrace_frames.csv in the working directory)
+*/
+void GLTraceEndFrame();
+
+/* GLTracePrintSummary()
+	\description - Prints the totals over every frame: calls, redundant calls and flagged patterns
+	\param out   - where to print
+*/
+void GLTracePrintSummary(FILE* out);
+
+#endif
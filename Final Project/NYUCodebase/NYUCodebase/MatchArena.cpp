@@ -0,0 +1,66 @@
+#include "MatchArena.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+using namespace std;
+
+MatchArena::MatchArena(size_t capacity) : capacity(capacity), used(0), highWater(0), overflows(0) {
+	block = (char*)malloc(capacity); //malloc aligns for every fundamental type
+	if (block == nullptr) {
+		throw bad_alloc();
+	}
+}
+
+MatchArena::~MatchArena() {
+	Reset();
+	free(block);
+}
+
+void* MatchArena::Allocate(size_t size, size_t alignment) {
+	size_t start = (used + alignment - 1) & ~(alignment - 1);
+	used = start + size;
+	if (used > highWater) {
+		highWater = used;
+	}
+	if (used <= capacity) {
+		return block + start;
+	}
+	overflows++;
+	void* memory = malloc(size + alignment - 1); //room to move the start up to the next multiple of alignment
+	if (memory == nullptr) {
+		throw bad_alloc();
+	}
+	overflowMemory.push_back(memory); //Reset frees what malloc returned, not the aligned start
+	return (void*)(((uintptr_t)memory + alignment - 1) & ~(uintptr_t)(alignment - 1));
+}
+
+void MatchArena::Reset() {
+	for (size_t i = 0; i < overflowMemory.size(); i++) {
+		free(overflowMemory[i]);
+	}
+	overflowMemory.clear();
+	if (highWater > capacity) { //grow now, between matches, rather than overflowing again next match
+		char* grown = (char*)realloc(block, highWater);
+		if (grown != nullptr) {
+			block = grown;
+			capacity = highWater;
+		}
+	}
+	used = 0;
+}
+
+size_t MatchArena::Used() const {
+	return used;
+}
+
+size_t MatchArena::HighWater() const {
+	return highWater;
+}
+
+size_t MatchArena::Capacity() const {
+	return capacity;
+}
+
+int MatchArena::Overflows() const {
+	return overflows;
+}
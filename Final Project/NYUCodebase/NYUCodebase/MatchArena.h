@@ -0,0 +1,55 @@
+
+#pragma once
+
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#define MATCH_ARENA_BYTES 4096 //block reserved for the objects that live as long as a match
+
+//MatchArena - bump allocator for objects that live as long as a match, ending the match frees all of them with one Reset
+class MatchArena {
+public:
+	/* MatchArena()
+		\description    - Constructor, reserves the whole block up front so starting a match does not allocate
+		\param capacity - size of the block in bytes
+	*/
+	MatchArena(size_t capacity);
+	~MatchArena();
+
+	/* New()
+		\description - Constructs a T in the arena. Reset never runs destructors, so T must not need one.
+	*/
+	template <class T, class... Args>
+	T* New(Args&&... args) {
+		static_assert(std::is_trivially_destructible<T>::value, "objects in a MatchArena are never destroyed");
+		return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	/* Allocate()
+		\description     - Takes size bytes from the block. When the block is full the memory comes from the heap instead
+		                   and the next Reset grows the block, so the following match fits again.
+		\param size      - bytes needed
+		\param alignment - alignment needed, a power of two
+	*/
+	void* Allocate(size_t size, size_t alignment);
+
+	/* Reset()
+		\description - Frees everything allocated since the last Reset
+	*/
+	void Reset();
+
+	size_t Used() const; //bytes allocated since the last Reset, alignment padding included
+	size_t HighWater() const; //most bytes that were ever in use at once
+	size_t Capacity() const;
+	int Overflows() const; //allocations that did not fit in the block
+private:
+	char* block;
+	size_t capacity;
+	size_t used;
+	size_t highWater;
+	int overflows;
+	std::vector<void*> overflowMemory; //heap allocations made after the block ran out, freed by Reset
+};
@@ -0,0 +1,148 @@
+#include "PerfOverlay.h"
+#include "FrameScratch.h"
+#include <stdio.h>
+
+#ifdef _WINDOWS
+	#define RESOURCE_FOLDER ""
+#else
+	#define RESOURCE_FOLDER "NYUCodebase.app/Contents/Resources/"
+#endif
+
+#define OVERLAY_LEFT -15.6f
+#define OVERLAY_TOP 7.0f //below the players' health
+#define OVERLAY_TEXT_SIZE 0.5f
+#define OVERLAY_BAR_WIDTH 0.05f
+#define OVERLAY_GRAPH_HEIGHT 1.5f
+
+using namespace std;
+
+PerfOverlay::PerfOverlay(const AtlasSprite& font) : visible(false), font(font), nextFrame(0), recordedFrames(0), lastBullets(0), lastSubsteps(0), lastAllocations(0) {
+	textProgram.Load(RESOURCE_FOLDER"vertex_textured.glsl", RESOURCE_FOLDER"fragment_textured.glsl");
+	graphProgram.Load(RESOURCE_FOLDER"vertex.glsl", RESOURCE_FOLDER"fragment.glsl");
+	identity.Identity();
+	projection.Identity();
+	projection.SetOrthoProjection(-16.0f, 16.0f, -9.0f, 9.0f, -1.0f, 1.0f);
+	textProgram.SetModelMatrix(identity);
+	textProgram.SetViewMatrix(identity);
+	textProgram.SetProjectionMatrix(projection);
+	graphProgram.SetModelMatrix(identity);
+	graphProgram.SetViewMatrix(identity);
+	graphProgram.SetProjectionMatrix(projection);
+	for (int i = 0; i < OVERLAY_GRAPH_FRAMES; i++) {
+		frameTimes[i] = 0;
+	}
+	lastStats = renderStats;
+	textVertices.reserve(6 * 2 * 256);
+	textCoordinates.reserve(6 * 2 * 256);
+	graphVertices.reserve(6 * 2 * (OVERLAY_GRAPH_FRAMES + 1));
+}
+
+PerfOverlay::~PerfOverlay() {
+	textProgram.Cleanup();
+	graphProgram.Cleanup();
+}
+
+void PerfOverlay::Record(float frameMs, const RenderStats& stats, int bullets, int substeps, unsigned int allocations) {
+	frameTimes[nextFrame] = frameMs;
+	nextFrame = (nextFrame + 1) % OVERLAY_GRAPH_FRAMES;
+	if (recordedFrames < OVERLAY_GRAPH_FRAMES) {
+		recordedFrames++;
+	}
+	lastStats = stats;
+	lastBullets = bullets;
+	lastSubsteps = substeps;
+	lastAllocations = allocations;
+}
+
+void PerfOverlay::Toggle() {
+	visible = !visible;
+}
+
+bool PerfOverlay::Visible() const {
+	return visible;
+}
+
+void PerfOverlay::AddQuad(vector<float>& out, float left, float bottom, float right, float top) {
+	float quad[12] = { left, top, left, bottom, right, top, right, bottom, right, top, left, bottom };
+	out.insert(out.end(), quad, quad + 12);
+}
+
+//Same layout as TextEntity::Draw, but every line goes into one vertex array
+void PerfOverlay::AddText(const char* text, float x, float y, float size) {
+	float textureSize = 1 / 16.0f;
+	for (int i = 0; text[i] != '\0'; i++) {
+		int spriteIndex = (unsigned char)text[i];
+		float u = font.U((float)(spriteIndex % 16) / 16.0f);
+		float v = font.V((float)(spriteIndex / 16) / 16.0f);
+		float u2 = font.U((float)(spriteIndex % 16) / 16.0f + textureSize);
+		float v2 = font.V((float)(spriteIndex / 16) / 16.0f + textureSize);
+		float left = x + size * 0.6f * i;
+		AddQuad(textVertices, left - 0.5f * size, y - 0.5f * size, left + 0.5f * size, y + 0.5f * size);
+		float coordinates[12] = { u, v, u, v2, u2, v, u2, v2, u2, v, u, v2 };
+		textCoordinates.insert(textCoordinates.end(), coordinates, coordinates + 12);
+	}
+}
+
+void PerfOverlay::Draw() {
+	if (!visible) {
+		return;
+	}
+	float total = 0;
+	for (int i = 0; i < recordedFrames; i++) {
+		total += frameTimes[i];
+	}
+	float average = recordedFrames > 0 ? total / recordedFrames : 0;
+
+	textVertices.clear();
+	textCoordinates.clear();
+	graphVertices.clear();
+	char line[96];
+	float y = OVERLAY_TOP;
+	sprintf(line, "FPS %5.1f  %6.2f ms", average > 0 ? 1000.0f / average : 0.0f, average);
+	AddText(line, OVERLAY_LEFT, y, OVERLAY_TEXT_SIZE);
+	y -= OVERLAY_TEXT_SIZE * 1.2f;
+	sprintf(line, "draws %u  textures %u  programs %u", lastStats.drawCalls, lastStats.textureBinds, lastStats.programBinds);
+	AddText(line, OVERLAY_LEFT, y, OVERLAY_TEXT_SIZE);
+	y -= OVERLAY_TEXT_SIZE * 1.2f;
+	sprintf(line, "bullets %d  substeps %d", lastBullets, lastSubsteps);
+	AddText(line, OVERLAY_LEFT, y, OVERLAY_TEXT_SIZE);
+	y -= OVERLAY_TEXT_SIZE * 1.2f;
+	sprintf(line, "vertex bytes %u  allocations %u", lastStats.vertexBytes, lastAllocations);
+	AddText(line, OVERLAY_LEFT, y, OVERLAY_TEXT_SIZE);
+	y -= OVERLAY_TEXT_SIZE * 1.2f;
+	sprintf(line, "scratch peak %u bytes", (unsigned int)frameScratch.FramePeak()); //of the previous frame
+	AddText(line, OVERLAY_LEFT, y, OVERLAY_TEXT_SIZE);
+	y -= OVERLAY_TEXT_SIZE * 0.8f;
+
+	//Oldest frame on the left, plus a thin line marking 16.7ms (60fps)
+	float bottom = y - OVERLAY_GRAPH_HEIGHT;
+	for (int i = 0; i < OVERLAY_GRAPH_FRAMES; i++) {
+		float milliseconds = frameTimes[(nextFrame + i) % OVERLAY_GRAPH_FRAMES];
+		float height = (milliseconds < OVERLAY_GRAPH_MS ? milliseconds : OVERLAY_GRAPH_MS) / OVERLAY_GRAPH_MS * OVERLAY_GRAPH_HEIGHT;
+		float left = OVERLAY_LEFT + i * OVERLAY_BAR_WIDTH;
+		AddQuad(graphVertices, left, bottom, left + OVERLAY_BAR_WIDTH * 0.8f, bottom + height);
+	}
+	float budget = bottom + 16.7f / OVERLAY_GRAPH_MS * OVERLAY_GRAPH_HEIGHT;
+	AddQuad(graphVertices, OVERLAY_LEFT, budget, OVERLAY_LEFT + OVERLAY_GRAPH_FRAMES * OVERLAY_BAR_WIDTH, budget + 0.03f);
+	float right = OVERLAY_LEFT + 36 * OVERLAY_TEXT_SIZE * 0.6f; //wide enough for the longest line
+	float background[12] = { OVERLAY_LEFT - 0.4f, OVERLAY_TOP + 0.4f, OVERLAY_LEFT - 0.4f, bottom - 0.2f, right, OVERLAY_TOP + 0.4f,
+		right, bottom - 0.2f, right, OVERLAY_TOP + 0.4f, OVERLAY_LEFT - 0.4f, bottom - 0.2f };
+
+	//Background and graph first, both attribute arrays are left as the game expects them (position and texCoord enabled)
+	CountedDisableVertexAttribArray(textProgram.texCoordAttribute);
+	graphProgram.SetColor(0.0f, 0.0f, 0.0f, 0.6f);
+	CountedVertexAttribPointer(graphProgram.positionAttribute, 2, GL_FLOAT, false, 0, background);
+	CountedEnableVertexAttribArray(graphProgram.positionAttribute);
+	CountedDrawArrays(GL_TRIANGLES, 0, 6);
+	graphProgram.SetColor(0.2f, 1.0f, 0.3f, 0.9f);
+	CountedVertexAttribPointer(graphProgram.positionAttribute, 2, GL_FLOAT, false, 0, graphVertices.data());
+	CountedDrawArrays(GL_TRIANGLES, 0, graphVertices.size() / 2);
+
+	CountedUseProgram(textProgram.programID);
+	CountedBindTexture(GL_TEXTURE_2D, font.texture);
+	CountedVertexAttribPointer(textProgram.positionAttribute, 2, GL_FLOAT, false, 0, textVertices.data());
+	CountedEnableVertexAttribArray(textProgram.positionAttribute);
+	CountedVertexAttribPointer(textProgram.texCoordAttribute, 2, GL_FLOAT, false, 0, textCoordinates.data());
+	CountedEnableVertexAttribArray(textProgram.texCoordAttribute);
+	CountedDrawArrays(GL_TRIANGLES, 0, textVertices.size() / 2);
+}
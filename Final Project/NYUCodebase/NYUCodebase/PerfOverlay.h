@@ -0,0 +1,67 @@
+
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include <vector>
+#include "ShaderProgram.h"
+#include "Matrix.h"
+#include "RenderStats.h"
+#include "TextureAtlas.h"
+
+#define OVERLAY_GRAPH_FRAMES 120 //frames shown in the frame time graph
+#define OVERLAY_GRAPH_MS 33.3f //frame time at the top of the graph
+
+//PerfOverlay - FPS, frame time graph and the last frame's render and simulation counters, drawn in three draw calls whatever the content
+class PerfOverlay {
+public:
+	/* PerfOverlay()
+		\description - Constructor, loads the overlay's own shader programs so it never changes the game's matrices
+		\param font  - font in the atlas (16x16 grid of ASCII characters)
+	*/
+	PerfOverlay(const AtlasSprite& font);
+	~PerfOverlay();
+
+	/* Record()
+		\description    - Stores the counters of a finished frame, call before the overlay draws so its own draw calls are left out
+		\param frameMs  - time the whole frame took in milliseconds
+		\param stats    - GL work of the frame
+		\param bullets  - live bullets in the simulation
+		\param substeps - simulation ticks run during the frame
+		\param allocations - heap allocations made during the frame
+	*/
+	void Record(float frameMs, const RenderStats& stats, int bullets, int substeps, unsigned int allocations);
+
+	/* Draw()
+		\description - Draws the overlay on top of the frame
+	*/
+	void Draw();
+
+	void Toggle();
+	bool Visible() const;
+private:
+	void AddText(const char* text, float x, float y, float size);
+	void AddQuad(std::vector<float>& out, float left, float bottom, float right, float top);
+
+	bool visible;
+	AtlasSprite font;
+	ShaderProgram textProgram;
+	ShaderProgram graphProgram;
+	Matrix identity;
+	Matrix projection;
+
+	float frameTimes[OVERLAY_GRAPH_FRAMES]; //ring of recent frame times
+	int nextFrame;
+	int recordedFrames;
+	RenderStats lastStats;
+	int lastBullets;
+	int lastSubsteps;
+	unsigned int lastAllocations;
+
+	//reused every frame so drawing the overlay does not allocate
+	std::vector<float> textVertices;
+	std::vector<float> textCoordinates;
+	std::vector<float> graphVertices;
+};
@@ -0,0 +1,88 @@
+#include "Profiler.h"
+
+#ifdef PROFILER_ENABLED
+
+#include <stdio.h>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <vector>
+
+using namespace std;
+
+#define PROFILER_RING_SIZE 65536 //zones kept per thread, a power of two
+
+//ProfileEvent - one finished zone
+struct ProfileEvent {
+	const char* name;
+	long long start;
+	long long end;
+};
+
+//ProfileRing - zones recorded by one thread, only that thread writes to it
+struct ProfileRing {
+	int threadId;
+	atomic<unsigned int> count; //zones ever recorded, the ring holds the last PROFILER_RING_SIZE of them
+	ProfileEvent events[PROFILER_RING_SIZE];
+};
+
+static mutex ringsLock; //guards rings, taken once per thread and when exporting
+static vector<ProfileRing*> rings; //rings are never freed so an export can still read threads that have exited
+
+static const chrono::steady_clock::time_point& Epoch() {
+	static const chrono::steady_clock::time_point epoch = chrono::steady_clock::now();
+	return epoch;
+}
+
+static ProfileRing* ThreadRing() {
+	thread_local ProfileRing* ring = nullptr;
+	if (ring == nullptr) {
+		ring = new ProfileRing();
+		ring->count = 0;
+		lock_guard<mutex> lock(ringsLock);
+		ring->threadId = rings.size() + 1;
+		rings.push_back(ring);
+	}
+	return ring;
+}
+
+long long ProfilerNow() {
+	return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - Epoch()).count();
+}
+
+void ProfilerRecord(const char* name, long long start, long long end) {
+	ProfileRing* ring = ThreadRing();
+	unsigned int index = ring->count.load(memory_order_relaxed);
+	ProfileEvent& event = ring->events[index & (PROFILER_RING_SIZE - 1)];
+	event.name = name;
+	event.start = start;
+	event.end = end;
+	ring->count.store(index + 1, memory_order_release);
+}
+
+bool ProfilerExport(const char* path) {
+	FILE* file = fopen(path, "w");
+	if (file == nullptr) {
+		fprintf(stderr, "Profiler: unable to write %s\n", path);
+		return false;
+	}
+	fprintf(file, "{\"traceEvents\":[\n");
+	bool first = true;
+	lock_guard<mutex> lock(ringsLock);
+	for (size_t r = 0; r < rings.size(); r++) {
+		ProfileRing* ring = rings[r];
+		unsigned int count = ring->count.load(memory_order_acquire);
+		unsigned int oldest = count > PROFILER_RING_SIZE ? count - PROFILER_RING_SIZE : 0;
+		for (unsigned int i = oldest; i < count; i++) {
+			const ProfileEvent& event = ring->events[i & (PROFILER_RING_SIZE - 1)];
+			fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", first ? "" : ",\n",
+				event.name, ring->threadId, event.start / 1000.0, (event.end - event.start) / 1000.0);
+			first = false;
+		}
+	}
+	fprintf(file, "\n]}\n");
+	fclose(file);
+	return true;
+}
+
+#endif
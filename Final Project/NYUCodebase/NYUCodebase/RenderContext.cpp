@@ -0,0 +1,232 @@
+#include "RenderContext.h"
+#include "Profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(RENDER_USE_EGL)
+	#include <EGL/egl.h>
+	#include <EGL/eglext.h>
+#elif defined(RENDER_USE_OSMESA)
+	#include <GL/osmesa.h>
+#endif
+
+#ifndef GL_TIME_ELAPSED
+	#define GL_TIME_ELAPSED 0x88BF
+#endif
+#ifndef GL_QUERY_RESULT
+	#define GL_QUERY_RESULT 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE
+	#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+
+RenderContext::RenderContext(int width, int height) : width(width), height(height), window(nullptr), glContext(nullptr), offscreenDisplay(nullptr),
+	offscreenContext(nullptr), offscreenPixels(nullptr), framebuffer(0), colorBuffer(0), timerSupported(false), frame(0), gpuMilliseconds(-1) {
+	for (int i = 0; i < TIMER_QUERIES; i++) {
+		queries[i] = 0;
+		queryPending[i] = false;
+	}
+}
+
+RenderContext* RenderContext::CreateWindowed(const char* title, int width, int height, bool fullscreen) {
+	RenderContext* context = new RenderContext(width, height);
+	context->window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_OPENGL);
+	if (fullscreen) {
+		SDL_SetWindowFullscreen(context->window, SDL_WINDOW_FULLSCREEN);
+	}
+	context->glContext = SDL_GL_CreateContext(context->window);
+	SDL_GL_MakeCurrent(context->window, context->glContext);
+#ifdef _WINDOWS
+	glewInit();
+#endif
+	glViewport(0, 0, width, height);
+	context->InitTimer();
+	return context;
+}
+
+RenderContext* RenderContext::CreateOffscreen(int width, int height) {
+#if defined(RENDER_USE_EGL)
+	//Surfaceless Mesa needs no display server, fall back to the default display for drivers without the extension
+	EGLDisplay display = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay != nullptr) {
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	}
+	if (display == EGL_NO_DISPLAY) {
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+		fprintf(stderr, "RenderContext: unable to initialize EGL\n");
+		return nullptr;
+	}
+	if (!eglBindAPI(EGL_OPENGL_API)) {
+		fprintf(stderr, "RenderContext: EGL has no desktop OpenGL\n");
+		eglTerminate(display);
+		return nullptr;
+	}
+	EGLint configAttributes[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+	EGLConfig config = nullptr;
+	EGLint configCount = 0;
+	eglChooseConfig(display, configAttributes, &config, 1, &configCount); //surfaceless contexts may not need a config at all
+	EGLContext eglContext = eglCreateContext(display, configCount > 0 ? config : (EGLConfig)0, EGL_NO_CONTEXT, nullptr);
+	if (eglContext == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext)) {
+		fprintf(stderr, "RenderContext: unable to create a surfaceless EGL context\n");
+		eglTerminate(display);
+		return nullptr;
+	}
+	RenderContext* context = new RenderContext(width, height);
+	context->offscreenDisplay = display;
+	context->offscreenContext = eglContext;
+#elif defined(RENDER_USE_OSMESA)
+	OSMesaContext osmesaContext = OSMesaCreateContextExt(OSMESA_RGBA, 24, 8, 0, nullptr);
+	if (osmesaContext == nullptr) {
+		fprintf(stderr, "RenderContext: unable to create an OSMesa context\n");
+		return nullptr;
+	}
+	RenderContext* context = new RenderContext(width, height);
+	context->offscreenContext = osmesaContext;
+	context->offscreenPixels = new unsigned char[width * height * 4];
+	if (!OSMesaMakeCurrent(osmesaContext, context->offscreenPixels, GL_UNSIGNED_BYTE, width, height)) {
+		fprintf(stderr, "RenderContext: unable to make the OSMesa context current\n");
+		delete context;
+		return nullptr;
+	}
+#else
+	(void)width; //only the offscreen backends size a framebuffer
+	(void)height;
+	fprintf(stderr, "RenderContext: built without an offscreen backend (define RENDER_USE_EGL or RENDER_USE_OSMESA)\n");
+	return nullptr;
+#endif
+
+#if defined(RENDER_USE_EGL) || defined(RENDER_USE_OSMESA)
+#ifdef _WINDOWS
+	glewInit();
+#endif
+	if (!context->CreateFramebuffer()) {
+		fprintf(stderr, "RenderContext: unable to create a %dx%d framebuffer object\n", width, height);
+		delete context;
+		return nullptr;
+	}
+	glViewport(0, 0, width, height);
+	context->InitTimer();
+	return context;
+#endif
+}
+
+RenderContext::~RenderContext() {
+	if (timerSupported) {
+		glDeleteQueries(TIMER_QUERIES, queries);
+	}
+	if (framebuffer != 0) {
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glDeleteFramebuffers(1, &framebuffer);
+		glDeleteRenderbuffers(1, &colorBuffer);
+	}
+	if (window != nullptr) {
+		SDL_GL_DeleteContext(glContext);
+		SDL_DestroyWindow(window);
+	}
+#if defined(RENDER_USE_EGL)
+	if (offscreenDisplay != nullptr) {
+		eglMakeCurrent((EGLDisplay)offscreenDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext((EGLDisplay)offscreenDisplay, (EGLContext)offscreenContext);
+		eglTerminate((EGLDisplay)offscreenDisplay);
+	}
+#elif defined(RENDER_USE_OSMESA)
+	if (offscreenContext != nullptr) {
+		OSMesaDestroyContext((OSMesaContext)offscreenContext);
+	}
+#endif
+	delete[] offscreenPixels;
+}
+
+//The game never binds a framebuffer itself, so binding this one once makes every Draw() land in it
+bool RenderContext::CreateFramebuffer() {
+	glGenRenderbuffers(1, &colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+	return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+//Timer queries are core in GL 3.3, older contexts need ARB_timer_query or EXT_timer_query
+void RenderContext::InitTimer() {
+	const char* version = (const char*)glGetString(GL_VERSION);
+	const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+	int major = 0;
+	int minor = 0;
+	if (version != nullptr) {
+		sscanf(version, "%d.%d", &major, &minor);
+	}
+	timerSupported = (major > 3 || (major == 3 && minor >= 3)) || (extensions != nullptr && strstr(extensions, "_timer_query") != nullptr);
+	if (timerSupported) {
+		glGenQueries(TIMER_QUERIES, queries);
+	}
+}
+
+bool RenderContext::BeginFrame() {
+	if (!timerSupported) {
+		return false;
+	}
+	bool sampled = false;
+	int current = frame % TIMER_QUERIES;
+	if (queryPending[current]) { //this query is being reused, so collect its result first
+		GLint available = 0;
+		glGetQueryObjectiv(queries[current], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available && frame > TIMER_QUERIES) { //the first frame's result is skipped, it includes driver warm up (llvmpipe reports garbage for it)
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(queries[current], GL_QUERY_RESULT, &nanoseconds);
+			gpuMilliseconds = nanoseconds / 1000000.0;
+			sampled = true;
+		}
+		queryPending[current] = false;
+	}
+	glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+	return sampled;
+}
+
+void RenderContext::EndFrame() {
+	if (!timerSupported) {
+		return;
+	}
+	glEndQuery(GL_TIME_ELAPSED);
+	queryPending[frame % TIMER_QUERIES] = true;
+	frame++;
+}
+
+void RenderContext::Swap() {
+	PROFILE_ZONE("SwapWindow");
+	if (window != nullptr) {
+		SDL_GL_SwapWindow(window);
+	}
+	else {
+		glFlush(); //hand the frame to the rasterizer the way a swap would
+	}
+}
+
+double RenderContext::GpuMilliseconds() const {
+	return gpuMilliseconds;
+}
+
+bool RenderContext::HasGpuTimer() const {
+	return timerSupported;
+}
+
+bool RenderContext::IsOffscreen() const {
+	return window == nullptr;
+}
+
+int RenderContext::Width() const {
+	return width;
+}
+
+int RenderContext::Height() const {
+	return height;
+}
+
+GLuint RenderContext::Framebuffer() const {
+	return framebuffer;
+}
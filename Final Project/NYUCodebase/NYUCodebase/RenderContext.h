@@ -0,0 +1,86 @@
+
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL.h>
+#include <SDL_opengl.h>
+
+/*
+ *
+ * Offscreen backends, pick one at build time for machines with no GPU or display:
+ *   RENDER_USE_EGL    - EGL surfaceless context (Mesa llvmpipe with EGL_PLATFORM=surfaceless), link libEGL and libOpenGL
+ *   RENDER_USE_OSMESA - OSMesa software context, link libOSMesa
+ * Without either one CreateOffscreen() fails and only the SDL window is available.
+ *
+ */
+
+//RenderContext - owns the GL context that the game draws into, either an SDL window or an offscreen framebuffer object
+class RenderContext {
+public:
+	/* CreateWindowed()
+		\description      - Creates an SDL window with a GL context (SDL_Init(SDL_INIT_VIDEO) must already have been called)
+		\param title      - window title
+		\param width      - width of the window in pixels
+		\param height     - height of the window in pixels
+		\param fullscreen - true to switch the window to fullscreen
+	*/
+	static RenderContext* CreateWindowed(const char* title, int width, int height, bool fullscreen);
+
+	/* CreateOffscreen()
+		\description - Creates a software GL context with no window and binds a width x height framebuffer object to draw into.
+		               Returns nullptr if no offscreen backend was compiled in or the context could not be created.
+	*/
+	static RenderContext* CreateOffscreen(int width, int height);
+
+	~RenderContext();
+
+	/* BeginFrame()
+		\description - Starts the GPU timer for this frame (if timer queries are available)
+		\return      - true if an earlier frame's timer query finished, so GpuMilliseconds is a new sample
+	*/
+	bool BeginFrame();
+
+	/* EndFrame()
+		\description - Stops the GPU timer and collects the time of an earlier frame without waiting on the GPU
+	*/
+	void EndFrame();
+
+	/* Swap()
+		\description - Presents the frame (SDL_GL_SwapWindow for a window, glFlush offscreen)
+	*/
+	void Swap();
+
+	/* GpuMilliseconds()
+		\description - GPU time of the most recent frame whose timer query has finished, -1 if there is none.
+		               It stays the same until BeginFrame reads the next result, so only count it when BeginFrame returns true
+	*/
+	double GpuMilliseconds() const;
+
+	bool HasGpuTimer() const;
+	bool IsOffscreen() const;
+	int Width() const;
+	int Height() const;
+	GLuint Framebuffer() const; //0 for a window
+private:
+	RenderContext(int width, int height);
+	bool CreateFramebuffer();
+	void InitTimer();
+
+	int width;
+	int height;
+	SDL_Window* window;
+	SDL_GLContext glContext;
+	void* offscreenDisplay; //EGLDisplay
+	void* offscreenContext; //EGLContext or OSMesaContext
+	unsigned char* offscreenPixels; //OSMesa's default framebuffer (unused because everything draws into the FBO)
+	GLuint framebuffer;
+	GLuint colorBuffer;
+	bool timerSupported;
+	static const int TIMER_QUERIES = 3; //results are read two frames late so the CPU never waits for the GPU
+	GLuint queries[TIMER_QUERIES];
+	bool queryPending[TIMER_QUERIES];
+	int frame;
+	double gpuMilliseconds;
+};
@@ -0,0 +1,10 @@
+#include "RenderStats.h"
+#include <string.h>
+
+RenderStats renderStats = { 0, 0, 0, 0 };
+unsigned int renderAttributeBytes[RENDER_MAX_ATTRIBUTES] = { 0 };
+bool renderAttributeEnabled[RENDER_MAX_ATTRIBUTES] = { false };
+
+void ResetRenderStats() {
+	memset(&renderStats, 0, sizeof(renderStats));
+}
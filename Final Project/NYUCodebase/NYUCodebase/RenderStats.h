@@ -0,0 +1,124 @@
+
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include "GLTrace.h"
+
+/*
+ *
+ * Counted GL calls - the game calls these instead of the GL functions so a frame's GL work can be counted
+ * (and traced for redundant calls in builds that define GL_TRACE, see GLTrace.h)
+ *
+ */
+
+#define RENDER_MAX_ATTRIBUTES 16
+
+//RenderStats - GL work submitted since the counters were last reset
+struct RenderStats {
+	unsigned int drawCalls;
+	unsigned int textureBinds;
+	unsigned int programBinds;
+	unsigned int vertexBytes; //client side vertex data read by the draw calls
+};
+
+extern RenderStats renderStats;
+extern unsigned int renderAttributeBytes[RENDER_MAX_ATTRIBUTES]; //bytes per vertex of each attribute's current pointer
+extern bool renderAttributeEnabled[RENDER_MAX_ATTRIBUTES];
+
+/* ResetRenderStats()
+	\description - Zeroes the counters, called at the start of a frame
+*/
+void ResetRenderStats();
+
+inline void CountedDrawArrays(GLenum mode, GLint first, GLsizei count) {
+	unsigned int bytesPerVertex = 0;
+	for (int i = 0; i < RENDER_MAX_ATTRIBUTES; i++) {
+		bytesPerVertex += renderAttributeEnabled[i] ? renderAttributeBytes[i] : 0;
+	}
+	renderStats.drawCalls++;
+	renderStats.vertexBytes += bytesPerVertex * count;
+#ifdef GL_TRACE
+	GLTraceDrawArrays(count);
+#endif
+	glDrawArrays(mode, first, count);
+}
+
+inline void CountedBindTexture(GLenum target, GLuint texture) {
+	renderStats.textureBinds++;
+#ifdef GL_TRACE
+	GLTraceBindTexture(target, texture);
+#endif
+	glBindTexture(target, texture);
+}
+
+inline void CountedUseProgram(GLuint program) {
+	renderStats.programBinds++;
+#ifdef GL_TRACE
+	GLTraceUseProgram(program);
+#endif
+	glUseProgram(program);
+}
+
+inline void CountedVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer) {
+	if (index < RENDER_MAX_ATTRIBUTES) {
+		renderAttributeBytes[index] = size * (type == GL_FLOAT ? sizeof(GLfloat) : 1);
+	}
+#ifdef GL_TRACE
+	GLTraceVertexAttribPointer(index, size, type, normalized, stride, pointer);
+#endif
+	glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+}
+
+inline void CountedEnableVertexAttribArray(GLuint index) {
+	if (index < RENDER_MAX_ATTRIBUTES) {
+		renderAttributeEnabled[index] = true;
+	}
+#ifdef GL_TRACE
+	GLTraceEnableVertexAttribArray(index, true);
+#endif
+	glEnableVertexAttribArray(index);
+}
+
+inline void CountedDisableVertexAttribArray(GLuint index) {
+	if (index < RENDER_MAX_ATTRIBUTES) {
+		renderAttributeEnabled[index] = false;
+	}
+#ifdef GL_TRACE
+	GLTraceEnableVertexAttribArray(index, false);
+#endif
+	glDisableVertexAttribArray(index);
+}
+
+inline void CountedUniformMatrix4fv(GLint location, const GLfloat* value) {
+#ifdef GL_TRACE
+	GLTraceUniform(location, value, 16);
+#endif
+	glUniformMatrix4fv(location, 1, GL_FALSE, value);
+}
+
+inline void CountedUniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) {
+#ifdef GL_TRACE
+	GLfloat value[4] = { x, y, z, w };
+	GLTraceUniform(location, value, 4);
+#endif
+	glUniform4f(location, x, y, z, w);
+}
+
+inline void CountedTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format,
+	GLenum type, const GLvoid* pixels) {
+#ifdef GL_TRACE
+	GLTraceTexImage2D();
+#endif
+	glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+}
+
+inline void CountedCompressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize,
+	const GLvoid* data) {
+#ifdef GL_TRACE
+	GLTraceTexImage2D();
+#endif
+	glCompressedTexImage2D(target, level, internalFormat, width, height, border, imageSize, data);
+}
@@ -0,0 +1,80 @@
+
+#pragma once
+
+#include <assert.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//ResourceHandle - a name interned by a ResourceRegistry, an index into its arrays
+typedef int ResourceHandle;
+
+//ResourceRegistry - interns resource names to dense handles while loading, so the game looks resources up by index every frame
+//instead of hashing or comparing strings. Names are only used by Intern and Find.
+//References from operator[] stay valid until the next Intern.
+template <class T>
+class ResourceRegistry {
+public:
+	/* Intern()
+		\description - The handle for name, making an empty slot for it the first time the name is seen
+		\param name  - name the resource is loaded under
+	*/
+	ResourceHandle Intern(const std::string& name) {
+		std::unordered_map<std::string, ResourceHandle>::const_iterator found = handles.find(name);
+		if (found != handles.end()) {
+			return found->second;
+		}
+		ResourceHandle handle = (ResourceHandle)names.size();
+		handles[name] = handle;
+		names.push_back(name);
+		items.push_back(T());
+		loaded.push_back(false);
+		return handle;
+	}
+
+	/* Find()
+		\description - The handle for name, -1 if it was never interned
+	*/
+	ResourceHandle Find(const std::string& name) const {
+		std::unordered_map<std::string, ResourceHandle>::const_iterator found = handles.find(name);
+		return found == handles.end() ? -1 : found->second;
+	}
+
+	/* Set()
+		\description - Stores the loaded resource in handle's slot
+	*/
+	void Set(ResourceHandle handle, const T& item) {
+		assert(handle >= 0 && handle < Count());
+		items[handle] = item;
+		loaded[handle] = true;
+	}
+
+	/* Loaded()
+		\description - True once Set has stored a resource for handle
+	*/
+	bool Loaded(ResourceHandle handle) const {
+		return handle >= 0 && handle < Count() && loaded[handle];
+	}
+
+	T& operator[](ResourceHandle handle) {
+		assert(handle >= 0 && handle < Count());
+		return items[handle];
+	}
+	const T& operator[](ResourceHandle handle) const {
+		assert(handle >= 0 && handle < Count());
+		return items[handle];
+	}
+
+	const std::string& Name(ResourceHandle handle) const {
+		return names[handle];
+	}
+
+	int Count() const {
+		return (int)items.size();
+	}
+private:
+	std::unordered_map<std::string, ResourceHandle> handles;
+	std::vector<std::string> names;
+	std::vector<T> items;
+	std::vector<bool> loaded;
+};
@@ -1,5 +1,7 @@
 
 #include "ShaderProgram.h"
+#include "RenderStats.h"
+#include "AssetPack.h"
 
 void ShaderProgram::Load(const char *vertexShaderFile, const char *fragmentShaderFile) {
     
@@ -39,6 +41,12 @@ void ShaderProgram::Cleanup() {
 }
 
 GLuint ShaderProgram::LoadShaderFromFile(const std::string &shaderFile, GLenum type) {
+    //Compile straight from the asset pack when the shader is in it
+    AssetSpan packed = assetPack.Find(shaderFile.c_str());
+    if(packed.data != NULL) {
+        return LoadShaderFromMemory((const char *)packed.data, (GLint)packed.size, type);
+    }
+
     //Open a file stream with the file name
     std::ifstream infile(shaderFile);
     
@@ -55,17 +63,18 @@ GLuint ShaderProgram::LoadShaderFromFile(const std::string &shaderFile, GLenum t
 }
 
 GLuint ShaderProgram::LoadShaderFromString(const std::string &shaderContents, GLenum type) {
+    // Get the pointer to the C string from the STL string
+    return LoadShaderFromMemory(shaderContents.c_str(), (GLint) shaderContents.size(), type);
+}
+
+GLuint ShaderProgram::LoadShaderFromMemory(const char *shaderContents, GLint length, GLenum type) {
     
     
     // Create a shader of specified type
     GLuint shaderID = glCreateShader(type);
     
-    // Get the pointer to the C string from the STL string
-    const char *shaderString = shaderContents.c_str();
-    GLint shaderStringLength = (GLint) shaderContents.size();
-    
-    // Set the shader source to the string and compile shader
-    glShaderSource(shaderID, 1, &shaderString, &shaderStringLength);
+    // Set the shader source to the text (it does not need to end in a 0) and compile shader
+    glShaderSource(shaderID, 1, &shaderContents, &length);
     glCompileShader(shaderID);
     
     // Check if the shader compiled properly
@@ -84,21 +93,21 @@ GLuint ShaderProgram::LoadShaderFromString(const std::string &shaderContents, GL
 }
 
 void ShaderProgram::SetColor(float r, float g, float b, float a) {
-	glUseProgram(programID);
-	glUniform4f(colorUniform, r, g, b, a);
+	CountedUseProgram(programID);
+	CountedUniform4f(colorUniform, r, g, b, a);
 }
 
 void ShaderProgram::SetViewMatrix(const Matrix &matrix) {
-    glUseProgram(programID);
-    glUniformMatrix4fv(viewMatrixUniform, 1, GL_FALSE, matrix.ml);
+    CountedUseProgram(programID);
+    CountedUniformMatrix4fv(viewMatrixUniform, matrix.ml);
 }
 
 void ShaderProgram::SetModelMatrix(const Matrix &matrix) {
-    glUseProgram(programID);
-    glUniformMatrix4fv(modelMatrixUniform, 1, GL_FALSE, matrix.ml);
+    CountedUseProgram(programID);
+    CountedUniformMatrix4fv(modelMatrixUniform, matrix.ml);
 }
 
 void ShaderProgram::SetProjectionMatrix(const Matrix &matrix) {
-    glUseProgram(programID);
-    glUniformMatrix4fv(projectionMatrixUniform, 1, GL_FALSE, matrix.ml);    
+    CountedUseProgram(programID);
+    CountedUniformMatrix4fv(projectionMatrixUniform, matrix.ml);    
 }
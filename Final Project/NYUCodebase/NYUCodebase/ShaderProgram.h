@@ -22,6 +22,7 @@ class ShaderProgram {
 		void SetColor(float r, float g, float b, float a);
 	
         GLuint LoadShaderFromString(const std::string &shaderContents, GLenum type);
+        GLuint LoadShaderFromMemory(const char *shaderContents, GLint length, GLenum type);
         GLuint LoadShaderFromFile(const std::string &shaderFile, GLenum type);
     
         GLuint programID;
@@ -0,0 +1,460 @@
+#include "Simulation.h"
+#include "Profiler.h"
+#include "WeaponTable.h"
+#include <math.h>
+#include <string.h>
+
+using namespace std;
+
+#define NOT_CHANGED -100.0f //velocity is never -100 so it marks a component that setVelocity should leave alone
+#define NEVER_FIRED -1000.0f //lastShotTime of a gun that can fire straight away
+
+/* MaxBulletsInFlight()
+	\description - Most bullets both players can have in the air at once: the fastest gun's rate of fire over the longest
+	               bullet lifetime, so reserving this many keeps SimulationShoot from reallocating in the middle of a match
+*/
+constexpr int MaxBulletsInFlight() {
+	float fastestRate = 0;
+	float longestLife = 0;
+	for (int gun = 0; gun < GUN_COUNT; gun++) {
+		fastestRate = weaponTable.fireRate[gun] > fastestRate ? weaponTable.fireRate[gun] : fastestRate;
+		float life = weaponTable.range[gun] / weaponTable.speed[gun];
+		longestLife = life > longestLife ? life : longestLife;
+	}
+	return 2 * ((int)(fastestRate * longestLife) + 1);
+}
+
+unsigned int SimulationRandom(SimRandom& random) {
+	unsigned int x = random.state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	random.state = x;
+	return x;
+}
+
+int SimulationTile(const SimState& state, int x, int y) {
+	return state.map[y * state.length + x];
+}
+
+static void SetTile(SimState& state, int x, int y, int tile) {
+	state.map[y * state.length + x] = tile;
+}
+
+/*
+ *
+ * Board
+ *
+ */
+
+//Procedurally generates the board: columns grow up from the bottom row with probability p each level
+static void GenerateMap(SimState& state, float p) {
+	int length = state.length;
+	int height = state.height;
+	state.map.assign(length * height, 3); //Initialize each tile to be 3 (in the texture it is used for the sky)
+
+	//Set the bottom most row to be 8 (top level soil)
+	for (int j = 0; j < length; j++) {
+		SetTile(state, j, height - 1, 8);
+	}
+
+	for (int i = height - 2; i > height / 2 - 1; i--) { //Go from bottom to halfway up the map
+		for (int j = 0; j < length; j++) { //Go through each column
+			if ((j > 0 && SimulationTile(state, j - 1, i + 1) == 3) || SimulationTile(state, j, i + 1) == 3 || (j < length - 1 && i < height - 2 && SimulationTile(state, j + 1, i + 1) == 3)) {
+				//If the piece to our bottom left or bottom right is sky, or the piece below us is sky, then we are also sky
+				//(no steep hills that cannot be climbed and no floating platforms)
+				SetTile(state, j, i, 3);
+			}
+			else if ((SimulationRandom(state.random) % 101) / 100.0f < p) { //If a random number is less than our probability then we build up
+				SetTile(state, j, i, 8); //set the current level to top level soil
+				SetTile(state, j, i + 1, 17); //set piece below us as normal soil
+			}
+			else { //Otherwise make the piece sky
+				SetTile(state, j, i, 3);
+			}
+		}
+	}
+
+	for (int i = height - 2; i > height / 2 - 1; i--) {
+		for (int j = 1; j < length - 1; j++) {
+			if (SimulationTile(state, j, i) == 8 && SimulationTile(state, j - 1, i) == 3 && SimulationTile(state, j + 1, i) == 3) {
+				//If we are a one tile wide peak, make our land height one less (allows for platforms)
+				SetTile(state, j, i, 3);
+				SetTile(state, j, i + 1, 8);
+			}
+		}
+	}
+}
+
+//Checks if the world coordinate is inside dirt
+static bool CheckIfCollision(const SimState& state, float x, float y) {
+	int gridX = (int)(x); //convert x to the grid version of x
+	int gridY = (int)ceil(-y - 1); //convert y to grid version of y
+	if (gridX < 0 || gridX >= state.length || gridY < 0 || gridY >= state.height) { // if the grid values are out of bounds there is no collision
+		return false;
+	}
+	return SimulationTile(state, gridX, gridY) != 3; //anything that is not sky (3) is a collision
+}
+
+//Returns how much in the y axis an entity at the coordinate should be moved up to stand on the ground
+static float YAdjustment(const SimState& state, float x, float y) {
+	if (!CheckIfCollision(state, x, y)) {
+		return 0;
+	}
+	return ceil(y) - y;
+}
+
+/*
+ *
+ * Characters
+ *
+ */
+
+//Assigns velocity to specified directions (NOT_CHANGED leaves a component as it is)
+static void SetVelocity(SimCharacter& character, float x, float y) {
+	if (x != NOT_CHANGED) {
+		bool xPositive = (x > 0);
+		bool vPositive = (character.velocity[0] > 0);
+		if (xPositive != vPositive) { //reset distance traveled for animation when we swap directions
+			character.distanceTraveled = 0;
+		}
+		if (x != character.velocity[0]) {
+			character.animation[1] = 1;
+		}
+		character.velocity[0] = x;
+	}
+	if (y != NOT_CHANGED) {
+		character.velocity[1] = y;
+	}
+	if (character.velocity[0] > 0) {
+		character.animation[0] = 3;
+	}
+	else if (character.velocity[0] < 0) {
+		character.animation[0] = 1;
+	}
+}
+
+//Moves the character based upon its velocity and adjusts velocities if falling
+static void MoveCharacter(SimCharacter& character, float elapsed) {
+	if ((character.collisionFlags[0] == false) || (character.collisionFlags[0] && character.velocity[1] > 0)) { //if we are in the air or are on the ground and jumping
+		character.position[1] += character.velocity[1] * elapsed; //change our vertical position
+	}
+	if ((!character.collisionFlags[1] && character.velocity[0] < 0) || (!character.collisionFlags[2] && character.velocity[0] > 0)) { //if we are not collided in the direction of our movement
+		//If we are at risk of going out of bounds fix our position so that we are stuck on the edge
+		if (character.position[0] < 0 && character.velocity[0] < 0) {
+			character.position[0] = 0;
+		}
+		else if (character.position[0] > BOARD_LENGTH - 1 && character.velocity[0] > 0) {
+			character.position[0] = BOARD_LENGTH - 1;
+		}
+		//If we are in the clear to move, then we move and adjust our distance traveled
+		else {
+			character.position[0] += character.velocity[0] * elapsed;
+			character.distanceTraveled += character.velocity[0] * elapsed;
+		}
+	}
+	if (!character.collisionFlags[0]) { //if we are falling, increase our falling speed (acceleration)
+		character.velocity[1] -= 3.5f * elapsed;
+	}
+	if (character.velocity[0] != 0 && fabs(character.distanceTraveled) >= 0.5f) { //switch running animation every half unit
+		character.animation[1] = (character.animation[1] == 1 ? 3 : 1);
+		character.distanceTraveled = 0.0f;
+	}
+}
+
+static void GotHit(SimCharacter& character, float damage) {
+	character.health -= damage;
+	if (character.health <= 0.0f) {
+		character.health = 0.0f;
+	}
+}
+
+//Applies a player's movement buttons (they can only walk into a side that they are not collided with and jump from the ground)
+static void ApplyMovement(SimCharacter& character, unsigned char buttons) {
+	if ((buttons & INPUT_RIGHT) && !character.collisionFlags[2]) {
+		SetVelocity(character, PLAYER_Vx, NOT_CHANGED);
+	}
+	else if ((buttons & INPUT_LEFT) && !character.collisionFlags[1]) {
+		SetVelocity(character, -PLAYER_Vx, NOT_CHANGED);
+	}
+	else {
+		SetVelocity(character, 0, NOT_CHANGED);
+	}
+	if ((buttons & INPUT_JUMP) && character.collisionFlags[0]) {
+		SetVelocity(character, NOT_CHANGED, PLAYER_Vy);
+	}
+}
+
+/*
+ *
+ * Guns
+ *
+ */
+
+//Adjusts the gunNumber so that a new gun is used to shoot
+static void ShiftGun(SimGun& gun, int num) {
+	gun.gunNumber += num;
+	if (gun.gunNumber < 0) {
+		gun.gunNumber += GUN_COUNT;
+	}
+	else if (gun.gunNumber >= GUN_COUNT) {
+		gun.gunNumber = gun.gunNumber % GUN_COUNT;
+	}
+	gun.magazineLeft = weaponTable.magazine[gun.gunNumber]; //adjust size of magazine
+	gun.lastShotTime = NEVER_FIRED; //reset the gun's bullet fire
+}
+
+//Gun shifting only happens once per press, the buttons have to be let go before the next shift
+static void ApplyGunShift(SimGun& gun, unsigned char buttons) {
+	if (gun.letGo) {
+		if (buttons & INPUT_PREV_GUN) {
+			ShiftGun(gun, -1);
+			gun.letGo = false;
+		}
+		else if (buttons & INPUT_NEXT_GUN) {
+			ShiftGun(gun, 1);
+			gun.letGo = false;
+		}
+	}
+	else if (!(buttons & (INPUT_PREV_GUN | INPUT_NEXT_GUN))) {
+		gun.letGo = true;
+	}
+}
+
+//Adjusts the gun's position so that it matches the player's
+static void Reposition(SimGun& gun, const SimCharacter& master) {
+	gun.position[0] = master.position[0] + (master.animation[0] == 3 ? 0.45f : 0.0f);
+	gun.position[1] = master.position[1];
+	gun.position[2] = master.position[2];
+}
+
+//Attempts to fire a bullet from player's gun
+static void Shoot(SimState& state, int player, SimEvents& events) {
+	SimGun& gun = state.guns[player];
+	const SimCharacter& master = state.players[player];
+	int type = gun.gunNumber; //row of the gun in weaponTable
+	if (gun.reloading && state.time - gun.reloadingStartTime < 1.5f) { //If the gun is still reloading
+		if (weaponTable.sound[type] == GUN_SOUND_SHOTGUN) { //shotguns make a reloading sound
+			events.reloadSound[player] = true;
+		}
+		return;
+	}
+	if (gun.reloading) { //if we were reloading, we are not anymore so we reset the magazine
+		gun.reloading = false;
+		gun.magazineLeft = weaponTable.magazine[type];
+	}
+	if (state.time - gun.lastShotTime > 1.0f / weaponTable.fireRate[type]) { //if enough time has passed since our last shot to fire another bullet
+		gun.lastShotTime = state.time;
+		gun.magazineLeft--;
+		if (gun.magazineLeft == 0) { // if the magazine is now empty start to reload
+			gun.reloading = true;
+			gun.reloadingStartTime = state.time;
+		}
+		events.haltChannel[player] = (weaponTable.fireRate[type] > 10.0f);
+		events.shotSound[player] = weaponTable.sound[type];
+
+		SimBullet bullet;
+		bullet.sentiment = master.sentiment;
+		bullet.damage = weaponTable.damage[type];
+		bullet.position[0] = gun.position[0] + 0.1f;
+		bullet.position[1] = gun.position[1] + 0.2f;
+		bullet.position[2] = gun.position[2];
+		bullet.velocity = (master.animation[0] == 3 ? 1.0f : -1.0f) * weaponTable.speed[type];
+		bullet.distanceTraveled = 0;
+		bullet.maxDistance = weaponTable.range[type];
+		state.bullets.push_back(bullet);
+	}
+}
+
+/*
+ *
+ * Collision
+ *
+ */
+
+//Terrain collision for one player (positions are the bottom left corner of the character)
+static void TerrainCollision(const SimState& state, SimCharacter& player) {
+	if (CheckIfCollision(state, player.position[0] + 0.5f, player.position[1])) { //ground, +0.5 to get center of character
+		player.position[1] += YAdjustment(state, player.position[0], player.position[1]);
+		player.collisionFlags[0] = true;
+		SetVelocity(player, NOT_CHANGED, 0);
+	}
+	else {
+		player.collisionFlags[0] = false;
+	}
+	if (CheckIfCollision(state, player.position[0] + .85f, player.position[1] + 0.5f)) { //right side, +0.5 to get to center of height
+		player.position[0] -= 0.01f;
+		player.collisionFlags[2] = true;
+		SetVelocity(player, 0, NOT_CHANGED);
+	}
+	else {
+		player.collisionFlags[2] = false;
+	}
+	if (CheckIfCollision(state, player.position[0], player.position[1] + 0.5f)) { //left side
+		player.position[0] += 0.01f;
+		player.collisionFlags[1] = true;
+		SetVelocity(player, 0, NOT_CHANGED);
+	}
+	else {
+		player.collisionFlags[1] = false;
+	}
+}
+
+static void Collision(SimState& state) {
+	TerrainCollision(state, state.players[0]);
+	TerrainCollision(state, state.players[1]);
+
+	SimCharacter& playerOne = state.players[0];
+	SimCharacter& playerTwo = state.players[1];
+	for (SimBullet& bullet : state.bullets) {
+		if (CheckIfCollision(state, bullet.position[0], bullet.position[1])) { //Check if bullet hit a wall
+			bullet.distanceTraveled = bullet.maxDistance; //set bullet's distance to max so it dies
+		}
+		else if (fabs(bullet.position[0] - playerOne.position[0]) < 0.3f && fabs(bullet.position[1] - (playerOne.position[1] + 0.5f)) < 0.5f && bullet.sentiment == playerTwo.sentiment) {
+			bullet.distanceTraveled = bullet.maxDistance;
+			GotHit(playerOne, bullet.damage);
+		}
+		else if (fabs(bullet.position[0] - playerTwo.position[0]) < 0.3f && fabs(bullet.position[1] - (playerTwo.position[1] + 0.5f)) < 0.5f && bullet.sentiment == playerOne.sentiment) {
+			bullet.distanceTraveled = bullet.maxDistance;
+			GotHit(playerTwo, bullet.damage);
+		}
+	}
+}
+
+/*
+ *
+ * Match
+ *
+ */
+
+static void InitCharacter(SimCharacter& character, int sentiment, float x, float y) {
+	memset(&character, 0, sizeof(character));
+	character.sentiment = sentiment;
+	character.position[0] = x;
+	character.position[1] = y;
+	character.health = 500;
+	character.animation[0] = (sentiment == 1 ? 3 : 1); //playerOne faces right, playerTwo faces left
+}
+
+static void InitGun(SimGun& gun, const SimCharacter& master) {
+	memset(&gun, 0, sizeof(gun));
+	gun.letGo = true;
+	ShiftGun(gun, 0); //gun 0 is the first gun that is brought up in the game
+	Reposition(gun, master);
+}
+
+void SimulationInit(SimState& state, unsigned int seed) {
+	state.tick = 0;
+	state.time = 0;
+	state.random.state = (seed == 0 ? 0x9E3779B9u : seed); //xorshift never leaves zero
+	state.length = BOARD_LENGTH;
+	state.height = BOARD_HEIGHT;
+	GenerateMap(state, BOARD_GROWTH);
+	InitCharacter(state.players[0], 1, 13, -10);
+	InitCharacter(state.players[1], 2, 20, -10);
+	InitGun(state.guns[0], state.players[0]);
+	InitGun(state.guns[1], state.players[1]);
+	state.bullets.clear();
+	state.bullets.reserve(MaxBulletsInFlight()); //only allocates for the first match, clear() keeps the capacity after that
+}
+
+void SimulationMovePlayers(SimState& state, const SimInput& input) {
+	for (int player = 0; player < 2; player++) {
+		ApplyMovement(state.players[player], input.buttons[player]);
+		ApplyGunShift(state.guns[player], input.buttons[player]);
+	}
+	for (int player = 0; player < 2; player++) {
+		MoveCharacter(state.players[player], TIME_STEP_SIZE);
+		Reposition(state.guns[player], state.players[player]);
+	}
+}
+
+void SimulationShoot(SimState& state, const SimInput& input, SimEvents& events) {
+	for (int player = 0; player < 2; player++) {
+		events.shotSound[player] = GUN_SOUND_NONE;
+		events.haltChannel[player] = false;
+		events.reloadSound[player] = false;
+		if (input.buttons[player] & INPUT_SHOOT) {
+			Shoot(state, player, events);
+		}
+	}
+}
+
+void SimulationMoveBullets(SimState& state) {
+	for (SimBullet& bullet : state.bullets) {
+		bullet.position[0] += bullet.velocity * TIME_STEP_SIZE;
+		bullet.distanceTraveled += bullet.velocity * TIME_STEP_SIZE;
+	}
+}
+
+void SimulationCollision(SimState& state) {
+	PROFILE_ZONE("SimulationCollision");
+	Collision(state);
+}
+
+void SimulationCleanup(SimState& state) {
+	size_t kept = 0;
+	for (size_t i = 0; i < state.bullets.size(); i++) {
+		if (fabs(state.bullets[i].distanceTraveled) < state.bullets[i].maxDistance) {
+			state.bullets[kept++] = state.bullets[i];
+		}
+	}
+	state.bullets.resize(kept);
+
+	state.tick++;
+	state.time = state.tick * TIME_STEP_SIZE; //not accumulated so the clock does not drift over long matches
+}
+
+void SimulationTick(SimState& state, const SimInput& input, SimEvents& events) {
+	SimulationMovePlayers(state, input);
+	SimulationShoot(state, input, events);
+	SimulationMoveBullets(state);
+	SimulationCollision(state);
+	SimulationCleanup(state);
+}
+
+void SimulationSetGun(SimState& state, int player, int gunNumber) {
+	ShiftGun(state.guns[player], gunNumber - state.guns[player].gunNumber);
+}
+
+int SimulationWinner(const SimState& state) {
+	if (state.players[0].health == 0) {
+		return state.players[1].sentiment;
+	}
+	if (state.players[1].health == 0) {
+		return state.players[0].sentiment;
+	}
+	return 0;
+}
+
+//FNV-1a over the raw bytes of a value
+static void HashBytes(unsigned int& hash, const void* data, size_t size) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+}
+
+unsigned int SimulationChecksum(const SimState& state) {
+	unsigned int hash = 2166136261u;
+	HashBytes(hash, &state.tick, sizeof(state.tick));
+	HashBytes(hash, &state.random.state, sizeof(state.random.state));
+	HashBytes(hash, state.map.data(), state.map.size() * sizeof(int));
+	for (int player = 0; player < 2; player++) {
+		const SimCharacter& character = state.players[player];
+		HashBytes(hash, character.position, sizeof(character.position));
+		HashBytes(hash, character.velocity, sizeof(character.velocity));
+		HashBytes(hash, character.collisionFlags, sizeof(character.collisionFlags));
+		HashBytes(hash, &character.health, sizeof(character.health));
+		const SimGun& gun = state.guns[player];
+		HashBytes(hash, &gun.gunNumber, sizeof(gun.gunNumber));
+		HashBytes(hash, &gun.magazineLeft, sizeof(gun.magazineLeft));
+		HashBytes(hash, &gun.lastShotTime, sizeof(gun.lastShotTime));
+	}
+	for (const SimBullet& bullet : state.bullets) {
+		HashBytes(hash, bullet.position, sizeof(bullet.position));
+		HashBytes(hash, &bullet.distanceTraveled, sizeof(bullet.distanceTraveled));
+	}
+	return hash;
+}
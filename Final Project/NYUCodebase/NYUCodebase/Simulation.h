@@ -0,0 +1,174 @@
+
+#pragma once
+#include <vector>
+#include <string>
+
+/*
+ *
+ * Simulation core - all of the in-game rules with no SDL, OpenGL or wall clock. A match is a SimState that is advanced
+ * one fixed tick at a time from a SimInput, so the same seed and the same inputs always produce the same match.
+ *
+ */
+
+#define TIME_STEP_SIZE 0.0016f //Length of one simulation tick in seconds (small so collisions are still detected properly)
+
+//Game State Constants
+#define PLAYER_Vx 3.5
+#define PLAYER_Vy 3.5
+#define BOARD_LENGTH 50
+#define BOARD_HEIGHT 18
+#define BOARD_GROWTH 0.93f //Probability of a column of the board growing
+#define GUN_COUNT 15
+
+//Input bits for one player in one tick
+#define INPUT_LEFT       0x01
+#define INPUT_RIGHT      0x02
+#define INPUT_JUMP       0x04
+#define INPUT_SHOOT      0x08
+#define INPUT_PREV_GUN   0x10
+#define INPUT_NEXT_GUN   0x20
+
+//SimRandom - xorshift generator so map generation does not depend on the C library's rand()
+struct SimRandom {
+	unsigned int state;
+};
+
+//SimCharacter - position, movement and health of one player
+struct SimCharacter {
+	int sentiment; //1 for playerOne, 2 for playerTwo (no friendly fire)
+	float position[3];
+	float velocity[3];
+	bool collisionFlags[3]; //down, left, right
+	float health;
+	float distanceTraveled; //distance since the running animation last changed
+	int animation[2]; //{3 if facing right or 1 if facing left, running frame}
+};
+
+//SimGun - the gun a player is holding
+struct SimGun {
+	int gunNumber;
+	bool reloading;
+	float reloadingStartTime; //simulation time that the gun started to reload
+	float lastShotTime; //simulation time that the last shot was fired
+	int magazineLeft;
+	float position[3];
+	bool letGo; //false while a shift gun button is still held down
+};
+
+//SimBullet - a bullet that is still travelling
+struct SimBullet {
+	int sentiment;
+	float position[3];
+	float velocity;
+	float distanceTraveled;
+	float maxDistance;
+	float damage;
+};
+
+//SimInput - buttons held down by each player during one tick (INPUT_* bits)
+struct SimInput {
+	unsigned char buttons[2];
+};
+
+//GunSound - sounds the guns make, the game keeps a sound handle for each
+enum GunSound {
+	GUN_SOUND_NONE = -1,
+	GUN_SOUND_SNIPER,
+	GUN_SOUND_SHOTGUN,
+	GUN_SOUND_SHOTGUN_RELOAD,
+	GUN_SOUND_RIFLE,
+	GUN_SOUNDS
+};
+
+//SimEvents - things that happened during a tick that the game may want to play a sound for
+struct SimEvents {
+	GunSound shotSound[2]; //sound of the gun that fired this tick, GUN_SOUND_NONE if the player did not fire
+	bool haltChannel[2]; //true if the gun fires fast enough that the last shot's sound should be cut off
+	bool reloadSound[2]; //true if a shotgun was fired while reloading
+};
+
+//SimState - everything needed to continue a match
+struct SimState {
+	unsigned int tick; //number of ticks that have been run
+	float time; //simulation clock in seconds
+	SimRandom random;
+	int length;
+	int height;
+	std::vector<int> map; //height rows of length tiles, 3 is sky, 8 is top soil, 17 is soil
+	SimCharacter players[2];
+	SimGun guns[2];
+	std::vector<SimBullet> bullets; //SimulationInit reserves room for every bullet a match can have in flight
+};
+
+/* SimulationInit()
+	\description - Starts a new match, generating the board from seed and placing both players
+	\param state - state to fill in
+	\param seed  - seed for the board generation
+*/
+void SimulationInit(SimState& state, unsigned int seed);
+
+/* SimulationTick()
+	\description  - Advances the match by one TIME_STEP_SIZE tick
+	\param state  - state of the match, updated in place
+	\param input  - buttons held down by both players
+	\param events - receives the sounds to play for this tick
+*/
+void SimulationTick(SimState& state, const SimInput& input, SimEvents& events);
+
+/*
+ *
+ * Phases of a tick, in the order SimulationTick runs them. They are exposed so the benchmark can time each one.
+ *
+ */
+
+/* SimulationMovePlayers()
+	\description - Applies movement and gun shift buttons, moves both players and keeps their guns in their hands
+*/
+void SimulationMovePlayers(SimState& state, const SimInput& input);
+
+/* SimulationShoot()
+	\description - Fires the guns of the players holding the shoot button and fills in events
+*/
+void SimulationShoot(SimState& state, const SimInput& input, SimEvents& events);
+
+/* SimulationMoveBullets()
+	\description - Moves every bullet by one tick
+*/
+void SimulationMoveBullets(SimState& state);
+
+/* SimulationCollision()
+	\description - Terrain collision for both players and bullet collisions with walls and players
+*/
+void SimulationCollision(SimState& state);
+
+/* SimulationCleanup()
+	\description - Removes bullets that have traveled their full distance and advances the clock by one tick
+*/
+void SimulationCleanup(SimState& state);
+
+/* SimulationSetGun()
+	\description     - Gives a player a specific gun (as if they shifted to it)
+	\param player    - 0 for playerOne, 1 for playerTwo
+	\param gunNumber - gun between 0 and GUN_COUNT - 1
+*/
+void SimulationSetGun(SimState& state, int player, int gunNumber);
+
+/* SimulationWinner()
+	\description - Returns 0 while both players are alive, otherwise the sentiment of the winning player
+*/
+int SimulationWinner(const SimState& state);
+
+/* SimulationChecksum()
+	\description - Hash of the whole state, two runs with the same seed and inputs must give the same value every tick
+*/
+unsigned int SimulationChecksum(const SimState& state);
+
+/* SimulationTile()
+	\description - Returns the tile at column x and row y of the board
+*/
+int SimulationTile(const SimState& state, int x, int y);
+
+/* SimulationRandom()
+	\description - Returns the next number from the state's random generator
+*/
+unsigned int SimulationRandom(SimRandom& random);
@@ -0,0 +1,226 @@
+#include "TextureAtlas.h"
+#include "RenderStats.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <iostream>
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+
+using namespace std;
+
+TextureAtlas::TextureAtlas() {}
+
+TextureAtlas::~TextureAtlas() {
+	for (size_t i = 0; i < images.size(); i++) {
+		textureCache.Free(images[i].image);
+	}
+	if (!pages.empty()) {
+		glDeleteTextures(pages.size(), pages.data());
+	}
+}
+
+void TextureAtlas::Add(const char* name, const char* filePath) {
+	PROFILE_ZONE("TextureAtlas::Add");
+	DecodedImage image;
+	if (!textureCache.Load(filePath, image)) {
+		std::cout << "Unable to load image. Make sure the path is correct\n";
+		assert(false);
+		return;
+	}
+	Add(name, image);
+}
+
+void TextureAtlas::Add(const char* name, const DecodedImage& image) {
+	AtlasImage added;
+	added.name = name;
+	added.image = image;
+	added.width = image.width;
+	added.height = image.height;
+	added.page = -1;
+	images.push_back(added);
+}
+
+//Skyline bottom-left: the image goes wherever its top edge ends up lowest, leftmost on ties
+bool TextureAtlas::Place(vector<SkylineSegment>& skyline, int width, int height, int& x, int& y) {
+	int bestIndex = -1;
+	int bestY = INT_MAX;
+	for (size_t i = 0; i < skyline.size(); i++) {
+		if (skyline[i].x + width > ATLAS_PAGE_SIZE) {
+			break;
+		}
+		int top = 0; //lowest y the image can sit at, resting on every segment it spans
+		int covered = 0;
+		for (size_t j = i; covered < width; j++) {
+			top = max(top, skyline[j].y);
+			covered += skyline[j].width;
+		}
+		if (top + height <= ATLAS_PAGE_SIZE && top < bestY) {
+			bestY = top;
+			bestIndex = i;
+		}
+	}
+	if (bestIndex < 0) {
+		return false;
+	}
+	x = skyline[bestIndex].x;
+	y = bestY;
+
+	SkylineSegment segment = { x, y + height, width };
+	skyline.insert(skyline.begin() + bestIndex, segment);
+	//Segments now under the image are cut back or removed
+	for (size_t i = bestIndex + 1; i < skyline.size();) {
+		int overlap = skyline[i - 1].x + skyline[i - 1].width - skyline[i].x;
+		if (overlap <= 0) {
+			break;
+		}
+		skyline[i].x += overlap;
+		skyline[i].width -= overlap;
+		if (skyline[i].width > 0) {
+			break;
+		}
+		skyline.erase(skyline.begin() + i);
+	}
+	for (size_t i = 1; i < skyline.size();) { //neighbours at the same height become one segment
+		if (skyline[i - 1].y == skyline[i].y) {
+			skyline[i - 1].width += skyline[i].width;
+			skyline.erase(skyline.begin() + i);
+		}
+		else {
+			i++;
+		}
+	}
+	return true;
+}
+
+void TextureAtlas::Build() {
+	PROFILE_ZONE("TextureAtlas::Build");
+	vector<int> order; //images added since the last Build
+	for (size_t i = 0; i < images.size(); i++) {
+		if (images[i].page < 0) {
+			order.push_back(i);
+		}
+	}
+	sort(order.begin(), order.end(), [this](int a, int b) { return images[a].height > images[b].height; });
+
+	//Fill one page at a time, images that do not fit wait for the next page
+	size_t placed = 0;
+	while (placed < order.size()) {
+		int page = pages.size();
+		int pageWidth = 0;
+		int pageHeight = 0;
+		vector<SkylineSegment> skyline(1);
+		skyline[0].x = 0;
+		skyline[0].y = 0;
+		skyline[0].width = ATLAS_PAGE_SIZE;
+		for (size_t i = 0; i < order.size(); i++) {
+			AtlasImage& image = images[order[i]];
+			int x, y;
+			if (image.page >= 0 || !Place(skyline, image.width + 2 * ATLAS_PADDING, image.height + 2 * ATLAS_PADDING, x, y)) {
+				continue;
+			}
+			image.page = page;
+			image.x = x + ATLAS_PADDING;
+			image.y = y + ATLAS_PADDING;
+			pageWidth = max(pageWidth, x + image.width + 2 * ATLAS_PADDING);
+			pageHeight = max(pageHeight, y + image.height + 2 * ATLAS_PADDING);
+			placed++;
+		}
+		if (pageHeight == 0) {
+			std::cout << "Image too big for an atlas page\n";
+			assert(false);
+			return;
+		}
+
+		//Copy the images in, repeating their outermost pixels into the padding
+		vector<unsigned char> pixels(pageWidth * pageHeight * 4, 0);
+		for (size_t i = 0; i < images.size(); i++) {
+			AtlasImage& image = images[i];
+			if (image.page != page) {
+				continue;
+			}
+			for (int row = -ATLAS_PADDING; row < image.height + ATLAS_PADDING; row++) {
+				int sourceRow = min(max(row, 0), image.height - 1);
+				for (int column = -ATLAS_PADDING; column < image.width + ATLAS_PADDING; column++) {
+					int sourceColumn = min(max(column, 0), image.width - 1);
+					const unsigned char* source = image.image.pixels + (sourceRow * image.width + sourceColumn) * 4;
+					unsigned char* destination = pixels.data() + ((image.y + row) * pageWidth + image.x + column) * 4;
+					memcpy(destination, source, 4);
+				}
+			}
+			textureCache.Free(image.image);
+		}
+
+		//Store the page in the smallest format that keeps its pixels exactly. font2.png has R == G == B in every texel, so its page is LA8
+		TextureFormat format = ChooseTextureFormat(pixels.data(), pageWidth, pageHeight);
+		TextureUpload upload;
+		ConvertTexture(format, pixels.data(), pageWidth, pageHeight, upload);
+		const unsigned char* data = upload.data.empty() ? pixels.data() : upload.data.data();
+		GLuint texture;
+		glGenTextures(1, &texture);
+		CountedBindTexture(GL_TEXTURE_2D, texture);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		if (upload.compressed) {
+			CountedCompressedTexImage2D(GL_TEXTURE_2D, 0, upload.internalFormat, pageWidth, pageHeight, 0, upload.data.size(), data);
+		}
+		else {
+			CountedTexImage2D(GL_TEXTURE_2D, 0, upload.internalFormat, pageWidth, pageHeight, 0, upload.format, upload.type, data);
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		textureMemory.Add(format, pageWidth, pageHeight);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		pages.push_back(texture);
+		pageWidths.push_back(pageWidth);
+		pageHeights.push_back(pageHeight);
+		pageFormats.push_back(format);
+
+		for (size_t i = 0; i < images.size(); i++) {
+			AtlasImage& image = images[i];
+			if (image.page == page) {
+				image.sprite.texture = texture;
+				image.sprite.u = (float)image.x / pageWidth;
+				image.sprite.v = (float)image.y / pageHeight;
+				image.sprite.width = (float)image.width / pageWidth;
+				image.sprite.height = (float)image.height / pageHeight;
+			}
+		}
+	}
+}
+
+bool TextureAtlas::Contains(const char* name) const {
+	for (size_t i = 0; i < images.size(); i++) {
+		if (images[i].name == name) {
+			return images[i].page >= 0;
+		}
+	}
+	return false;
+}
+
+AtlasSprite TextureAtlas::Sprite(const char* name) const {
+	for (size_t i = 0; i < images.size(); i++) {
+		if (images[i].name == name && images[i].page >= 0) {
+			return images[i].sprite;
+		}
+	}
+	std::cout << "No sprite named " << name << " in the atlas\n";
+	assert(false);
+	AtlasSprite missing = { 0, 0, 0, 0, 0 };
+	return missing;
+}
+
+int TextureAtlas::Pages() const {
+	return pages.size();
+}
+
+void TextureAtlas::PrintLayout(FILE* out) const {
+	for (size_t page = 0; page < pages.size(); page++) {
+		fprintf(out, "atlas page %d: %dx%d %s, %u bytes\n", (int)page, pageWidths[page], pageHeights[page], TextureFormatName(pageFormats[page]),
+			(unsigned int)TextureFormatBytes(pageFormats[page], pageWidths[page], pageHeights[page]));
+		for (size_t i = 0; i < images.size(); i++) {
+			if (images[i].page == (int)page) {
+				fprintf(out, "  %-12s %4dx%-4d at %4d,%4d\n", images[i].name.c_str(), images[i].width, images[i].height, images[i].x, images[i].y);
+			}
+		}
+	}
+}
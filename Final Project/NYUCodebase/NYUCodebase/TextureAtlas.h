@@ -0,0 +1,102 @@
+
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include "TextureCache.h"
+#include "TextureFormat.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#define ATLAS_PAGE_SIZE 2048 //maximum width and height of an atlas page
+#define ATLAS_PADDING 2 //pixels around every image, filled with copies of its edge so filtering never reads a neighbour
+
+//AtlasSprite - where one image ended up: the page texture and the rectangle it covers in the page's texture coordinates
+struct AtlasSprite {
+	GLuint texture;
+	float u;
+	float v;
+	float width;
+	float height;
+
+	//Converts a texture coordinate of the original image (0 to 1) to the atlas page
+	float U(float imageU) const {
+		return u + imageU * width;
+	}
+	float V(float imageV) const {
+		return v + imageV * height;
+	}
+};
+
+//TextureAtlas - packs the game's images into as few textures as possible, so a frame can be drawn without switching textures
+class TextureAtlas {
+public:
+	TextureAtlas();
+	~TextureAtlas();
+
+	/* Add()
+		\description   - Loads an image (through textureCache) to be packed by the next Build call
+		\param name    - name the sprite is looked up by
+		\param filePath - image file
+	*/
+	void Add(const char* name, const char* filePath);
+
+	/* Add()
+		\description - Adds an image that was already loaded (by an AssetLoader worker) to be packed by the next Build call
+		\param name   - name the sprite is looked up by
+		\param image  - image from textureCache.Load, the atlas frees it
+	*/
+	void Add(const char* name, const DecodedImage& image);
+
+	/* Build()
+		\description - Packs the images added since the last Build onto new pages (tallest first, skyline bottom-left),
+		               uploads the pages and frees the decoded images. Pages are cut down to the area the images use.
+	*/
+	void Build();
+
+	/* Contains()
+		\description - True once an image added under name has been packed by Build
+	*/
+	bool Contains(const char* name) const;
+
+	/* Sprite()
+		\description - The packed image added under name
+	*/
+	AtlasSprite Sprite(const char* name) const;
+
+	int Pages() const;
+
+	/* PrintLayout()
+		\description - Prints every page's size and format and where each image was placed
+	*/
+	void PrintLayout(FILE* out) const;
+private:
+	//AtlasImage - an added image, with its pixels until Build uploads them
+	struct AtlasImage {
+		std::string name;
+		int width;
+		int height;
+		DecodedImage image; //RGBA, until Build uploads it
+		int page;
+		int x; //top left corner of the image (inside its padding) on the page
+		int y;
+		AtlasSprite sprite;
+	};
+	//SkylineSegment - part of the top edge of the packed area of a page
+	struct SkylineSegment {
+		int x;
+		int y;
+		int width;
+	};
+
+	bool Place(std::vector<SkylineSegment>& skyline, int width, int height, int& x, int& y);
+
+	std::vector<AtlasImage> images;
+	std::vector<GLuint> pages;
+	std::vector<int> pageWidths;
+	std::vector<int> pageHeights;
+	std::vector<TextureFormat> pageFormats;
+};
@@ -0,0 +1,223 @@
+#include "TextureCache.h"
+#include "AssetPack.h"
+#include "PngDecoder.h"
+#include "Profiler.h"
+#include "stb_image.h"
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <string.h>
+#include <sys/stat.h>
+#ifdef _WINDOWS
+	#include <direct.h>
+#endif
+
+using namespace std;
+
+TextureCache textureCache(TEXTURE_CACHE_DIRECTORY);
+
+//TextureCacheHeader - start of a cache file, followed by the source path and then (at pixelOffset) width * height RGBA pixels
+struct TextureCacheHeader {
+	char magic[4]; //"TXC" and TEXTURE_CACHE_VERSION
+	unsigned int pathLength;
+	long long sourceSize;
+	long long sourceModified;
+	int width;
+	int height;
+	unsigned int pixelOffset;
+	unsigned int padding;
+};
+
+static bool SourceInfo(const char* filePath, long long& size, long long& modified) {
+#ifdef _WINDOWS
+	struct _stat64 info;
+	if (_stat64(filePath, &info) != 0) {
+		return false;
+	}
+#else
+	struct stat info;
+	if (stat(filePath, &info) != 0) {
+		return false;
+	}
+#endif
+	size = (long long)info.st_size;
+	modified = (long long)info.st_mtime;
+	return true;
+}
+
+TextureCache::TextureCache(const char* directory) : directory(directory), enabled(true), directoryMade(false), hits(0), misses(0), hitMs(0), missMs(0) {}
+
+//FNV-1a of the path, so every image gets its own file whatever directory it is in
+string TextureCache::CachePath(const char* filePath) const {
+	unsigned long long hash = 14695981039346656037ULL;
+	for (const char* c = filePath; *c != '\0'; c++) {
+		hash ^= (unsigned char)*c;
+		hash *= 1099511628211ULL;
+	}
+	char name[32];
+	snprintf(name, sizeof(name), "/%016llx.rgba", hash);
+	return directory + name;
+}
+
+bool TextureCache::Load(const char* filePath, DecodedImage& image) {
+	PROFILE_ZONE("TextureCache::Load");
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	image.pixels = nullptr;
+	image.width = 0;
+	image.height = 0;
+	image.mapping = nullptr;
+	image.mappingSize = 0;
+	long long sourceSize = 0;
+	long long sourceModified = 0;
+	AssetSpan packed = assetPack.Find(filePath);
+	bool cached = enabled;
+	if (packed.data != nullptr) { //files in the pack all change together, when the pack is rebuilt
+		sourceSize = packed.size;
+		sourceModified = assetPack.Modified();
+	}
+	else {
+		cached = cached && SourceInfo(filePath, sourceSize, sourceModified);
+	}
+	string cachePath;
+	if (cached) {
+		cachePath = CachePath(filePath);
+		if (Map(cachePath, filePath, sourceSize, sourceModified, image)) {
+			lock_guard<mutex> guard(lock);
+			hits++;
+			hitMs += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+			return true;
+		}
+	}
+
+	image.pixels = nullptr;
+	if (packed.data != nullptr) {
+		image.pixels = DecodeImage(packed.data, packed.size, image.width, image.height);
+	}
+	else {
+		size_t fileSize;
+		void* file = MapFile(filePath, fileSize);
+		if (file != nullptr) {
+			image.pixels = DecodeImage((const unsigned char*)file, fileSize, image.width, image.height);
+			UnmapFile(file, fileSize);
+		}
+	}
+	if (image.pixels == nullptr) {
+		return false;
+	}
+	if (cached) {
+		Write(cachePath, filePath, sourceSize, sourceModified, image);
+	}
+	lock_guard<mutex> guard(lock);
+	misses++;
+	missMs += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	return true;
+}
+
+//Maps the cache file and checks it belongs to this version of the source, false if it is missing or stale
+bool TextureCache::Map(const string& cachePath, const char* filePath, long long sourceSize, long long sourceModified, DecodedImage& image) {
+	size_t pathLength = strlen(filePath);
+	size_t size;
+	void* mapping = MapFile(cachePath.c_str(), size);
+	if (mapping == nullptr) {
+		return false;
+	}
+
+	const TextureCacheHeader* header = (const TextureCacheHeader*)mapping;
+	const char magic[4] = { 'T', 'X', 'C', (char)TEXTURE_CACHE_VERSION };
+	bool valid = size >= sizeof(TextureCacheHeader) && memcmp(header->magic, magic, 4) == 0 && header->sourceSize == sourceSize && header->sourceModified == sourceModified &&
+		header->pathLength == pathLength && sizeof(TextureCacheHeader) + pathLength <= size &&
+		memcmp((const char*)mapping + sizeof(TextureCacheHeader), filePath, pathLength) == 0 &&
+		header->width > 0 && header->height > 0 && header->pixelOffset + (size_t)header->width * header->height * 4 == size;
+	image.mapping = mapping;
+	image.mappingSize = size;
+	if (!valid) {
+		Free(image);
+		return false;
+	}
+	image.pixels = (unsigned char*)mapping + header->pixelOffset;
+	image.width = header->width;
+	image.height = header->height;
+	return true;
+}
+
+//Writes to a temporary file first and renames it, so a crash or another thread never leaves half a cache file behind
+void TextureCache::Write(const string& cachePath, const char* filePath, long long sourceSize, long long sourceModified, const DecodedImage& image) {
+	PROFILE_ZONE("TextureCache::Write");
+	{
+		lock_guard<mutex> guard(lock);
+		if (!directoryMade) {
+#ifdef _WINDOWS
+			_mkdir(directory.c_str());
+#else
+			mkdir(directory.c_str(), 0755);
+#endif
+			directoryMade = true;
+		}
+	}
+	TextureCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic[0] = 'T';
+	header.magic[1] = 'X';
+	header.magic[2] = 'C';
+	header.magic[3] = (char)TEXTURE_CACHE_VERSION;
+	header.pathLength = strlen(filePath);
+	header.sourceSize = sourceSize;
+	header.sourceModified = sourceModified;
+	header.width = image.width;
+	header.height = image.height;
+	header.pixelOffset = (sizeof(header) + header.pathLength + 15) & ~15u;
+	char zeros[16] = { 0 };
+
+	char suffix[32];
+	snprintf(suffix, sizeof(suffix), ".%llx.tmp", (unsigned long long)hash<thread::id>()(this_thread::get_id()));
+	string temporaryPath = cachePath + suffix;
+	FILE* file = fopen(temporaryPath.c_str(), "wb");
+	if (file == nullptr) {
+		return; //no cache this time, the image was still decoded
+	}
+	bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+		fwrite(filePath, 1, header.pathLength, file) == header.pathLength &&
+		fwrite(zeros, 1, header.pixelOffset - sizeof(header) - header.pathLength, file) == header.pixelOffset - sizeof(header) - header.pathLength &&
+		fwrite(image.pixels, (size_t)image.width * image.height * 4, 1, file) == 1;
+	written = (fclose(file) == 0) && written;
+	remove(cachePath.c_str()); //rename will not replace a file on Windows
+	if (!written || rename(temporaryPath.c_str(), cachePath.c_str()) != 0) {
+		remove(temporaryPath.c_str());
+	}
+}
+
+void TextureCache::Free(DecodedImage& image) {
+	if (image.mapping != nullptr) {
+		UnmapFile(image.mapping, image.mappingSize);
+	}
+	else if (image.pixels != nullptr) {
+		stbi_image_free(image.pixels);
+	}
+	image.pixels = nullptr;
+	image.mapping = nullptr;
+	image.mappingSize = 0;
+}
+
+void TextureCache::SetEnabled(bool enabled) {
+	this->enabled = enabled;
+}
+
+int TextureCache::Hits() {
+	lock_guard<mutex> guard(lock);
+	return hits;
+}
+
+int TextureCache::Misses() {
+	lock_guard<mutex> guard(lock);
+	return misses;
+}
+
+void TextureCache::PrintStats(FILE* out) {
+	lock_guard<mutex> guard(lock);
+	fprintf(out, "texture cache: %d hits in %.2f ms, %d misses in %.2f ms\n", hits, hitMs, misses, missMs);
+}
+
+void TextureCache::PrintStatsJSON(FILE* out) {
+	lock_guard<mutex> guard(lock);
+	fprintf(out, "{\"hits\": %d, \"hit_ms\": %.3f, \"misses\": %d, \"miss_ms\": %.3f}", hits, hitMs, misses, missMs);
+}
@@ -0,0 +1,76 @@
+
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <vector>
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+	#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_RGB565
+	#define GL_RGB565 0x8D62
+#endif
+
+#define TEXTURE_LOSSY_TOLERANCE 2 //with SetLossyTextureFormats, most a channel may change by for a smaller format to be picked (--compare's tolerance)
+#define TEXTURE_COMPRESS_MIN_SIZE 256 //textures narrower or shorter than this are never block compressed
+
+//TextureFormat - how a texture is stored on the GPU, smallest first within each group
+enum TextureFormat {
+	TEXTURE_LUMINANCE8, //opaque grey
+	TEXTURE_LUMINANCE8_ALPHA8, //grey with alpha, like the fonts
+	TEXTURE_RGB565, //opaque colour with few enough levels
+	TEXTURE_RGBA4444, //colour and alpha with 16 levels each
+	TEXTURE_DXT5, //block compressed (lossy, only with SetTextureCompression)
+	TEXTURE_RGBA8
+};
+
+//TextureUpload - pixels converted for glTexImage2D (or glCompressedTexImage2D when compressed)
+struct TextureUpload {
+	GLint internalFormat;
+	GLenum format;
+	GLenum type;
+	bool compressed;
+	std::vector<unsigned char> data; //empty when the RGBA8 source is uploaded as it is
+};
+
+//TextureMemory - what the textures uploaded so far take on the GPU, and what they would take as RGBA8
+struct TextureMemory {
+	int textures;
+	size_t bytes;
+	size_t rgba8Bytes;
+
+	void Add(TextureFormat format, int width, int height);
+	void Print(FILE* out) const;
+};
+
+extern TextureMemory textureMemory;
+
+/* SetTextureCompression()
+	\description - Lets ChooseTextureFormat pick DXT5 for large textures no smaller format fits, if the driver supports it
+*/
+void SetTextureCompression(bool compress);
+
+/* SetLossyTextureFormats()
+	\description - Lets ChooseTextureFormat pick a smaller format that changes channels by up to TEXTURE_LOSSY_TOLERANCE
+*/
+void SetLossyTextureFormats(bool lossy);
+
+/* ChooseTextureFormat()
+	\description - Picks the smallest format that stores every pixel exactly (or within tolerance, see SetLossyTextureFormats and SetTextureCompression)
+	\param pixels - RGBA pixels, width * height of them
+*/
+TextureFormat ChooseTextureFormat(const unsigned char* pixels, int width, int height);
+
+/* ConvertTexture()
+	\description  - Converts RGBA pixels to a format. Uploads need GL_UNPACK_ALIGNMENT 1, rows are packed tightly
+	\param upload - set to the formats to pass to OpenGL and the converted data
+*/
+void ConvertTexture(TextureFormat format, const unsigned char* pixels, int width, int height, TextureUpload& upload);
+
+size_t TextureFormatBytes(TextureFormat format, int width, int height);
+const char* TextureFormatName(TextureFormat format);
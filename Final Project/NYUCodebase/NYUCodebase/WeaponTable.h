@@ -0,0 +1,81 @@
+
+#pragma once
+
+#include "Simulation.h"
+
+//guns.png is 8 by 4 tiles, guns facing right on the left half and the same guns mirrored on the right half
+#define GUN_SHEET_WIDTH 1280.0f
+#define GUN_SHEET_HEIGHT 640.0f
+#define GUN_SHEET_TILE 160.0f
+
+//GunRect - corners of a gun in guns.png's texture coordinates (0 to 1)
+struct GunRect {
+	float left;
+	float top;
+	float right;
+	float bottom;
+};
+
+//WeaponTable - every gun's stats and sprite, one array per field indexed by gunNumber
+struct WeaponTable {
+	float fireRate[GUN_COUNT]; //shots per second
+	float damage[GUN_COUNT];
+	int magazine[GUN_COUNT];
+	float range[GUN_COUNT]; //distance a bullet travels before it is removed
+	float speed[GUN_COUNT]; //bullet speed
+	GunSound sound[GUN_COUNT];
+	GunRect rect[2][GUN_COUNT]; //[0] facing right, [1] facing left
+};
+
+/* MakeWeaponTable()
+	\description - Builds the table from each gun's row of stats, only ever run by the compiler
+*/
+constexpr WeaponTable MakeWeaponTable() {
+	//rate of fire, damage, magazine size, max range and bullet speed of each gun
+	const float stats[GUN_COUNT][5] = {
+		{ 1.5f, 10.0f, 6, 5, 3 },
+		{ 2.0f, 30.0f, 12, 4, 4 },
+		{ 1.0f, 45.0f, 4, 2, 3 },
+		{ 7.0f, 30.0f, 14, 4, 5 },
+		{ 15.0f, 20.0f, 25, 15, 7 },
+		{ 40.0f, 7.0f, 35, 9, 10 },
+		{ 90.0f, 18.0f, 45, 20, 8 },
+		{ 25.0f, 6.0f, 25, 7, 10 },
+		{ 1.0f, 60.0f, 1, 30, 18 },
+		{ 1.0f, 35.0f, 2, 5, 18 },
+		{ 30.0f, 7.0f, 30, 3, 16 },
+		{ 35.0f, 3.0f, 35, 2, 8 },
+		{ 50.0f, 1.0f, 50, 3, 9 },
+		{ 1.0f, 60.0f, 1, 25, 18 },
+		{ 3.0f, 35.0f, 12, 10, 8 }
+	};
+	WeaponTable table = {};
+	for (int gun = 0; gun < GUN_COUNT; gun++) {
+		table.fireRate[gun] = stats[gun][0];
+		table.damage[gun] = stats[gun][1];
+		table.magazine[gun] = (int)stats[gun][2];
+		table.range[gun] = stats[gun][3];
+		table.speed[gun] = stats[gun][4];
+		if (gun == 1 || gun == 3 || gun == 9) {
+			table.sound[gun] = GUN_SOUND_SHOTGUN;
+		}
+		else if (gun == 8 || gun == 13) {
+			table.sound[gun] = GUN_SOUND_SNIPER;
+		}
+		else {
+			table.sound[gun] = GUN_SOUND_RIFLE;
+		}
+		for (int facing = 0; facing < 2; facing++) {
+			int column = facing == 0 ? gun % 4 : 7 - gun % 4; //the mirrored half runs right to left
+			float x = column * GUN_SHEET_TILE;
+			float y = (gun / 4) * GUN_SHEET_TILE;
+			table.rect[facing][gun].left = x / GUN_SHEET_WIDTH;
+			table.rect[facing][gun].right = (x + GUN_SHEET_TILE) / GUN_SHEET_WIDTH;
+			table.rect[facing][gun].top = y / GUN_SHEET_HEIGHT;
+			table.rect[facing][gun].bottom = (y + GUN_SHEET_TILE) / GUN_SHEET_HEIGHT;
+		}
+	}
+	return table;
+}
+
+constexpr WeaponTable weaponTable = MakeWeaponTable();
@@ -5,13 +5,33 @@
 #include <SDL_opengl.h>
 #include <SDL_image.h>
 #include <SDL_mixer.h>
-#include <map>
 #include <string>
 #include <vector>
 #include <stdlib.h>     /* srand, rand */
 #include <time.h>       /* time */
+#include <string.h>
 #include "ShaderProgram.h"
 #include "Matrix.h"
+#include "Simulation.h"
+#include "Benchmark.h"
+#include "RenderContext.h"
+#include "RenderStats.h"
+#include "FrameCapture.h"
+#include "Profiler.h"
+#include "FrameStats.h"
+#include "PerfOverlay.h"
+#include "AllocationTracker.h"
+#include "MatchArena.h"
+#include "FrameScratch.h"
+#include "TextureAtlas.h"
+#include "AssetLoader.h"
+#include "TextureCache.h"
+#include "AssetPack.h"
+#include "TextureFormat.h"
+#include "PngDecoder.h"
+#include "ResourceRegistry.h"
+#include "WeaponTable.h"
+#include <chrono>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -23,33 +43,43 @@
 #define RESOURCE_FOLDER "NYUCodebase.app/Contents/Resources/"
 #endif
 
-#define TIME_STEP_SIZE 0.0016f //Used to ensure that collisions are still detected properly during lag spikes
-
 //State Modes for GameState
 #define MENU_MODE 0 
 #define GAME_MODE 1
 #define GAME_OVER_MODE 2
-
-//Game State Constants
-#define PLAYER_Vx 3.5
-#define PLAYER_Vy 3.5
-#define BOARD_LENGTH 50
-#define BOARD_HEIGHT 18
+static const char* const modeNames[] = { "MENU_MODE", "GAME_MODE", "GAME_OVER_MODE" }; //for the frame time summary
 
 #define PI 3.141592653 //An approximation of Pi.
 
+#define FRAME_BUDGET_MS 16.7f //frames slower than this (60fps) are reported as hitches
+#define HITCH_HISTORY 8 //frames kept in each hitch snapshot
+#define ALLOCATION_WARMUP_FRAMES 60 //GAME_MODE frames after a match starts that --alloc-test does not check yet
+#define ALLOCATION_REPORT_CALLSITES 10 //call stacks printed by --alloc-sample and --alloc-test
+
 //Screen Definitions
 #define WINDOW_HEIGHT 1920
 #define WINDOW_WIDTH 1080
 #define FULLSCREEN_MODE  //Comment out this line in not have a fullscreen game.
 using namespace std;
 
+//SpriteSheet - images packed into the atlas for a match, see sheetNames
+enum SpriteSheet {
+	SHEET_TERRAIN,
+	SHEET_GUNS,
+	SHEET_CHARACTER1,
+	SHEET_BULLET,
+	SHEET_CHARACTER2,
+	SPRITE_SHEETS
+};
+
 class GameState {
 public:
 	/* GameState()
-		\description - Constructor
+		\description       - Constructor, starts loading the game's images, sounds and music in the background
+		\param loadThreads - worker threads for the AssetLoader, 0 to load everything here before returning
 	*/
-	GameState() {
+	GameState(int loadThreads) : loader(loadThreads), matchArena(MATCH_ARENA_BYTES) {
+		PROFILE_ZONE("GameState::GameState");
 		//Initialize Matrices for ShaderProgram
 		modelMatrix.Identity();
 		viewMatrix.Identity();
@@ -57,17 +87,43 @@ public:
 		projectionMatrix.SetOrthoProjection(-16.0f, 16.0f, -9.0f, 9.0f, -1.0f, 1.0f);
 
 		//Load .glsl files into program for textured drawings
+		ShaderProgram program;
 		program.Load(RESOURCE_FOLDER"vertex_textured.glsl", RESOURCE_FOLDER"fragment_textured.glsl");
 
-		glUseProgram(program.programID); //Tell OpenGL to use the program
+		CountedUseProgram(program.programID); //Tell OpenGL to use the program
 
 		//Set program to use the matrices that were initialized
 		program.SetModelMatrix(modelMatrix);
 		program.SetProjectionMatrix(projectionMatrix);
 		program.SetViewMatrix(viewMatrix);
+		texturedProgram = programs.Intern("textured");
+		programs.Set(texturedProgram, program);
+
+		//Intern every sprite and sound now, so drawing and playing them never looks a name up. PumpAssets fills them in
+		fontSprite = sprites.Intern("font");
+		for (int i = 0; i < SPRITE_SHEETS; i++) {
+			sheetSprites[i] = sprites.Intern(sheetNames[i]);
+		}
+		for (int i = 0; i < GUN_SOUNDS; i++) {
+			gunSoundHandles[i] = sounds.Intern(gunSoundNames[i]);
+		}
 
 		lastTicks = 0;
 
+		//Nothing is created for a match until the game starts
+		board = nullptr;
+		playerOne = nullptr;
+		playerTwo = nullptr;
+		gunOne = nullptr;
+		gunTwo = nullptr;
+		bulletDrawer = nullptr;
+		newGame = true;
+		matchSeed = 0;
+		fixedFrameTime = 0;
+		scriptedPlayers = false;
+		substeps = 0;
+		matchStartAllocations = 0;
+
 		currentState = MENU_MODE; //set initial state of the game to be in the MENU_MODE
 		nextState = MENU_MODE; // set the next state (on next Update call) to also be the MENU_MODE
 
@@ -78,24 +134,20 @@ public:
 		frames = 0; //so far 0 frames have been drawn so we will initialize this to 0
 
 
-		//Insert gun sounds for use when firing a gun
-		gunSoundMap.insert(pair<string, Mix_Chunk*>("sniper", Mix_LoadWAV("sniper.wav")));
-		gunSoundMap.insert(pair<string, Mix_Chunk*>("shotgun", Mix_LoadWAV("shotgun.wav")));
-		gunSoundMap.insert(pair<string, Mix_Chunk*>("shotgun_r", Mix_LoadWAV("shotgun_r.wav"))); //Shotgun reloading sound
-		gunSoundMap.insert(pair<string, Mix_Chunk*>("rifle", Mix_LoadWAV("rifle.wav")));
-		//guns sounds are from SoundBible.com (http://soundbible.com/tags-gun.html)
-
-		//Load Music from files
-		menuMusic = Mix_LoadMUS("menuMusic.mp3"); //Copyright from Nintendo Games: This is the Wii Mii Channel song.
-		gameMusic = Mix_LoadMUS("gameMusic.mp3"); //from www.BenSound.com
-
-		//Insert textures for use in drawing
-		textureMap.insert(pair<string, GLuint>("font", LoadTexture("font2.png")));
-		textureMap.insert(pair<string, GLuint>("terrain", LoadTexture("terrain.png")));
-		textureMap.insert(pair<string, GLuint>("guns", LoadTexture("guns.png"))); //gun sheet edited from TdeLeeuw (http://fav.me/d8etym8)
-		textureMap.insert(pair<string, GLuint>("character1", LoadTexture("character1.png")));
-		textureMap.insert(pair<string, GLuint>("bullet", LoadTexture("bullet.png")));
-		textureMap.insert(pair<string, GLuint>("character2", LoadTexture("character2.png")));
+		//Queue every asset, what the menu needs first. PumpAssets picks them up as they finish
+		PROFILE_ZONE("LoadAssets");
+		menuMusic = nullptr;
+		gameMusic = nullptr;
+		fontImage = loader.QueueImage("font2.png");
+		menuMusicAsset = loader.QueueMusic("menuMusic.mp3"); //Copyright from Nintendo Games: This is the Wii Mii Channel song.
+		for (int i = 0; i < SPRITE_SHEETS; i++) {
+			sheetImages[i] = loader.QueueImage(sheetFiles[i]);
+		}
+		for (int i = 0; i < GUN_SOUNDS; i++) {
+			gunSounds[i] = loader.QueueSound(gunSoundFiles[i]);
+		}
+		gameMusicAsset = loader.QueueMusic("gameMusic.mp3"); //from www.BenSound.com
+		PumpAssets();
 	}
 
 	/* ~GameState()
@@ -103,24 +155,12 @@ public:
 	*/
 	~GameState() {
 		//Free up all gun sounds and music
-		for (map<string, Mix_Chunk*>::iterator i = gunSoundMap.begin(); i != gunSoundMap.end(); ++i) {
-			Mix_FreeChunk(i->second);
+		for (ResourceHandle i = 0; i < sounds.Count(); i++) {
+			Mix_FreeChunk(sounds[i]);
 		}
 		Mix_FreeMusic(menuMusic);
 		Mix_FreeMusic(gameMusic);
-
-		//If variables were not deleted already (via GAME_OVER_MODE) delete them
-		if (playerOne != nullptr) {
-			delete playerOne;
-			delete playerTwo;
-			delete gunOne;
-			delete gunTwo;
-			delete board;
-			for (Bullet* bullet : bullets) {
-				delete bullet;
-			}
-			bullets.clear();
-		}
+		//The board, players, guns and bullet drawer are freed with matchArena
 	}
 
 	/* Update()
@@ -129,7 +169,12 @@ public:
 		\param done   - tells external loop if game is over
 	*/
 	void Update(SDL_Event& event, bool&done) {
+		PROFILE_ZONE("GameState::Update");
+		PumpAssets();
 		float ticks = (float)(SDL_GetTicks()) / 1000.0f; //Get the current number of seconds that SDL has been running
+		if (fixedFrameTime > 0) { //benchmarks step a fixed amount of time every frame so runs are repeatable
+			ticks = lastTicks + fixedFrameTime;
+		}
 		float elapsed = ticks - lastTicks; //Calculate the time that has elapsed between the last update call and now
 		if (drawTime != -1) { //If the animation has started, then increase the time that has elapsed for the animation
 			drawTime += elapsed;
@@ -141,9 +186,8 @@ public:
 		lastTicks = ticks; //Update the lastTicks
 		currentState = nextState; //Update the currentState of the game
 
-		float time = elapsed; //Initialize another variable that updates the game in increments of TIME_STEP_SIZE
-
-		float pos[3] = { 0,0,0 }; //Initialize position for various game elements {x,y,z} although z-coordinates are not used in this game
+		SimInput input; //Buttons held down by each player this frame
+		SimEvents events; //Sounds requested by each simulation tick
 
 		const Uint8 *keyboard = SDL_GetKeyboardState(NULL); //Get the state of the keyboard
 		
@@ -176,220 +220,43 @@ public:
 			//If we are in-game
 		case GAME_MODE:
 			if (newGame) {
+				PROFILE_ZONE("StartMatch");
+				WaitForGameAssets(); //only waits if the match is started before the loader has finished
+				AllocationStats allocationsBefore = ThreadAllocationStats();
 				//For a new game
 				newGame = false; //we are no longer in a new game after this
 				Mix_HaltMusic(); //Stop the menu music
 				Mix_PlayMusic(gameMusic, -1); //Begin the game-music
 
-				board = new Map(BOARD_LENGTH, BOARD_HEIGHT, 0.93f, program, textureMap["terrain"]); //Create a new game board
-
-				//initialize start position of playerOne
-				pos[0] = 13;
-				pos[1] = -10;
-				playerOne = new Character(1, pos, textureMap["character1"], program); //Create playerOne
-				
-				//Adjust start position of playerTwo
-				pos[0] = 20;
-				playerTwo = new Character(2, pos, textureMap["character2"], program); //Create playerTwo
-
-				//Create the guns for playerOne and playerTwo (gunOne and gunTwo respectively)
-				gunOne = new Gun(*playerOne, textureMap["guns"], program, textureMap["bullet"], gunSoundMap);
-				gunTwo = new Gun(*playerTwo, textureMap["guns"], program, textureMap["bullet"], gunSoundMap);
-			}
-			//If the elapsed time is greater than the TIME_STEP_SIZE, we have to update incrementally
-			while (time > TIME_STEP_SIZE) {
-				
-				//Detect Movement
-				if (keyboard[SDL_SCANCODE_D] && !playerOne->collisionFlags[2]) { //If D is pressed and playerOne can move to right
-					playerOne->setVelocity(PLAYER_Vx, -100.0f, -100.0f); //allow playerOne to move right
-				}
-				else if (keyboard[SDL_SCANCODE_A] && !playerOne->collisionFlags[1]) { //If A is pressed and playerOne can move left
-					playerOne->setVelocity(-PLAYER_Vx, -100.0f, -100.0f); //allow playerOne to move left
-				}
-				else {
-					playerOne->setVelocity(0, -100.0f, -100.0f); //otherwise set their horizontal velocity to zero.
-				}
-				if (keyboard[SDL_SCANCODE_W] && playerOne->collisionFlags[0]) { //if W is pressed and playerOne is on the ground
-					playerOne->setVelocity(-100.0f, PLAYER_Vy, -100.0f); //make playerOne jump
-				}
-				
-				if (keyboard[SDL_SCANCODE_RIGHT] && !playerTwo->collisionFlags[2]) { //if the right arrow is pressed and playerTwo can move right
-					playerTwo->setVelocity(PLAYER_Vx, -100.0f, -100.0f); //allow playerTwo to move right
-				}
-				else if (keyboard[SDL_SCANCODE_LEFT] && !playerTwo->collisionFlags[1]) { //if the left arrow is pressed and playerTwo can move left
-					playerTwo->setVelocity(-PLAYER_Vx, -100.0f, -100.0f); //allow playerTwo to move left
-				}
-				else {
-					playerTwo->setVelocity(0, -100.0f, -100.0f); //otherwise set their horizontal velocity to zero. 
-				}
-				if (keyboard[SDL_SCANCODE_UP] && playerTwo->collisionFlags[0]) { //if playerTwo is on the ground and the up arrow is pressed
-					playerTwo->setVelocity(-100.0f, PLAYER_Vy, -100.0f); //make playerTwo jump
-				}
-
-				//Shift Guns
-				if (letGo[0]) { //If playerOne has let go of the buttons to shift guns
-					if (keyboard[SDL_SCANCODE_Q]) { //if Q is pressed
-						gunOne->ShiftGun(-1); //Rotate the gun number back one
-						letGo[0] = false; //set flag that a button is pressed
-					}
-					else if (keyboard[SDL_SCANCODE_E]) { //if E was pressed
-						gunOne->ShiftGun(1); //Rotate the gun number forward one
-						letGo[0] = false; //set flag that button is pressed
-					}
-				}
-				else if (!keyboard[SDL_SCANCODE_Q] && !keyboard[SDL_SCANCODE_E]) { //if Q & E are not pressed 
-					letGo[0] = true;  //set flag that the buttons have been released
-				}
-
-				if (letGo[1]) { //If playerTwo has let go of the buttons to shift guns
-					if (keyboard[SDL_SCANCODE_PAGEUP] || keyboard[SDL_SCANCODE_SLASH]) { //if PAGE_UP or Forward_Slash (/) is pressed
-						gunTwo->ShiftGun(1); //Rotate the gun number forward one
-						letGo[1] = false; //set flag that button is pressed
-					}
-					else if (keyboard[SDL_SCANCODE_PAGEDOWN] || keyboard[SDL_SCANCODE_PERIOD]) { //if PAGE_DOWN or Period (.) is pressed
-						gunTwo->ShiftGun(-1); //Rotate the gun number back one
-						letGo[1] = false; //set flag that button is pressed
-					}
-				}
-				else if (!keyboard[SDL_SCANCODE_PAGEUP] && !keyboard[SDL_SCANCODE_PAGEDOWN] && !keyboard[SDL_SCANCODE_PERIOD] && !keyboard[SDL_SCANCODE_SLASH]) { 
-					//If PAGE_UP, PAGE_DOWN, Forward Slash, and Period are all NOT pressed
-					letGo[1] = true; //set flag that buttons have been released
-				}
-
-				//Player-Gun Movement
-				playerOne->move(TIME_STEP_SIZE);
-				playerTwo->move(TIME_STEP_SIZE);
-				gunOne->Reposition(); //reposition guns to match player's location
-				gunTwo->Reposition();
-				
-				//Shooting
-				if (keyboard[SDL_SCANCODE_S]) { //if S is pressed
-					Bullet* bullet = gunOne->Shoot(); //PlayerOne attempts to shoot a bullet
-					if (bullet != nullptr) { //If they are successful, add that bullet to our vector of bullets
-						bullets.push_back(bullet);
-					}
-				}
-				if (keyboard[SDL_SCANCODE_DOWN] || keyboard[SDL_SCANCODE_RSHIFT]) { //If the down arrow or right shift are pressed
-					Bullet* bullet = gunTwo->Shoot(); //PlayerTwo attempts to shoot a bullet
-					if (bullet != nullptr) { //If they are successful, add that bullet to our vector of bullets
-						bullets.push_back(bullet);
-					}
-				}
-				
-				//Bullet Movement
-				for (Bullet* bullet : bullets) {
-					bullet->move(TIME_STEP_SIZE);
-				}
-
-				//Collision detection and cleanup
-				Collision(); //Check for any and all collisions
-				for (int i = 0; i < bullets.size();) { //go through all of the bullets and remove all dead bullets (those which cannot exist anymore)
-					if (bullets[i]->deadBullet()) {
-						delete bullets[i];
-						bullets.erase(bullets.begin() + i);
-					}
-					else {
-						i++;
-					}
-				}
-				time -= TIME_STEP_SIZE; //subtract timestamp and continue in loop
+				SimulationInit(simulation, matchSeed != 0 ? matchSeed : (unsigned int)time(NULL)); //Generate a new board and place both players
+				accumulator = 0;
+
+				//Create the objects that draw the board, players, guns and bullets from the simulation (all freed together when the match ends)
+				ShaderProgram& program = programs[texturedProgram];
+				board = matchArena.New<Map>(simulation, program, sprites[sheetSprites[SHEET_TERRAIN]]);
+				playerOne = matchArena.New<Character>(simulation.players[0], sprites[sheetSprites[SHEET_CHARACTER1]], program);
+				playerTwo = matchArena.New<Character>(simulation.players[1], sprites[sheetSprites[SHEET_CHARACTER2]], program);
+				gunOne = matchArena.New<Gun>(simulation.guns[0], simulation.players[0], sprites[sheetSprites[SHEET_GUNS]], program);
+				gunTwo = matchArena.New<Gun>(simulation.guns[1], simulation.players[1], sprites[sheetSprites[SHEET_GUNS]], program);
+				bulletDrawer = matchArena.New<Bullet>(sprites[sheetSprites[SHEET_BULLET]], program);
+				matchStartAllocations = (int)(ThreadAllocationStats().allocations - allocationsBefore.allocations);
 			}
-			if (time > 0) { //If there is still some time remaining repeat what was done in the loop except we move by the remaining time instead of the TIME_STEP
-
-							//Detect Movement
-				if (keyboard[SDL_SCANCODE_D] && !playerOne->collisionFlags[2]) { //If D is pressed and playerOne can move to right
-					playerOne->setVelocity(PLAYER_Vx, -100.0f, -100.0f); //allow playerOne to move right
-				}
-				else if (keyboard[SDL_SCANCODE_A] && !playerOne->collisionFlags[1]) { //If A is pressed and playerOne can move left
-					playerOne->setVelocity(-PLAYER_Vx, -100.0f, -100.0f); //allow playerOne to move left
-				}
-				else {
-					playerOne->setVelocity(0, -100.0f, -100.0f); //otherwise set their horizontal velocity to zero.
-				}
-				if (keyboard[SDL_SCANCODE_W] && playerOne->collisionFlags[0]) { //if W is pressed and playerOne is on the ground
-					playerOne->setVelocity(-100.0f, PLAYER_Vy, -100.0f); //make playerOne jump
-				}
-
-				if (keyboard[SDL_SCANCODE_RIGHT] && !playerTwo->collisionFlags[2]) { //if the right arrow is pressed and playerTwo can move right
-					playerTwo->setVelocity(PLAYER_Vx, -100.0f, -100.0f); //allow playerTwo to move right
-				}
-				else if (keyboard[SDL_SCANCODE_LEFT] && !playerTwo->collisionFlags[1]) { //if the left arrow is pressed and playerTwo can move left
-					playerTwo->setVelocity(-PLAYER_Vx, -100.0f, -100.0f); //allow playerTwo to move left
-				}
-				else {
-					playerTwo->setVelocity(0, -100.0f, -100.0f); //otherwise set their horizontal velocity to zero. 
-				}
-				if (keyboard[SDL_SCANCODE_UP] && playerTwo->collisionFlags[0]) { //if playerTwo is on the ground and the up arrow is pressed
-					playerTwo->setVelocity(-100.0f, PLAYER_Vy, -100.0f); //make playerTwo jump
-				}
-
-				//Shift Guns
-				if (letGo[0]) { //If playerOne has let go of the buttons to shift guns
-					if (keyboard[SDL_SCANCODE_Q]) { //if Q is pressed
-						gunOne->ShiftGun(-1); //Rotate the gun number back one
-						letGo[0] = false; //set flag that a button is pressed
-					}
-					else if (keyboard[SDL_SCANCODE_E]) { //if E was pressed
-						gunOne->ShiftGun(1); //Rotate the gun number forward one
-						letGo[0] = false; //set flag that button is pressed
-					}
-				}
-				else if (!keyboard[SDL_SCANCODE_Q] && !keyboard[SDL_SCANCODE_E]) { //if Q & E are not pressed 
-					letGo[0] = true;  //set flag that the buttons have been released
-				}
-
-				if (letGo[1]) { //If playerTwo has let go of the buttons to shift guns
-					if (keyboard[SDL_SCANCODE_PAGEUP] || keyboard[SDL_SCANCODE_SLASH]) { //if PAGE_UP or Forward_Slash (/) is pressed
-						gunTwo->ShiftGun(1); //Rotate the gun number forward one
-						letGo[1] = false; //set flag that button is pressed
-					}
-					else if (keyboard[SDL_SCANCODE_PAGEDOWN] || keyboard[SDL_SCANCODE_PERIOD]) { //if PAGE_DOWN or Period (.) is pressed
-						gunTwo->ShiftGun(-1); //Rotate the gun number back one
-						letGo[1] = false; //set flag that button is pressed
-					}
-				}
-				else if (!keyboard[SDL_SCANCODE_PAGEUP] && !keyboard[SDL_SCANCODE_PAGEDOWN] && !keyboard[SDL_SCANCODE_PERIOD] && !keyboard[SDL_SCANCODE_SLASH]) {
-					//If PAGE_UP, PAGE_DOWN, Forward Slash, and Period are all NOT pressed
-					letGo[1] = true; //set flag that buttons have been released
-				}
-
-				//Actual Movement
-				playerOne->move(time);
-				playerTwo->move(time);
-				gunOne->Reposition(); //reposition guns to match player's location
-				gunTwo->Reposition();
-
-				//Shooting
-				if (keyboard[SDL_SCANCODE_S]) { //if S is pressed
-					Bullet* bullet = gunOne->Shoot(); //PlayerOne attempts to shoot a bullet
-					if (bullet != nullptr) { //If they are successful, add that bullet to our vector of bullets
-						bullets.push_back(bullet);
-					}
-				}
-				if (keyboard[SDL_SCANCODE_DOWN] || keyboard[SDL_SCANCODE_RSHIFT]) { //If the down arrow or right shift are pressed
-					Bullet* bullet = gunTwo->Shoot(); //PlayerTwo attempts to shoot a bullet
-					if (bullet != nullptr) { //If they are successful, add that bullet to our vector of bullets
-						bullets.push_back(bullet);
-					}
-				}
-
-				for (Bullet* bullet : bullets) {
-					bullet->move(time);
-				}
-
-				//Collision detection and cleanup
-				Collision(); //Check for any and all collisions
-				for (int i = 0; i < bullets.size();) { //go through all of the bullets and remove all dead bullets (those which cannot exist anymore)
-					if (bullets[i]->deadBullet()) {
-						delete bullets[i];
-						bullets.erase(bullets.begin() + i);
-					}
-					else {
-						i++;
-					}
+			//The simulation only moves in whole ticks of TIME_STEP_SIZE, time left over is carried to the next frame
+			input = ReadInput(keyboard);
+			accumulator += elapsed;
+			substeps = 0;
+			while (accumulator >= TIME_STEP_SIZE) {
+				PROFILE_ZONE("SimulationTick");
+				if (scriptedPlayers) {
+					input.buttons[0] = ScriptedButtons(simulation, 0);
+					input.buttons[1] = ScriptedButtons(simulation, 1);
 				}
+				SimulationTick(simulation, input, events);
+				PlayEvents(events);
+				accumulator -= TIME_STEP_SIZE;
+				substeps++;
 			}
-			if (playerOne->isDead() || playerTwo->isDead()) { //If either player is dead
+			if (SimulationWinner(simulation) != 0) { //If either player is dead
 				nextState = GAME_OVER_MODE; //set the next game mode
 				gameOverTimer = ticks; //set start time for gameOver
 				Mix_HaltMusic(); //Stop the in-game music
@@ -400,20 +267,14 @@ public:
 			//if the game is over
 		case GAME_OVER_MODE:
 			if (ticks - gameOverTimer >= 4.7f) { //If the time between the current number of ticks and gameOver beginning is >= 4.7seconds (delay)
-				if (playerOne != nullptr) { //Delete the player and all  of the other game elements
-					delete playerOne;
-					delete playerTwo;
-					delete gunOne;
-					delete gunTwo;
-					delete board;
-					for (Bullet* bullet : bullets) {
-						delete bullet;
-					}
-					bullets.clear();
+				if (playerOne != nullptr) { //Free the players and all of the other game elements
+					PROFILE_ZONE("EndMatch");
+					matchArena.Reset();
 					playerOne = nullptr;
 					playerTwo = nullptr;
 					gunOne = nullptr;
 					gunTwo = nullptr;
+					bulletDrawer = nullptr;
 					board = nullptr;
 				}
 				newGame = true;
@@ -423,17 +284,146 @@ public:
 		}
 	}
 	
+	/* StartMatch()
+		\description   - Skips the menu and starts a match on the next Update call (used by the frame benchmark)
+		\param seed    - seed for the board, 0 to seed from the clock like the menu does
+		\param frame   - seconds that pass every Update call, 0 to use SDL_GetTicks
+		\param scripted - true to let scripted players play the match instead of the keyboard
+	*/
+	void StartMatch(unsigned int seed, float frame, bool scripted) {
+		matchSeed = seed;
+		fixedFrameTime = frame;
+		scriptedPlayers = scripted;
+		nextState = GAME_MODE;
+		newGame = true;
+	}
+
+	/* CurrentState()
+		\description - MENU_MODE, GAME_MODE or GAME_OVER_MODE
+	*/
+	int CurrentState() const {
+		return currentState;
+	}
+
+	/* NextState()
+		\description - Mode the next Update call will run in
+	*/
+	int NextState() const {
+		return nextState;
+	}
+
+	/* Substeps()
+		\description - Simulation ticks run by the last Update call
+	*/
+	int Substeps() const {
+		return currentState == GAME_MODE ? substeps : 0;
+	}
+
+	/* LiveBullets()
+		\description - Bullets in flight in the current match
+	*/
+	int LiveBullets() const {
+		return currentState == GAME_MODE ? (int)simulation.bullets.size() : 0;
+	}
+
+	/* Arena()
+		\description - Memory of the objects that live as long as a match, for sizing MATCH_ARENA_BYTES
+	*/
+	const MatchArena& Arena() const {
+		return matchArena;
+	}
+
+	/* MatchStartAllocations()
+		\description - Heap allocations made while the last match was being set up, 0 once the arena and the simulation have grown to fit
+	*/
+	int MatchStartAllocations() const {
+		return matchStartAllocations;
+	}
+
+	/* FontSprite()
+		\description - Font in the atlas, shared with the performance overlay. Waits for the font if it is still loading
+	*/
+	AtlasSprite FontSprite() {
+		if (!sprites.Loaded(fontSprite)) {
+			loader.Wait(fontImage);
+			PumpAssets();
+		}
+		return sprites[fontSprite];
+	}
+
+	/* WaitForMenuAssets()
+		\description - Blocks until the menu can be drawn and its music played
+	*/
+	void WaitForMenuAssets() {
+		if (fontImage >= 0) {
+			loader.Wait(fontImage);
+		}
+		if (menuMusicAsset >= 0) {
+			loader.Wait(menuMusicAsset);
+		}
+		PumpAssets();
+	}
+
+	/* WaitForGameAssets()
+		\description - Blocks until everything has loaded
+	*/
+	void WaitForGameAssets() {
+		loader.WaitAll();
+		PumpAssets();
+	}
+
+	/* MenuAssetsReady()
+		\description - True once the font is in the atlas and the menu music has loaded
+	*/
+	bool MenuAssetsReady() const {
+		return fontImage < 0 && menuMusicAsset < 0;
+	}
+
+	/* AssetsReady()
+		\description - True once every asset has been taken from the loader
+	*/
+	bool AssetsReady() const {
+		bool ready = MenuAssetsReady() && gameMusicAsset < 0;
+		for (int i = 0; i < SPRITE_SHEETS; i++) {
+			ready = ready && sheetImages[i] < 0;
+		}
+		for (int i = 0; i < GUN_SOUNDS; i++) {
+			ready = ready && gunSounds[i] < 0;
+		}
+		return ready;
+	}
+
+	/* LoadThreads()
+		\description - Worker threads loading assets, 0 if they were loaded by the constructor
+	*/
+	int LoadThreads() const {
+		return loader.Threads();
+	}
+
+	/* Atlas()
+		\description - Atlas every sprite is drawn from
+	*/
+	const TextureAtlas& Atlas() const {
+		return atlas;
+	}
+
 	/* Draw()
 		\description - Draws game elements and Text Entities
 	*/
 	void Draw() {
-		TextEntity TextDrawer(program, textureMap["font"]); //Create an entity meant to draw Text Entities
+		PROFILE_ZONE("GameState::Draw");
+		if (!sprites.Loaded(fontSprite)) { //every mode draws text, nothing can be drawn until the font has loaded
+			return;
+		}
+		ShaderProgram& program = programs[texturedProgram];
+		TextEntity TextDrawer(program, sprites[fontSprite]); //Create an entity meant to draw Text Entities
 		float pos[3] = { 0,0,0 }; //Array showing the {x,y,z} positions of a particular entity to be drawn by the TextDrawer
 		float avgX = 0; //variable representing the average xCoordinates between playerOne and playerTwo
 		switch (currentState) {
 			//If we are in the menu
 		case MENU_MODE:
 			if (frames == 65) { //allows for music to sync with song (there was a part I felt would be nice to sync with animation and wouldn't in fullscreen).
+				WaitForMenuAssets(); //the song has had 65 frames to load, this only waits on a very slow disk
 				Mix_PlayMusic(menuMusic, -1);
 				frames = -1;
 			}
@@ -472,15 +462,15 @@ public:
 			playerTwo->draw();
 			gunOne->draw();
 			gunTwo->draw();
-			for (Bullet* bullet : bullets) {
-				bullet->draw();
+			for (const SimBullet& bullet : simulation.bullets) {
+				bulletDrawer->draw(bullet, simulation.time);
 			}
 
 			//Setting viewMatrix to follow the two characters and not to overstep the bounds of the map (does not show black portion of screen)
 			viewMatrix.Identity();
 			viewMatrix.Translate(0, (BOARD_HEIGHT/ 2), 0);
 			pos[1] = -1;// -BOARD_HEIGHT / 2 - 2;
-			avgX = (playerOne->position[0] + playerTwo->position[0]) / 2; //calculate average xCoordinate
+			avgX = (simulation.players[0].position[0] + simulation.players[1].position[0]) / 2; //calculate average xCoordinate
 			if (avgX < 16) { //avgX is less than the leftmost that the camera can pan
 				viewMatrix.Translate(-16, 0, 0);
 				pos[0] = 0.7;
@@ -494,11 +484,11 @@ public:
 				pos[0] = avgX - 15.3;
 			}
 			//Draw the health remaining for each player at the top left and right corners of the screen
-			TextDrawer.Draw("PLAYER ONE: " + to_string(int(playerOne->health)), pos, 1, -.4);
+			TextDrawer.Draw("PLAYER ONE: " + to_string(int(simulation.players[0].health)), pos, 1, -.4);
 			pos[0] += 22;
-			TextDrawer.Draw("PLAYER TWO: " + to_string(int(playerTwo->health)), pos, 1, -.4);
+			TextDrawer.Draw("PLAYER TWO: " + to_string(int(simulation.players[1].health)), pos, 1, -.4);
 			program.SetViewMatrix(viewMatrix);
-			glUseProgram(program.programID);
+			CountedUseProgram(program.programID);
 			break;
 
 		//If the game is over
@@ -508,7 +498,7 @@ public:
 				program.SetViewMatrix(viewMatrix);
 				pos[0] = -13.0f;
 				//Draw a text entity that states the winner
-				if (playerOne->isDead()) {
+				if (SimulationWinner(simulation) == simulation.players[1].sentiment) {
 					TextDrawer.Draw("Player Two Wins!", pos, 3, -1.28f);
 				}
 				else {
@@ -525,11 +515,11 @@ private:
 		/* TextEntity()
 			\description         - Constructor
 			\param shaderProgram - Game's ShaderProgram
-			\param textureID     - ID of Font for use in the drawing
+			\param font          - Font in the atlas for use in the drawing
 		*/
-		TextEntity(ShaderProgram& shaderProgram, GLuint& textureID) {
+		TextEntity(ShaderProgram& shaderProgram, const AtlasSprite& font) {
 			program = &shaderProgram;
-			texture = textureID;
+			sprite = font;
 		}
 
 		/* Draw():
@@ -550,16 +540,23 @@ private:
 		*/
 		void Draw(const std::string& text, float* position, float size, float spacing, float elapsed = -1000, int typeX = 0, float xStart = -1,
 			float xFinish = -1, float xD = -1, int typeY = 0, float yStart = -1, float yFinish = -1, float yD = -1) {
+			PROFILE_ZONE("TextEntity::Draw");
 			
 			float texture_size = 1 / 16.0f; //font sprite sheet is a 16x16 grid so textures sizes are 1/16th the size of the image
-			vector<float> vertexData; //vector to store vertices to draw on the screen
-			vector<float> texCoordData; //Stores texture coordinates
+			ScratchVector<float> vertexData; //vector to store vertices to draw on the screen
+			ScratchVector<float> texCoordData; //Stores texture coordinates
+			vertexData.reserve(text.size() * 12);
+			texCoordData.reserve(text.size() * 12);
 
 			for (int i = 0; i < text.size(); i++) { //Loop through the entire string
 				int spriteIndex = (int)text[i]; //get the ascii character of the current letter
 
 				float texture_x = (float)(spriteIndex % 16) / 16.0f; //get the x & y positions of the letter in the spritesheet
 				float texture_y = (float)(spriteIndex / 16) / 16.0f;
+				float left = sprite.U(texture_x); //and where that cell is in the atlas
+				float right = sprite.U(texture_x + texture_size);
+				float top = sprite.V(texture_y);
+				float bottom = sprite.V(texture_y + texture_size);
 
 				vertexData.insert(vertexData.end(), { //Insert the vertex data
 					((size + spacing) * i) + (-0.5f * size), 0.5f * size,
@@ -570,20 +567,20 @@ private:
 					((size + spacing) * i) + (-0.5f * size), -0.5f * size,
 					});
 				texCoordData.insert(texCoordData.end(), { //Insert the texture data
-					texture_x, texture_y,
-					texture_x, texture_y + texture_size,
-					texture_x + texture_size, texture_y,
-					texture_x + texture_size, texture_y + texture_size,
-					texture_x + texture_size, texture_y,
-					texture_x, texture_y + texture_size,
+					left, top,
+					left, bottom,
+					right, top,
+					right, bottom,
+					right, top,
+					left, bottom,
 					});
 			}
 			//Set up OpenGL for drawing
-			glBindTexture(GL_TEXTURE_2D, texture);
-			glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertexData.data());
-			glEnableVertexAttribArray(program->positionAttribute);
-			glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, texCoordData.data());
-			glEnableVertexAttribArray(program->texCoordAttribute);
+			CountedBindTexture(GL_TEXTURE_2D, sprite.texture);
+			CountedVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertexData.data());
+			CountedEnableVertexAttribArray(program->positionAttribute);
+			CountedVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, texCoordData.data());
+			CountedEnableVertexAttribArray(program->texCoordAttribute);
 
 			modelMatrix.Identity();
 
@@ -630,7 +627,7 @@ private:
 			}
 			modelMatrix.Translate(x, y, position[2]); //form an offset depending on what the animations produced
 			program->SetModelMatrix(modelMatrix); 
-			glDrawArrays(GL_TRIANGLES, 0, vertexData.size() / 2); //Draw the text
+			CountedDrawArrays(GL_TRIANGLES, 0, vertexData.size() / 2); //Draw the text
 		}
 	private:
 		/*
@@ -682,96 +679,37 @@ private:
 		}
 		ShaderProgram * program;
 		Matrix modelMatrix;
-		GLuint texture;
+		AtlasSprite sprite;
 	};
 	
-	//Map Class - Procedurely Generates a 2D Map of given dimensions and detects collisions on the map
+	//Map Class - Draws the board that the simulation generated
 	class Map {
 	public:
 		/* Map()
-			\description   - Constructor that procedurely generates a 2D map
-			\param length  - Length of board to be produced
-			\param height  - Height of board to be produced
-			\param p       - Probability of a column growing
+			\description   - Constructor
+			\param state   - Simulation whose board is drawn
 			\param program - Shader Program to use to draw the map
-			\param texture - Texture that is used on the map when drawing
+			\param sprite  - Terrain sheet in the atlas that is used on the map when drawing
 		 */
-		Map(int length, int height, float p, ShaderProgram& program, GLuint texture) : height(height), length(length), program(&program), texture(texture) {
-			srand(time(NULL)); //Set the seed to the current time
-
-			//Dynamically create a 2D array with [height] rows and [length] columns.
-			map = new int*[height];
-			for (int i = 0; i < height; i++) {
-				map[i] = new int[length];
-			}
-			//Initialize each element in the array to be 3 (in the texture it is used for the sky)
-			for (int i = 0; i < height; i++) {
-				for (int j = 0; j < length; j++) {
-					map[i][j] = 3;
-				}
-			}
-
-			//Set the bottom most row to be 8 (top level soil)
-			for (int j = 0; j < length; j++) {
-				map[height - 1][j] = 8;
-			}
-
-			for (int i = height - 2; i > height / 2 - 1; i--) { //Go from bottom to halfway up the map
-				for (int j = 0; j < length; j++) { //Go through each column
-					if ((j > 0 && map[i + 1][j - 1] == 3) || map[i + 1][j] == 3 || (j < length - 1 && i < height - 2 && map[i + 1][j + 1] == 3)) {
-						//If we not at the ends of the map and the piece to our bottom left  or bottom right is sky, then we are also sky
-						//OR if the piece below us is sky, then we are also sky.
-						//First two conditions described are to ensure that there are no steep hills that cannot be climbed
-						//Last condition described is to ensure that we do not have floating platforms
-						map[i][j] = 3;
-					}
-					else if ((rand() % 101) / 100.0f < p) { //If a random number is less than our probability then we build up
-						map[i][j] = 8; //set the current level to top level soil
-						map[i + 1][j] = 17; //set piece below us as normal soil
-					}
-					else { //Otherwise make the piece sky
-						map[i][j] = 3;
-					}
-				}
-			}
-
-			for (int i = height - 2; i > height / 2 - 1; i--) {
-				for (int j = 0; j < length; j++) {
-					if (map[i][j] == 8 && map[i][j - 1] == 3 && map[i][j + 1] == 3) {
-						//If our current piece is sky but both pieces to the either side of us is top level soil, make our land height one less (allows for platforms)
-						map[i][j] = 3;
-						map[i + 1][j] = 8;
-					}
-				}
-			}
-		}
-
-		/* ~Map()
-			\description - Destructor
-		*/
-		~Map() {
-
-			for (int i = 0; i < height; i++) {
-				delete map[i];
-			}
-			delete map;
-		}
-
+		Map(const SimState& state, ShaderProgram& program, const AtlasSprite& sprite) : state(&state), program(&program), sprite(sprite) {}
 
 		/* Draw()
 			\description - Draws the map onto the screen
 		*/
 		void Draw() {
-			vector<float> vertexData; //Holds vertex data
-			vector<float> textureCoordinates; //Holds texture coordinate data
+			PROFILE_ZONE("Map::Draw");
+			ScratchVector<float> vertexData; //Holds vertex data
+			ScratchVector<float> textureCoordinates; //Holds texture coordinate data
+			vertexData.reserve(state->length * state->height * 12);
+			textureCoordinates.reserve(state->length * state->height * 12);
 			float dim = 350.0f; //Dimensions of the texture
 			float tileSize = 70.0f; //Size of each sprite on the texture
 			float x, y;
 			float w = 1 / dim; //height of each sprite in texture coordinates
 			float h = 1 / dim; //width of each sprite in texture coordinates
-			for (int yCoordinate = 0; yCoordinate < height; yCoordinate++) {
-				for (int xCoordinate = 0; xCoordinate < length; xCoordinate++) { //Go through the entire board
-					switch (map[yCoordinate][xCoordinate]) {
+			for (int yCoordinate = 0; yCoordinate < state->height; yCoordinate++) {
+				for (int xCoordinate = 0; xCoordinate < state->length; xCoordinate++) { //Go through the entire board
+					switch (SimulationTile(*state, xCoordinate, yCoordinate)) {
 					case 0: //if the piece is zero (shouldn't happen)
 						x = -1;
 						y = -1;
@@ -790,13 +728,17 @@ private:
 						break;
 					}
 					if (x == -1 || y == -1) { continue; }
+					float left = sprite.U(x / dim); //corners of the tile in the atlas
+					float right = sprite.U((x + tileSize) / dim);
+					float top = sprite.V(y / dim);
+					float bottom = sprite.V((y + tileSize) / dim);
 					textureCoordinates.insert(textureCoordinates.end(), { //add texture coordinates to vector
-						x / dim, y / dim,
-						x / dim, (y + tileSize) / dim,
-						(x + tileSize) / dim, y / dim,
-						(x + tileSize) / dim, (y + tileSize) / dim,
-						x / dim, (y + tileSize) / dim,
-						(x + tileSize) / dim, y / dim });
+						left, top,
+						left, bottom,
+						right, top,
+						right, bottom,
+						left, bottom,
+						right, top });
 					vertexData.insert(vertexData.end(), { //add vertex coordinates to vector
 						(float)xCoordinate, (float)-1 * yCoordinate,
 						(float)xCoordinate, (float)-1 * yCoordinate - 1,
@@ -810,87 +752,33 @@ private:
 			//bind texture to OpenGL and draw the map
 			modelMatrix.Identity();
 			program->SetModelMatrix(modelMatrix);
-			glUseProgram(program->programID);
-			glBindTexture(GL_TEXTURE_2D, texture);
-			glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertexData.data());
-			glEnableVertexAttribArray(program->positionAttribute);
-			glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, textureCoordinates.data());
-			glEnableVertexAttribArray(program->texCoordAttribute);
-
-			glDrawArrays(GL_TRIANGLES, 0, vertexData.size() / 2);
-		}
-
-		/* checkIfCollision()
-			\description - Checks if the inputted coordinates collided with dirt
-			\param x     - World X coordinate
-			\param y     - World Y coordinate
-		*/
-		bool checkIfCollision(float x, float y) {
-			int gridX = (int)(x); //convert x to the grid version of x
-			int gridY = ceil(-y - 1); //convert y to grid version of y
-			if (gridX < 0 || gridX >= length || gridY < 0 || gridY >= height) { // if the grid values are out of bounds return false
-				return false;
-			}
-			if ((map[gridY][gridX] != 3)) { //if the coordinate on the map is not sky (3) then return  true (collision)
-				return true;
-			}
-			return false; //else false (no collision)
-		}
-
-		/* yAdjustment
-			\description - returns how much in the y axis the entity should be moved
-			\param x     - World X coordinate
-			\param y     - World Y coordinate
-		*/
-		float yAdjustment(float x, float y) {
-			if (!checkIfCollision(x, y)) {
-				return 0;
-			}
-			return ceil(y) - y;
+			CountedUseProgram(program->programID);
+			CountedBindTexture(GL_TEXTURE_2D, sprite.texture);
+			CountedVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertexData.data());
+			CountedEnableVertexAttribArray(program->positionAttribute);
+			CountedVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, textureCoordinates.data());
+			CountedEnableVertexAttribArray(program->texCoordAttribute);
+
+			CountedDrawArrays(GL_TRIANGLES, 0, vertexData.size() / 2);
 		}
 	private:
 		Matrix viewMatrix;
 		Matrix modelMatrix;
+		const SimState* state;
 		ShaderProgram* program;
-		GLuint texture;
-		int height;
-		int length;
-		int** map;
+		AtlasSprite sprite;
 	};
-	class Gun;
-	class Bullet;
-	//Character Class - Contains character attributes and methods
+
+	//Character Class - Draws a player
 	class Character {
-		friend class GameState;
 	public:
 		/* Character()
-			\description     - Constructor
-			\param sentiment - Used to determine if character is playerOne or playerTwo (can be used for team numbers if expanded upon)
-			\param pos       - initial position of the character
-			\param texture   - texture to be used to draw the character
-			\param program   - Shader Program used to draw the character
-			\param hp        - Total amount of hp that the character has
+			\description   - Constructor
+			\param state   - Simulation state of the player that is drawn
+			\param sprite  - character sheet in the atlas to be used to draw the character
+			\param program - Shader Program used to draw the character
 		*/
-		Character(int sentiment, float* pos, GLuint texture, ShaderProgram& program, float hp=500) : sentiment(sentiment), texture(texture), program(&program) {
-			//more initialization			
-			health = hp;
-			gun = nullptr;
-
-			for (int i = 0; i < 3; i++) {
-				collisionFlags[i] = false;
-			}
-			for (int i = 0; i < 3; i++) {
-				position[i] = pos[i];
-			}
-			if (sentiment == 1) { //if it is playerOne, face right
-				animation[0] = 3;
-				animation[1] = 0;
-			}
-			else { //otherwise face left
-				animation[0] = 1;
-				animation[1] = 0;
-			}
-
+		Character(const SimCharacter& state, const AtlasSprite& sprite, ShaderProgram& program) : state(&state), sprite(sprite), program(&program) {
 			vertices[0] = 0;
 			vertices[1] = 1;
 			vertices[2] = 0;
@@ -904,189 +792,65 @@ private:
 			vertices[10] = 1;
 			vertices[11] = 0;
 		}
-		
-		/* move()
-			\description   - moves character based upon velocity and adjusts velocities if colliding or falling
-			\param elapsed - seconds that have passed
-		*/
-		void move(float elapsed) {
-			if ((collisionFlags[0] == false) || (collisionFlags[0] && velocity[1] > 0)) { //if we are in the air or are on the ground and jumping
-				position[1] += velocity[1] * elapsed; //change our vertical position
-			}
-			if ((!collisionFlags[1] && velocity[0] < 0) || (!collisionFlags[2] && velocity[0] > 0)) { //if we are not collided (xDirection) in the direction of our movement
-				//If we are at risk of going out of bounds fix our position so that we are stuck on the edge
-				if (position[0] < 0 && velocity[0] < 0) {
-					position[0] = 0;
-				}
-				else if (position[0] > BOARD_LENGTH - 1 && velocity[0] > 0) {
-					position[0] = BOARD_LENGTH - 1;
-				}
-				//If we are in the clear to move, then we move and adjust our distance traveled
-				else {
-					position[0] += velocity[0] * elapsed;
-					distanceTraveled += velocity[0] * elapsed;
-				}
-			}
-			if (!collisionFlags[0]) { //if we are falling, increase our falling speed (acceleration)
-				velocity[1] -= 3.5f * elapsed;
-			}
-		}
+
 		/* draw()
-			\description - Draw character on screen and adjust animation
+			\description - Draw character on screen
 		*/
 		void draw() {
-			glBindTexture(GL_TEXTURE_2D, texture); //bind texture to openGL
-			glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices);
-			glEnableVertexAttribArray(program->positionAttribute);
-			vector<float> textureCoordinates; //textureCoordinates
+			PROFILE_ZONE("Character::draw");
+			CountedBindTexture(GL_TEXTURE_2D, sprite.texture); //bind texture to openGL
+			CountedVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices);
+			CountedEnableVertexAttribArray(program->positionAttribute);
 			float dim = 192.0f; //dimensions of texture
 			float tileSize = 48; //size of each texture
-			float x = tileSize * animation[0]; //x coordinate of texture (animation[0] is if left facing or right facing)
+			float x = tileSize * state->animation[0]; //x coordinate of texture (animation[0] is if left facing or right facing)
 			float y;
-			if (velocity[0] == 0) { //if we are standing still then we go to a specific animation
+			if (state->velocity[0] == 0) { //if we are standing still then we go to a specific animation
 				y = tileSize * 2;
 			}
-			else if (fabs(distanceTraveled) >= 0.5f) { //if our distance traveled is >= 0.5f
-				animation[1] = (animation[1] == 1 ? 3 : 1); //switch switch running animation we're using to draw
-				distanceTraveled = 0.0f; //reset the distance we traveled
-				y = animation[1] * tileSize; //set our y value
-			}
 			else {
-				y = animation[1] * tileSize; //otherwise set our y value to the animation
+				y = state->animation[1] * tileSize; //otherwise use the running animation (the simulation switches it as we run)
 			}
-			textureCoordinates.insert(textureCoordinates.end(), { //insert texture coordinates
-				x / dim, y / dim,
-				x / dim, (y + tileSize) / dim,
-				(x + tileSize) / dim, (y) / dim,
-				(x + tileSize) / dim, (y) / dim,
-				x / dim, (y + tileSize) / dim,
-				(x + tileSize) / dim, (y + tileSize) / dim
-				});
+			float left = sprite.U(x / dim); //corners of the animation frame in the atlas
+			float right = sprite.U((x + tileSize) / dim);
+			float top = sprite.V(y / dim);
+			float bottom = sprite.V((y + tileSize) / dim);
+			float textureCoordinates[] = { //texture coordinates, one quad so it fits on the stack
+				left, top,
+				left, bottom,
+				right, top,
+				right, top,
+				left, bottom,
+				right, bottom
+				};
 
 			//draw triangles
-			glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, textureCoordinates.data());
-			glEnableVertexAttribArray(program->texCoordAttribute);
+			CountedVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, textureCoordinates);
+			CountedEnableVertexAttribArray(program->texCoordAttribute);
 			modelMatrix.Identity();
-			modelMatrix.Translate(position[0], position[1], position[2]);
+			modelMatrix.Translate(state->position[0], state->position[1], state->position[2]);
 			program->SetModelMatrix(modelMatrix);
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-		}
-		/* shiftPosition
-			\description      - adjust the position of the character
-			\param horizontal - horizontal displacement
-			\param vertical   - vertical displacement
-		*/
-		void shiftPosition(float horizontal, float vertical) {
-			position[0] += horizontal;
-			position[1] += vertical;
-		}
-		/* attach()
-			\description  - assign gun pointer to the newGun
-			\param newGun - gun to be attached to character
-		*/
-		void attach(Gun& newGun) {
-			gun = &newGun;
-		}
-
-		/* setVelocity()
-			\description - Assigns velocity to specified direction
-			\param x     - new x velocity (-100.0f if unchanged)
-			\param y     - new y velocity (-100.0f if unchanged)
-			\param z     - new z velocity (-100.0f if unchanged)		
-		*/
-		void setVelocity(float x = -100.0f, float y = -100.0f, float z = -100.0f) { //velocity is never -100 sooo we can use that as a default constructor
-			if (x != -100.0f) {
-				bool xPositive = (x > 0);
-				bool vPositive = (velocity[0] > 0);
-				if (xPositive != vPositive) { //reset distance traveled for animation when we swap directions
-					distanceTraveled = 0;
-				}
-				if (x != velocity[0]) {
-					animation[1] = 1;
-				}
-			}
-			velocity[0] = (x == -100.0f ? velocity[0] : x);
-			velocity[1] = (y == -100.0f ? velocity[1] : y);
-			velocity[2] = (z == -100.0f ? velocity[2] : z);
-			if (velocity[0] > 0) {
-				animation[0] = 3;
-			}
-			else if (velocity[0] < 0) {
-				animation[0] = 1;
-			}
-		}
-
-		/* gotHit()
-			\description  - Takes away hp from character when hit
-			\param damage - Amount of hp that should be removed
-		*/
-		void gotHit(float damage) {
-			health -= damage;
-			if (health <= 0.0f) {
-				health = 0.0f;
-			}
-		}
-
-		/* isDead()
-			\description - Returns if the character has zero hp
-		*/
-		bool isDead() {
-			return (health == 0);
-		}
-
-		/* setFlag
-			\description - Sets specific collision flags to true or false
-			\param down  - 0 if not collided, 1 if collided (-1 if unchanged) with ground
-			\param left  - 0 if not collided, 1 if collided (-1 if unchanged) to the left
-			\param right - 0 if not collided, 1 if collided (-1 if unchanged) to the right
-		*/
-		void setFlag(int down = -1, int left = -1, int right = -1) {
-			if (down != -1) {
-				collisionFlags[0] = (down == 1);
-			}
-			if (left != -1) {
-				collisionFlags[1] = (left == 1);
-			}
-			if (right != -1) {
-				collisionFlags[2] = (right == 1);
-			}
+			CountedDrawArrays(GL_TRIANGLES, 0, 6);
 		}
 	private:
-		bool collisionFlags[3]; //down, left, right
-		float health;
-		GLuint texture;
-		Gun* gun;
+		const SimCharacter* state;
+		AtlasSprite sprite;
 		ShaderProgram* program;
-		int sentiment;
 		Matrix modelMatrix;
-		float position[3];
-		float velocity[3];
 		float vertices[12];
-		float distanceTraveled;
-		float animation[2];
 	};
 
-	//Gun Class - Contains gun attributes and methods and shoots bullets
+	//Gun Class - Draws the gun that a player is holding
 	class Gun {
-		friend class Character;
 	public:
 		/* Gun()
-			\description  - Constructor
-			\param player - character whose gun this object belongs to
-			\param texture - texture for all of the guns
+			\description   - Constructor
+			\param state   - Simulation state of the gun that is drawn
+			\param master  - Simulation state of the player holding the gun
+			\param sprite  - sheet in the atlas with all of the guns
 			\param program - Shader Program used to draw the gun
-			\param bulletTexture - texture used to draw the bullet
-			\param soundMap      - maps string to firing sound
 		*/
-		Gun(Character& player, GLuint texture, ShaderProgram& program, GLuint bulletTexture, map<string, Mix_Chunk*>& soundMap) : texture(texture), program(&program), bulletTexture(bulletTexture) {
-			//More Initializations			
-			master = &player;
-			sentiment = master->sentiment;
-
-			for (pair<string, Mix_Chunk*> gts : soundMap) {
-				GunToSounds.insert(pair<string, Mix_Chunk*>(gts.first, gts.second)); //Copy the sounds into a local copy
-			}
-
+		Gun(const SimGun& state, const SimCharacter& master, const AtlasSprite& sprite, ShaderProgram& program) : state(&state), master(&master), sprite(sprite), program(&program) {
 			//initialize the vertex data
 			vertices[0] = 0;
 			vertices[1] = 1;
@@ -1100,208 +864,56 @@ private:
 			vertices[9] = 0;
 			vertices[10] = 1;
 			vertices[11] = 0;
-
-			//set gun 0 to be the first gun that is brought up in the game
-			gunNumber = 0;
-
-			position[0] = master->position[0];
-			position[1] = master->position[1];
-			position[2] = master->position[2];
-
-			//map each gun number and if its reversed to a texture x,y coordinate 
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(0, false),  pair<int, int>(0, 0)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(0, true),   pair<int, int>(7, 0)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(1, false),  pair<int, int>(1, 0)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(1, true),   pair<int, int>(6, 0)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(2, false),  pair<int, int>(2, 0)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(2, true),   pair<int, int>(5, 0)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(3, false),  pair<int, int>(3, 0)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(3, true),   pair<int, int>(4, 0)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(4, false),  pair<int, int>(0, 1)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(4, true),   pair<int, int>(7, 1)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(5, false),  pair<int, int>(1, 1)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(5, true),   pair<int, int>(6, 1)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(6, false),  pair<int, int>(2, 1)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(6, true),   pair<int, int>(5, 1)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(7, false),  pair<int, int>(3, 1)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(7, true),   pair<int, int>(4, 1)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(8, false),  pair<int, int>(0, 2)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(8, true),   pair<int, int>(7, 2)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(9, false),  pair<int, int>(1, 2)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(9, true),   pair<int, int>(6, 2)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(10, false), pair<int, int>(2, 2)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(10, true),  pair<int, int>(5, 2)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(11, false), pair<int, int>(3, 2)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(11, true),  pair<int, int>(4, 2)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(12, false), pair<int, int>(0, 3)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(12, true),  pair<int, int>(7, 3)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(13, false), pair<int, int>(1, 3)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(13, true),  pair<int, int>(6, 3)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(14, false), pair<int, int>(2, 3)));
-			GunToTexture.insert(pair<pair<int, bool>, pair<int, int>>(pair<int, bool>(14, true),  pair<int, int>(5, 3)));
-
-			//map each gun number to a rate of fire, damage, magazine size, max range and bullet speed
-			GunToStats.insert(pair<int, tuple<float, float, int, float, float>>(0,  tuple<float, float, int, float, float>(1.5f, 10.0f, 6, 5, 3)));
-			GunToStats.insert(pair<int, tuple<float, float, int, float, float>>(1,  tuple<float, float, int, float, float>(2.0f, 30.0f, 12, 4, 4)));
-			GunToStats.insert(pair<int, tuple<float, float, int, float, float>>(2,  tuple<float, float, int, float, float>(1.0f, 45.0f, 4, 2, 3)));
-			GunToStats.insert(pair<int, tuple<float, float, int, float, float>>(3,  tuple<float, float, int, float, float>(7.0f, 30.0f, 14, 4, 5)));
-			GunToStats.insert(pair<int, tuple<float, float, int, float, float>>(4,  tuple<float, float, int, float, float>(15.0f, 20.0f, 25, 15, 7)));
-			GunToStats.insert(pair<int, tuple<float, float, int, float, float>>(5,  tuple<float, float, int, float, float>(40.0f, 7.0f, 35, 9, 10)));
-			GunToStats.insert(pair<int, tuple<float, float, int, float, float>>(6,  tuple<float, float, int, float, float>(90.0f, 18.0f, 45, 20, 8)));
-			GunToStats.insert(pair<int, tuple<float, float, int, float, float>>(7,  tuple<float, float, int, float, float>(25.0f, 6.0f, 25, 7, 10)));
-			GunToStats.insert(pair<int, tuple<float, float, int, float, float>>(8,  tuple<float, float, int, float, float>(1.0f, 60.0f, 1, 30, 18)));
-			GunToStats.insert(pair<int, tuple<float, float, int, float, float>>(9,  tuple<float, float, int, float, float>(1.0f, 35.0f, 2, 5, 18)));
-			GunToStats.insert(pair<int, tuple<float, float, int, float, float>>(10, tuple<float, float, int, float, float>(30.0f, 7.0f, 30, 3, 16)));
-			GunToStats.insert(pair<int, tuple<float, float, int, float, float>>(11, tuple<float, float, int, float, float>(35.0f, 3.0f, 35, 2, 8)));
-			GunToStats.insert(pair<int, tuple<float, float, int, float, float>>(12, tuple<float, float, int, float, float>(50.0f, 1.0f, 50, 3, 9)));
-			GunToStats.insert(pair<int, tuple<float, float, int, float, float>>(13, tuple<float, float, int, float, float>(1.0f, 60.0f, 1, 25, 18)));
-			GunToStats.insert(pair<int, tuple<float, float, int, float, float>>(14, tuple<float, float, int, float, float>(3.0f, 35.0f, 12, 10, 8)));
-
 		}
 
 		/* draw()
 			\description - Draws the gun onto the screen		
 		*/
 		void draw() {
-			glBindTexture(GL_TEXTURE_2D, texture);
-			glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices);
-			glEnableVertexAttribArray(program->positionAttribute);
-			pair<int, int> textVal = GunToTexture[pair<int, bool>(gunNumber, master->animation[0] != 3)]; //gets texture coordinates
-			//size of the file in x & y
-			float xDim = 1280.0f; 
-			float yDim = 640.0f;
-			//size of each sprite
-			float tileSize = 160.0f;
-
-			float x = textVal.first * tileSize;
-			float y = textVal.second * tileSize;
-			vector<float> textureCoordinates; 
-			textureCoordinates.insert(textureCoordinates.end(), { //insert texture coordinates
-				x / xDim, y / yDim,
-				x / xDim, (y + tileSize) / yDim,
-				(x + tileSize) / xDim, (y) / yDim,
-				(x + tileSize) / xDim, (y) / yDim,
-				x / xDim, (y + tileSize) / yDim,
-				(x + tileSize) / xDim, (y + tileSize) / yDim
-				});
+			PROFILE_ZONE("Gun::draw");
+			CountedBindTexture(GL_TEXTURE_2D, sprite.texture);
+			CountedVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices);
+			CountedEnableVertexAttribArray(program->positionAttribute);
+			const GunRect& rect = weaponTable.rect[master->animation[0] != 3][state->gunNumber]; //gets texture coordinates
+			float left = sprite.U(rect.left); //corners of the gun in the atlas
+			float right = sprite.U(rect.right);
+			float top = sprite.V(rect.top);
+			float bottom = sprite.V(rect.bottom);
+			float textureCoordinates[] = { //texture coordinates, one quad so it fits on the stack
+				left, top,
+				left, bottom,
+				right, top,
+				right, top,
+				left, bottom,
+				right, bottom
+				};
 			//draw the object
-			glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, textureCoordinates.data());
-			glEnableVertexAttribArray(program->texCoordAttribute);
+			CountedVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, textureCoordinates);
+			CountedEnableVertexAttribArray(program->texCoordAttribute);
 			modelMatrix.Identity();
-			modelMatrix.Translate(position[0], position[1], position[2]);
+			modelMatrix.Translate(state->position[0], state->position[1], state->position[2]);
 			modelMatrix.Scale(0.5, 0.5, 1); //scale the object so that it doesn't look weird when the person is holding it
 			program->SetModelMatrix(modelMatrix);
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-		}
-
-		/* Reposition
-			\description - Adjusts the gun's position so that it matches the master's (player's)
-		*/
-		void Reposition() {
-			position[0] = master->position[0] + (master->animation[0] == 3 ? 0.45f : 0.0f);
-			position[1] = master->position[1];
-		}
-
-		/* ShiftGun()
-			\description - adjusts the gunNumber so that a new gun is used to shoot
-			\param num   - number that the gunNumber should change by
-		*/
-		void ShiftGun(int num) {
-			gunNumber += (num);
-			if (gunNumber < 0) {
-				gunNumber += GunToStats.size();
-			}
-			else if (gunNumber >= GunToStats.size()) {
-				gunNumber = gunNumber % GunToStats.size();
-			}
-			magazineLeft = get<2>(GunToStats[gunNumber]); //adjust size of magazine
-			lastShotTime = 0.00f; //reset the gun's bullet fire
-		}
-
-		/* Shoot()
-			\description - attempts to fire a bullet and returns a pointer to a bullet if it was fired or nullpointer if the gun could not fire
-		*/
-		Bullet* Shoot() {
-			//Set the type of gun
-			string gunType = "";
-			if (gunNumber == 1 || gunNumber == 3 || gunNumber == 9) {
-				gunType = "shotgun";
-			}
-			else if (gunNumber == 8 || gunNumber == 13) {
-				gunType = "sniper";
-			}
-			else {
-				gunType = "rifle";
-			}
-			float time = SDL_GetTicks()/1000.0f; //get the current time
-			if (reloading && time - reloadingStartTime < 1.5f) { //If the gun is still reloading
-				if (gunType == "shotgun") { //if its a shotgun play the shotgun reloading sound
-					Mix_PlayChannel(-1, GunToSounds["shotgun_r"], 0);
-				}
-				return nullptr; //return nullpointer since we cant fire a bullet
-			}
-			tuple<float, float, int, float, float> gunStats = GunToStats[gunNumber]; //get the stats for the gun
-			if (reloading) { //if we were reloading, we are not anymore so we reset the magazine and set our reloading flag to false
-				reloading = false;
-				magazineLeft = get<2>(gunStats);
-			}
-			if (time - lastShotTime > 1.0f / get<0>(gunStats)) { //if the time betwen our last shot and now is more than the inverse of our fire rate (we can fire another bullet)
-				lastShotTime = time; //set the current time to when we fired a bullet
-				magazineLeft--; //take away a bullet
-				if (magazineLeft == 0) { // if the magazine is now empty start to reload
-					reloading = true;
-					reloadingStartTime = time;
-				}
-				if (get<0>(gunStats) > 10.0f) { //if our fire rate is large
-					Mix_HaltChannel(sentiment); //stop sounds on our designated channel (our sentiment)
-				}
-				Mix_PlayChannel(sentiment, GunToSounds[gunType], 0); //play the corresponding gun sound
-				return new Bullet(sentiment, get<1>(gunStats), position, (master->animation[0] == 3 ? 1.0f : -1.0f)*get<4>(gunStats), bulletTexture, *program, get<3>(gunStats)); //return a bullet
-			}
-			return nullptr;
+			CountedDrawArrays(GL_TRIANGLES, 0, 6);
 		}
 	private:
-		bool reloading; //flag for if gun is reloading
-		float reloadingStartTime; //time that gun started to reload
-		float lastShotTime; //time that the last shot was fired
-		float magazineLeft; //Amount of bullets left in magazine
-		float position[3]; //position of the gun
+		const SimGun* state; //gun that is drawn
+		const SimCharacter* master; //owner of the gun
 		float vertices[12]; //vertex coordinates
-		GLuint texture; //texture of guns
-		GLuint bulletTexture; //bullet textures
+		AtlasSprite sprite; //sheet of guns
 		ShaderProgram* program; //shaderProgram
-		int sentiment; // sentiment of the gun
-		Character* master; //owner of the gun
-		Matrix modelMatrix; 
-		int gunNumber; //current number of the gun
-		bool rightFacing; //if the gun is facing right or left
-		map<pair<int, bool>, pair<int, int>> GunToTexture; //gun number and if reversed
-		map<int, tuple<float, float, int, float, float>> GunToStats; //gun number to bullets/second & damage & magazineSize & distance & bulletSpeed
-		map<string, Mix_Chunk*> GunToSounds;
-
+		Matrix modelMatrix;
 	};
 
-	//Bullet Class - Contains bullet attributes and methods
+	//Bullet Class - Draws the bullets that are in the simulation
 	class Bullet {
-		friend class GameState;
 	public:
 		/* Bullet()
-			\description       - Constructor
-			\param sentiment   - sentiment of the bullet (no friendly fire)
-			\param damage      - amount of damage that the bullet does if it hits a target
-			\param vel         - horizontal velocity of the bullet
-			\param texture     - texture of the bullet
-			\param program     - ShaderProgram used to draw the bullet
-			\param maxDistance - maximum distance that a bullet can travel before it dies off
+			\description   - Constructor
+			\param sprite  - bullet in the atlas
+			\param program - ShaderProgram used to draw the bullet
 		*/
-		Bullet(int sentiment, float damage, float* pos, float vel, GLuint texture, ShaderProgram& program, float maxDistance) : texture(texture), program(&program), sentiment(sentiment), damage(damage), maxDistance(maxDistance) {
-			for (int i = 0; i < 3; i++) {
-				position[i] = pos[i];
-			}
-			position[0] += 0.1;
-			position[1] += 0.2;
-			distanceTraveled = 0;
-
+		Bullet(const AtlasSprite& sprite, ShaderProgram& program) : sprite(sprite), program(&program) {
 			vertices[0] = 0;
 			vertices[1] = 1;
 			vertices[2] = 0;
@@ -1314,58 +926,39 @@ private:
 			vertices[9] = 0;
 			vertices[10] = 1;
 			vertices[11] = 0;
-
-			velocity = vel;
-		}
-
-		/* move()
-			\description   - Moves the bullet a distance based upon its velocity and time elapsed. Updates the distance traveled
-			\param elapsed - Time that has elapsed since the last time the bullet moved
-		*/
-		void move(float elapsed) {
-			position[0] += velocity * elapsed;
-			distanceTraveled += velocity * elapsed;
-		}
-		
-		/* deadBullet()
-			\description - Returns whether the bullet has traveled the full distance that it was meant to
-			\note - the distance traveled can be manually adjusted if there is a collision by the bullet with an object
-		*/
-		bool deadBullet() {
-			return (fabs(distanceTraveled) >= maxDistance);
 		}
 
 		/* draw()
-			\description draws bullet onto the screen
+			\description  - draws bullet onto the screen
+			\param bullet - simulation state of the bullet
+			\param time   - simulation time in seconds, drives the pulsing so captured frames are repeatable
 		*/
-		void draw() {
+		void draw(const SimBullet& bullet, float time) {
+			PROFILE_ZONE("Bullet::draw");
 			//bind texture to OpenGL
-			glBindTexture(GL_TEXTURE_2D, texture);
-			glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices);
-			glEnableVertexAttribArray(program->positionAttribute);
-			float textureCoordinates[] = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f }; //texture coordinates
-			glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, textureCoordinates);
-			glEnableVertexAttribArray(program->texCoordAttribute);
+			CountedBindTexture(GL_TEXTURE_2D, sprite.texture);
+			CountedVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices);
+			CountedEnableVertexAttribArray(program->positionAttribute);
+			float left = sprite.U(0.0f); //the whole bullet image, wherever it is in the atlas
+			float right = sprite.U(1.0f);
+			float top = sprite.V(0.0f);
+			float bottom = sprite.V(1.0f);
+			float textureCoordinates[] = { left, top, left, bottom, right, top, right, top, left, bottom, right, bottom }; //texture coordinates
+			CountedVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, textureCoordinates);
+			CountedEnableVertexAttribArray(program->texCoordAttribute);
 			modelMatrix.Identity();
-			modelMatrix.Translate(position[0], position[1], position[2]); 
-			float ticks = SDL_GetTicks() / 50.0f;
+			modelMatrix.Translate(bullet.position[0], bullet.position[1], bullet.position[2]); 
+			float ticks = time * 20.0f;
 			float scale = .2*fabs(sinf(ticks)) + 0.2; //scale the image based upon the time that has elapsed to form the "pulsing" effect of a heart
 			modelMatrix.Scale(scale, scale, 1);
 			program->SetModelMatrix(modelMatrix);
-			glDrawArrays(GL_TRIANGLES, 0, 6);
+			CountedDrawArrays(GL_TRIANGLES, 0, 6);
 		}
 	private:
 		Matrix modelMatrix;
-		GLuint texture;
+		AtlasSprite sprite;
 		ShaderProgram* program;
-
-		int sentiment;
-		float position[3];
 		float vertices[12];
-		float distanceTraveled;
-		float maxDistance;
-		float velocity;
-		float damage;
 	};
 	
 	/*
@@ -1374,19 +967,33 @@ private:
 	 *
 	 */
 
-	ShaderProgram program; //ShaderProgram used to draw the Game
-
-	bool letGo[2]; //Checks to see if Player1 or Player2 (index 0 and 1 respectively) have let go of the key to shift guns
+	//Shader programs, sprites and sounds, looked up by the handles interned in the constructor
+	ResourceRegistry<ShaderProgram> programs;
+	ResourceRegistry<AtlasSprite> sprites;
+	ResourceRegistry<Mix_Chunk*> sounds;
+	ResourceHandle texturedProgram; //ShaderProgram used to draw the Game
+	ResourceHandle fontSprite;
+	ResourceHandle sheetSprites[SPRITE_SHEETS];
+	ResourceHandle gunSoundHandles[GUN_SOUNDS]; //indexed by GunSound
 
 	//Matrices used for drawing and displaying the game on the screen
 	Matrix projectionMatrix;
 	Matrix modelMatrix;
 	Matrix viewMatrix;
 
-	//Maps between a descriptor string and a value (described in variable name)
-	map<string, GLuint> textureMap;
-	map<string, Mix_Chunk*> overallSoundMap;
-	map<string, Mix_Chunk*> gunSoundMap;
+	//Assets still loading, a handle is set to -1 once PumpAssets has taken what it loaded
+	AssetLoader loader;
+	AssetHandle fontImage;
+	AssetHandle sheetImages[SPRITE_SHEETS];
+	AssetHandle gunSounds[GUN_SOUNDS];
+	AssetHandle menuMusicAsset;
+	AssetHandle gameMusicAsset;
+	static const char* const sheetNames[SPRITE_SHEETS]; //names in the atlas
+	static const char* const sheetFiles[SPRITE_SHEETS];
+	static const char* const gunSoundNames[GUN_SOUNDS]; //in GunSound order
+	static const char* const gunSoundFiles[GUN_SOUNDS];
+
+	TextureAtlas atlas; //every sprite is packed into it, sprites holds where each one ended up
 
 	//Music for the MENU_MODE and GAME_MODE
 	Mix_Music* menuMusic;
@@ -1403,6 +1010,9 @@ private:
 	int currentState; //Keeps track of the current state in the game to update/draw accordingly
 	int nextState; //Stores the next state that the game will be in upon the next Update-Draw cycle.
 	bool newGame; //Variable to check if game has just started to make sure we initialize variables
+	unsigned int matchSeed; //Seed for the next board, 0 seeds from the clock
+	float fixedFrameTime; //Seconds added every Update call instead of reading SDL_GetTicks, 0 when playing normally
+	bool scriptedPlayers; //Players are driven by ScriptedButtons instead of the keyboard
 
     /*
 	 *
@@ -1410,157 +1020,544 @@ private:
 	 *
 	 */
 
-	Map* board; //Contains the board that will be used for the game
-	Character* playerOne; //Contains Player1's actions and attributes
-	Character* playerTwo; //Contains Player2's actions and attributes
-	Gun* gunOne; //Gun attached to Player1
-	Gun* gunTwo; //Gun attached to Player2
-	vector<Bullet*> bullets; //Container for all bullets that are fired (and not destroyed) by either player
+	SimState simulation; //Board, players, guns and bullets of the current match
+	MatchArena matchArena; //Holds board, playerOne, playerTwo, gunOne, gunTwo and bulletDrawer
+	int matchStartAllocations; //Heap allocations made by the last match start
+	float accumulator; //Elapsed time that has not been simulated yet (less than one TIME_STEP_SIZE)
+	int substeps; //Simulation ticks run during the last Update
+	Map* board; //Draws the board
+	Character* playerOne; //Draws Player1
+	Character* playerTwo; //Draws Player2
+	Gun* gunOne; //Draws the gun attached to Player1
+	Gun* gunTwo; //Draws the gun attached to Player2
+	Bullet* bulletDrawer; //Draws every bullet that is fired (and not destroyed) by either player
+
+	/* ReadInput()
+		\description    - Converts the keyboard state into the buttons each player is holding
+		\param keyboard - keyboard state from SDL_GetKeyboardState
+	*/
+	SimInput ReadInput(const Uint8* keyboard) {
+		SimInput input;
+		input.buttons[0] = 0;
+		input.buttons[1] = 0;
+
+		//PlayerOne: A & D to move, W to jump, S to shoot, Q & E to shift guns
+		if (keyboard[SDL_SCANCODE_A]) { input.buttons[0] |= INPUT_LEFT; }
+		if (keyboard[SDL_SCANCODE_D]) { input.buttons[0] |= INPUT_RIGHT; }
+		if (keyboard[SDL_SCANCODE_W]) { input.buttons[0] |= INPUT_JUMP; }
+		if (keyboard[SDL_SCANCODE_S]) { input.buttons[0] |= INPUT_SHOOT; }
+		if (keyboard[SDL_SCANCODE_Q]) { input.buttons[0] |= INPUT_PREV_GUN; }
+		if (keyboard[SDL_SCANCODE_E]) { input.buttons[0] |= INPUT_NEXT_GUN; }
+
+		//PlayerTwo: arrows to move and jump, down arrow or right shift to shoot, PAGE_UP/PAGE_DOWN or / and . to shift guns
+		if (keyboard[SDL_SCANCODE_LEFT]) { input.buttons[1] |= INPUT_LEFT; }
+		if (keyboard[SDL_SCANCODE_RIGHT]) { input.buttons[1] |= INPUT_RIGHT; }
+		if (keyboard[SDL_SCANCODE_UP]) { input.buttons[1] |= INPUT_JUMP; }
+		if (keyboard[SDL_SCANCODE_DOWN] || keyboard[SDL_SCANCODE_RSHIFT]) { input.buttons[1] |= INPUT_SHOOT; }
+		if (keyboard[SDL_SCANCODE_PAGEDOWN] || keyboard[SDL_SCANCODE_PERIOD]) { input.buttons[1] |= INPUT_PREV_GUN; }
+		if (keyboard[SDL_SCANCODE_PAGEUP] || keyboard[SDL_SCANCODE_SLASH]) { input.buttons[1] |= INPUT_NEXT_GUN; }
+		return input;
+	}
 
-	/* Collision()
-		\description - Detects collisions between game entities and adjusts their attributes accordingly
+	/* PlayEvents()
+		\description  - Plays the gun sounds for the things that happened during a simulation tick
+		\param events - events from SimulationTick
 	*/
-	void Collision() {
-		//Note positions for entities are the bottom left corner so we must adjust these values to determine if the entity itself is colliding
-		
-		//Terrain-playerOne Collision
+	void PlayEvents(const SimEvents& events) {
+		for (int player = 0; player < 2; player++) {
+			int channel = simulation.players[player].sentiment; //each player fires on their own channel
+			if (events.reloadSound[player]) {
+				Mix_PlayChannel(-1, sounds[gunSoundHandles[GUN_SOUND_SHOTGUN_RELOAD]], 0);
+			}
+			if (events.shotSound[player] != GUN_SOUND_NONE) {
+				if (events.haltChannel[player]) { //stop the last shot's sound for guns with a large fire rate
+					Mix_HaltChannel(channel);
+				}
+				Mix_PlayChannel(channel, sounds[gunSoundHandles[events.shotSound[player]]], 0);
+			}
+		}
+	}
 
-		//check if playerOne collided with the ground. if so...
-		if (board->checkIfCollision(playerOne->position[0] + 0.5, playerOne->position[1])) { // + 0.5 to get center of character
-			playerOne->shiftPosition(0, board->yAdjustment(playerOne->position[0], playerOne->position[1])); //adjust
-			playerOne->setFlag(1, -1, -1); //set collision flag as true
-			playerOne->setVelocity(-100.0f, 0, -100.0f); //set velocity as 0
+	/* PumpAssets()
+		\description - Takes whatever the loader has finished. The font gets an atlas page of its own as soon as it is decoded so the menu
+		               can draw, the sprite sheets are packed together once all of them are. Sounds and music are stored as they come in.
+	*/
+	void PumpAssets() {
+		PROFILE_ZONE("PumpAssets");
+		if (fontImage >= 0 && loader.Ready(fontImage)) {
+			AddToAtlas("font", fontImage);
+			atlas.Build();
+			sprites.Set(fontSprite, atlas.Sprite("font"));
+			fontImage = -1;
+		}
+		bool sheetsReady = true;
+		for (int i = 0; i < SPRITE_SHEETS; i++) {
+			sheetsReady = sheetsReady && sheetImages[i] >= 0 && loader.Ready(sheetImages[i]);
 		}
-		else { //otherwise
-			playerOne->setFlag(0, -1, -1); //set collision flag as false
+		if (sheetsReady) {
+			for (int i = 0; i < SPRITE_SHEETS; i++) {
+				AddToAtlas(sheetNames[i], sheetImages[i]);
+				sheetImages[i] = -1;
+			}
+			atlas.Build();
+			for (int i = 0; i < SPRITE_SHEETS; i++) {
+				sprites.Set(sheetSprites[i], atlas.Sprite(sheetNames[i]));
+			}
 		}
-		//check if playerOne collided with the right side. if so...
-		if (board->checkIfCollision(playerOne->position[0] + .85f, playerOne->position[1] + 0.5f)) {  // +0.85 to get to right side of the character +0.5 to get to center of height
-			playerOne->shiftPosition(-0.01f, 0); //adjust position
-			playerOne->setFlag(-1, -1, 1); //set flag
-			playerOne->setVelocity(0, -100.0f, -100.0f); //set velocity to 0
+		for (int i = 0; i < GUN_SOUNDS; i++) {
+			if (gunSounds[i] >= 0 && loader.Ready(gunSounds[i])) {
+				sounds.Set(gunSoundHandles[i], loader.TakeSound(gunSounds[i]));
+				gunSounds[i] = -1;
+			}
 		}
-		else { //otherwise
-			playerOne->setFlag(-1, -1, 0); //set collision flag as false
+		if (menuMusicAsset >= 0 && loader.Ready(menuMusicAsset)) {
+			menuMusic = loader.TakeMusic(menuMusicAsset);
+			menuMusicAsset = -1;
 		}
-		//check if playerOne collided to the left. if so...
-		if (board->checkIfCollision(playerOne->position[0], playerOne->position[1] + 0.5f)) { //+0.5 to get to center of character's height
-			playerOne->shiftPosition(0.01f, 0); //adjust position
-			playerOne->setFlag(-1, 1, -1); //set flag
-			playerOne->setVelocity(0, -100.0f, -100.0f); //set velocity
+		if (gameMusicAsset >= 0 && loader.Ready(gameMusicAsset)) {
+			gameMusic = loader.TakeMusic(gameMusicAsset);
+			gameMusicAsset = -1;
 		}
-		else { //otherwise
-			playerOne->setFlag(-1, 0, -1); // set flag to 
+	}
+
+	/* AddToAtlas()
+		\description - Moves a decoded image from the loader into the atlas, to be uploaded by the next atlas.Build
+		\param name  - name the sprite is looked up by
+		\param image - finished image load
+	*/
+	void AddToAtlas(const char* name, AssetHandle image) {
+		DecodedImage decoded = loader.TakeImage(image);
+		if (decoded.pixels == NULL) {
+			std::cout << "Unable to load image. Make sure the path is correct\n";
+			assert(false);
+			return;
 		}
+		atlas.Add(name, decoded);
+	}
+};
 
-		//Terrain-playerTwo collision
+const char* const GameState::sheetNames[SPRITE_SHEETS] = { "terrain", "guns", "character1", "bullet", "character2" };
+const char* const GameState::sheetFiles[SPRITE_SHEETS] = { "terrain.png", "guns.png", "character1.png", "bullet.png", "character2.png" }; //gun sheet edited from TdeLeeuw (http://fav.me/d8etym8)
+const char* const GameState::gunSoundNames[GUN_SOUNDS] = { "sniper", "shotgun", "shotgun_r", "rifle" }; //shotgun_r is the shotgun reloading
+const char* const GameState::gunSoundFiles[GUN_SOUNDS] = { "sniper.wav", "shotgun.wav", "shotgun_r.wav", "rifle.wav" }; //from SoundBible.com (http://soundbible.com/tags-gun.html)
 
-		//Check if playerTwo collided with the ground. if so...
-		if (board->checkIfCollision(playerTwo->position[0] + 0.5, playerTwo->position[1])) { //+0.5 to get to center of character
-			playerTwo->shiftPosition(0, board->yAdjustment(playerTwo->position[0], playerTwo->position[1])); //adjust position
-			playerTwo->setFlag(1, -1, -1); //set flag
-			playerTwo->setVelocity(-100.0f, 0, -100.0f); //set velocity to 0
+/* SetupGL()
+	\description - GL state shared by the window and the frame benchmark
+*/
+void SetupGL() {
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+/* RunFrameBenchmark()
+	\description - Plays scripted matches into an offscreen framebuffer and prints the cost of every frame as JSON
+	\param argc  - argument count from main
+	\param argv  - arguments from main: --frame-bench [frames] [--seed n] [--width w] [--height h] [--capture dir] [--capture-every n] [--trace file]
+	                     [--frame-budget ms] [--hitch-history n] [--overlay] [--alloc-sample n] [--alloc-test] [--load-threads n]
+	                     [--no-texture-cache] [--compress-textures] [--lossy-textures]
+	               --load-threads 0 loads every asset on the main thread before the first frame
+	               --alloc-test fails (exit code 4) if any GAME_MODE frame past the first ALLOCATION_WARMUP_FRAMES of a match allocates
+*/
+int RunFrameBenchmark(int argc, char* argv[]) {
+	typedef chrono::high_resolution_clock Clock;
+	int frameCount = 1000;
+	unsigned int seed = 1;
+	int width = WINDOW_HEIGHT;
+	int height = WINDOW_WIDTH;
+	const char* captureDirectory = nullptr;
+	int captureEvery = 1;
+	const char* traceFile = nullptr;
+	float frameBudget = FRAME_BUDGET_MS;
+	int hitchHistory = HITCH_HISTORY;
+	bool overlay = false;
+	unsigned int allocationSampling = 0;
+	bool allocationTest = false;
+	int loadThreads = ASSET_LOADER_THREADS;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--frame-bench") == 0) {
+			if (i + 1 < argc && argv[i + 1][0] != '-') {
+				frameCount = atoi(argv[++i]);
+			}
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			seed = (unsigned int)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--width") == 0 && i + 1 < argc) {
+			width = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--height") == 0 && i + 1 < argc) {
+			height = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+			captureDirectory = argv[++i];
+		}
+		else if (strcmp(argv[i], "--capture-every") == 0 && i + 1 < argc) {
+			captureEvery = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+			traceFile = argv[++i];
 		}
-		else { //otherwise
-			playerTwo->setFlag(0, -1, -1); //set flag to false
+		else if (strcmp(argv[i], "--frame-budget") == 0 && i + 1 < argc) {
+			frameBudget = (float)atof(argv[++i]);
 		}
+		else if (strcmp(argv[i], "--hitch-history") == 0 && i + 1 < argc) {
+			hitchHistory = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--overlay") == 0) {
+			overlay = true;
+		}
+		else if (strcmp(argv[i], "--alloc-sample") == 0 && i + 1 < argc) {
+			allocationSampling = (unsigned int)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--alloc-test") == 0) {
+			allocationTest = true;
+		}
+		else if (strcmp(argv[i], "--load-threads") == 0 && i + 1 < argc) {
+			loadThreads = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--no-texture-cache") == 0) { //decode every image, for timing the loads without the cache
+			textureCache.SetEnabled(false);
+		}
+		else if (strcmp(argv[i], "--compress-textures") == 0) { //DXT5 for atlas pages no lossless format fits
+			SetTextureCompression(true);
+		}
+		else if (strcmp(argv[i], "--lossy-textures") == 0) { //smaller formats that are off by up to TEXTURE_LOSSY_TOLERANCE
+			SetLossyTextureFormats(true);
+		}
+		else {
+			fprintf(stderr, "unknown frame benchmark argument: %s\n", argv[i]);
+			return 1;
+		}
+	}
+	if (frameCount <= 0 || width <= 0 || height <= 0) {
+		fprintf(stderr, "frame count and size must be positive\n");
+		return 1;
+	}
+	if (captureDirectory != nullptr && !PrepareCaptureDirectory(captureDirectory)) {
+		return 1;
+	}
 
-		//Check if playerTwo collided to the right side. if so...
-		if (board->checkIfCollision(playerTwo->position[0] + .85f, playerTwo->position[1] + 0.5f)) { //+0.85 to get to right side of character. +0.5 to get to center of character's height
-			playerTwo->shiftPosition(-0.01f, 0); //adjust position
-			playerTwo->setFlag(-1, -1, 1); //set flag
-			playerTwo->setVelocity(0, -100.0f, -100.0f); //set velocity to 0
+	SDL_Init(SDL_INIT_TIMER); //no video, the GL context comes from the offscreen backend
+	RenderContext* context = RenderContext::CreateOffscreen(width, height);
+	if (context == nullptr) {
+		SDL_Quit();
+		return 1;
+	}
+	SetupGL();
+	ShaderProgram program;
+	program.Load(RESOURCE_FOLDER"vertex_textured.glsl", RESOURCE_FOLDER"fragment_textured.glsl");
+	Clock::time_point loadStart = Clock::now();
+	GameState game(loadThreads);
+	game.WaitForMenuAssets();
+	Clock::time_point menuReady = Clock::now();
+	game.WaitForGameAssets();
+	Clock::time_point assetsReady = Clock::now();
+	game.StartMatch(seed, 1.0f / 60.0f, true);
+	PerfOverlay perfOverlay(game.FontSprite());
+	if (overlay) {
+		perfOverlay.Toggle();
+	}
+	float lastFrameMs = 0;
+	FrameCapture* capture = nullptr;
+	if (captureDirectory != nullptr) {
+		capture = new FrameCapture(width, height, captureDirectory, captureEvery);
+	}
+
+	SDL_Event event;
+	memset(&event, 0, sizeof(event));
+	bool done = false;
+	double updateSeconds = 0;
+	double submitSeconds = 0;
+	double maxSubmitSeconds = 0;
+	double gpuMilliseconds = 0;
+	int gpuSamples = 0;
+	unsigned long long drawCalls = 0;
+	unsigned int maxDrawCalls = 0;
+	int matches = 1;
+	FrameStats frameStats(frameBudget, hitchHistory);
+	unsigned long long allocations = 0;
+	unsigned long long allocatedBytes = 0;
+	unsigned long long maxAllocations = 0;
+	unsigned int lastFrameAllocations = 0;
+	int gameFrames = 0; //GAME_MODE frames in a row
+	int steadyFrames = 0;
+	int allocatingFrames = 0;
+	unsigned long long steadyAllocations = 0;
+	SetAllocationSampling(allocationTest ? 0 : allocationSampling);
+	Clock::time_point start = Clock::now();
+	for (int frame = 0; frame < frameCount; frame++) {
+		//--alloc-test samples every allocation of the frames it checks, so the report shows each one
+		bool steady = (game.NextState() == GAME_MODE && gameFrames >= ALLOCATION_WARMUP_FRAMES);
+		if (allocationTest) {
+			SetAllocationSampling(steady ? 1 : 0);
+		}
+		AllocationStats frameStart = ThreadAllocationStats();
+		Clock::time_point t0 = Clock::now();
+		game.Update(event, done);
+		if (game.CurrentState() == MENU_MODE) { //the last match ended, start the next one straight away
+			game.StartMatch(seed + matches++, 1.0f / 60.0f, true);
 		}
-		else { //otherwise
-			playerTwo->setFlag(-1, -1, 0); //set flag as false
+		Clock::time_point t1 = Clock::now();
+		ResetRenderStats();
+		frameScratch.BeginFrame();
+		bool gpuSampled = context->BeginFrame();
+		glClear(GL_COLOR_BUFFER_BIT);
+		game.Draw();
+		CountedDisableVertexAttribArray(program.positionAttribute);
+		RenderStats gameStats = renderStats; //the JSON counts the game's own draws, not the overlay's
+		perfOverlay.Record(lastFrameMs, gameStats, game.LiveBullets(), game.Substeps(), lastFrameAllocations);
+		perfOverlay.Draw();
+		context->EndFrame();
+		if (capture != nullptr) { //inside the submit time, so a capture run shows what the readback costs
+			capture->Capture();
 		}
-		//Check if playerTwo collided on the left side. if so...
-		if (board->checkIfCollision(playerTwo->position[0], playerTwo->position[1] + 0.5f)) { //+0.5 to get to center of height of character.
-			playerTwo->shiftPosition(0.01f, 0); //adjust position
-			playerTwo->setFlag(-1, 1, -1); //set flag
-			playerTwo->setVelocity(0, -100.0f, -100.0f); //set velocity to 0
+		Clock::time_point drawn = Clock::now();
+		context->Swap();
+		Clock::time_point t2 = Clock::now();
+		frameStats.Record(chrono::duration<float, milli>(t1 - t0).count(), chrono::duration<float, milli>(drawn - t1).count(),
+			chrono::duration<float, milli>(t2 - drawn).count(), game.CurrentState());
+		lastFrameMs = chrono::duration<float, milli>(t2 - t0).count();
+#ifdef GL_TRACE
+		GLTraceEndFrame();
+#endif
+		AllocationStats frameEnd = ThreadAllocationStats();
+		unsigned long long frameAllocations = frameEnd.allocations - frameStart.allocations;
+		lastFrameAllocations = (unsigned int)frameAllocations;
+		allocations += frameAllocations;
+		allocatedBytes += frameEnd.bytes - frameStart.bytes;
+		if (frameAllocations > maxAllocations) {
+			maxAllocations = frameAllocations;
 		}
-		else { //otherwise
-			playerTwo->setFlag(-1, 0, -1); //set flag as false
+		gameFrames = (game.CurrentState() == GAME_MODE) ? gameFrames + 1 : 0;
+		if (steady) {
+			steadyFrames++;
+			steadyAllocations += frameAllocations;
+			allocatingFrames += (frameAllocations > 0);
 		}
 
-		//Bullet Collisions
-		for (Bullet* bullet : bullets) {
-			if (board->checkIfCollision(bullet->position[0], bullet->position[1])) { //Check if bullet hit a wall
-				bullet->distanceTraveled = bullet->maxDistance; //set bullet's distance to max so it dies
-			}
-			else if (fabs(bullet->position[0] - playerOne->position[0]) < 0.3f && fabs(bullet->position[1] - (playerOne->position[1] +0.5)) < 0.5 && bullet->sentiment == playerTwo->sentiment) {
-				//if bullet hits playerOne and its playerTwo's bullet
-				bullet->distanceTraveled = bullet->maxDistance; //set the bullet's distance to max so it dies
-				playerOne->gotHit(bullet->damage); //decrease playerOne's hp
-			}
-			else if (fabs(bullet->position[0] - playerTwo->position[0]) < 0.3f && fabs(bullet->position[1] - (playerTwo->position[1] + 0.5)) < 0.5 && bullet->sentiment == playerOne->sentiment) {
-				//if bullet hits playerTwo and its playerOne's bullet
-				bullet->distanceTraveled = bullet->maxDistance; //set the bullet's distance to max so it dies
-				playerTwo->gotHit(bullet->damage); //decrease playerTwo's hp
-			}
+		double submit = chrono::duration<double>(t2 - t1).count();
+		updateSeconds += chrono::duration<double>(t1 - t0).count();
+		submitSeconds += submit;
+		if (submit > maxSubmitSeconds) {
+			maxSubmitSeconds = submit;
+		}
+		drawCalls += gameStats.drawCalls;
+		if (gameStats.drawCalls > maxDrawCalls) {
+			maxDrawCalls = gameStats.drawCalls;
+		}
+		if (gpuSampled) { //two frames behind, and only when the query had finished, so each frame is counted at most once
+			gpuMilliseconds += context->GpuMilliseconds();
+			gpuSamples++;
 		}
 	}
-
-	/* LoadTexture
-		\description    - Takes in a filepath and loads the file into OpenGL for use in drawing
-		\param filePath - file path that is used to load image 
-	*/
-	GLuint LoadTexture(const char *filePath) {
-		int w, h, comp;
-		unsigned char* image = stbi_load(filePath, &w, &h, &comp, STBI_rgb_alpha);
-		if (image == NULL) {
-			std::cout << "Unable to load image. Make sure the path is correct\n";
-			assert(false);
+	glFinish();
+	int captured = 0;
+	int captureFailures = 0;
+	if (capture != nullptr) {
+		capture->Finish();
+		captured = capture->Written();
+		captureFailures = capture->Failed();
+		delete capture;
+	}
+	double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+	printf("{\n");
+	printf("  \"frames\": %d,\n", frameCount);
+	printf("  \"size\": [%d, %d],\n", width, height);
+	printf("  \"renderer\": \"%s\",\n", (const char*)glGetString(GL_RENDERER));
+	printf("  \"matches\": %d,\n", matches);
+	printf("  \"seconds\": %.6f,\n", seconds);
+	printf("  \"frames_per_second\": %.1f,\n", frameCount / seconds);
+	printf("  \"cpu_update_ms\": %.4f,\n", 1000.0 * updateSeconds / frameCount);
+	printf("  \"cpu_submit_ms\": %.4f,\n", 1000.0 * submitSeconds / frameCount);
+	printf("  \"cpu_submit_max_ms\": %.4f,\n", 1000.0 * maxSubmitSeconds);
+	printf("  \"draw_calls_per_frame\": %.2f,\n", (double)drawCalls / frameCount);
+	printf("  \"draw_calls_max\": %u,\n", maxDrawCalls);
+	printf("  \"frames_captured\": %d,\n", captured);
+	printf("  \"allocations_per_frame\": %.2f,\n", (double)allocations / frameCount);
+	printf("  \"allocated_bytes_per_frame\": %.1f,\n", (double)allocatedBytes / frameCount);
+	printf("  \"allocations_max\": %llu,\n", maxAllocations);
+	printf("  \"match_start_allocations\": %d,\n", game.MatchStartAllocations());
+	printf("  \"atlas_pages\": %d,\n", game.Atlas().Pages());
+	printf("  \"startup_ms\": {\"load_threads\": %d, \"menu_ready\": %.2f, \"assets_ready\": %.2f},\n", game.LoadThreads(),
+		chrono::duration<double, milli>(menuReady - loadStart).count(), chrono::duration<double, milli>(assetsReady - loadStart).count());
+	printf("  \"asset_pack_files\": %d,\n", assetPack.Entries());
+	printf("  \"texture_cache\": ");
+	textureCache.PrintStatsJSON(stdout);
+	printf(",\n");
+	printf("  \"texture_memory\": {\"textures\": %d, \"bytes\": %u, \"rgba8_bytes\": %u},\n", textureMemory.textures,
+		(unsigned int)textureMemory.bytes, (unsigned int)textureMemory.rgba8Bytes);
+	printf("  \"frame_scratch\": {\"capacity\": %u, \"peak\": %u, \"overflows\": %d},\n", (unsigned int)frameScratch.Capacity(),
+		(unsigned int)frameScratch.Peak(), frameScratch.Overflows());
+	printf("  \"match_arena\": {\"capacity\": %u, \"high_water\": %u, \"overflows\": %d},\n", (unsigned int)game.Arena().Capacity(),
+		(unsigned int)game.Arena().HighWater(), game.Arena().Overflows());
+	printf("  \"gpu_samples\": %d,\n", gpuSamples); //frames whose timer query had finished when it was read back
+	if (gpuSamples > 0) {
+		printf("  \"gpu_ms\": %.4f\n", gpuMilliseconds / gpuSamples);
+	}
+	else {
+		printf("  \"gpu_ms\": null\n");
+	}
+	printf("}\n");
+	frameStats.PrintSummary(stderr, modeNames);
+	game.Atlas().PrintLayout(stderr);
+#ifdef GL_TRACE
+	GLTracePrintSummary(stderr);
+#endif
+	SetAllocationSampling(0);
+	if (allocationSampling != 0 || allocationTest) {
+		PrintAllocationCallsites(stderr, ALLOCATION_REPORT_CALLSITES);
+	}
+	int result = 0;
+	if (captureFailures > 0) {
+		fprintf(stderr, "capture: %d frames could not be written\n", captureFailures);
+		result = 1;
+	}
+	if (allocationTest) {
+		fprintf(stderr, "alloc test: %d of %d steady GAME_MODE frames allocated (%llu allocations)\n", allocatingFrames, steadyFrames, steadyAllocations);
+		if (steadyFrames == 0) {
+			fprintf(stderr, "alloc test: no steady GAME_MODE frames, run more frames\n");
+			result = 4;
+		}
+		else if (allocatingFrames > 0) {
+			result = 4;
 		}
-		GLuint retTexture;
-		glGenTextures(1, &retTexture);
-		glBindTexture(GL_TEXTURE_2D, retTexture);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		stbi_image_free(image);
-		return retTexture;
 	}
-};
+
+	if (traceFile != nullptr) {
+#ifdef PROFILER_ENABLED
+		PROFILE_EXPORT(traceFile);
+#else
+		fprintf(stderr, "--trace needs a build with PROFILER_ENABLED defined\n");
+#endif
+	}
+	delete context;
+	SDL_Quit();
+	return result;
+}
 
 int main(int argc, char *argv[])
 {
-	SDL_Window* displayWindow;
+	if (argc > 1 && strcmp(argv[1], "--bench") == 0) { //headless simulation benchmark, no window or audio
+		return RunBenchmark(argc, argv);
+	}
+	if (argc > 2 && strcmp(argv[1], "--pack") == 0) { //packing tool: --pack assets.pack file..., run in the resource folder
+		return WriteAssetPack(argv[2], argc - 3, argv + 3);
+	}
+	if (argc > 1 && strcmp(argv[1], "--decode-bench") == 0) { //PNG decoders compared: --decode-bench [iterations] [file...], the game's images by default
+		static const char* const images[] = { "font2.png", "terrain.png", "guns.png", "character1.png", "bullet.png", "character2.png" };
+		int first = (argc > 2 && atoi(argv[2]) > 0) ? 3 : 2;
+		int iterations = (first == 3) ? atoi(argv[2]) : DECODE_BENCH_ITERATIONS;
+		if (argc > first) {
+			return RunDecodeBenchmark(argc - first, argv + first, iterations);
+		}
+		return RunDecodeBenchmark(sizeof(images) / sizeof(images[0]), images, iterations);
+	}
+	assetPack.Open(RESOURCE_FOLDER ASSET_PACK_FILE); //every load below reads from the pack if there is one
+	if (argc > 1 && strcmp(argv[1], "--frame-bench") == 0) { //headless rendering benchmark into an offscreen framebuffer
+		return RunFrameBenchmark(argc, argv);
+	}
+	if (argc > 1 && strcmp(argv[1], "--compare") == 0) { //compares frames captured by --frame-bench --capture against golden frames
+		return RunCompare(argc, argv);
+	}
+	float frameBudget = FRAME_BUDGET_MS; //--frame-budget ms
+	int hitchHistory = HITCH_HISTORY; //--hitch-history n
+	int loadThreads = ASSET_LOADER_THREADS; //--load-threads n
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--frame-budget") == 0) {
+			frameBudget = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--hitch-history") == 0) {
+			hitchHistory = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--load-threads") == 0) {
+			loadThreads = atoi(argv[++i]);
+		}
+	}
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--compress-textures") == 0) { //DXT5 for atlas pages no lossless format fits
+			SetTextureCompression(true);
+		}
+		else if (strcmp(argv[i], "--lossy-textures") == 0) { //smaller formats that are off by up to TEXTURE_LOSSY_TOLERANCE
+			SetLossyTextureFormats(true);
+		}
+	}
 	SDL_Init(SDL_INIT_VIDEO);
-	displayWindow = SDL_CreateWindow("Friendship Spheres!", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WINDOW_HEIGHT, WINDOW_WIDTH, SDL_WINDOW_OPENGL);
 #ifdef FULLSCREEN_MODE
-	SDL_SetWindowFullscreen(displayWindow, SDL_WINDOW_FULLSCREEN);
-#endif
-	SDL_GLContext context = SDL_GL_CreateContext(displayWindow);
-	SDL_GL_MakeCurrent(displayWindow, context);
-#ifdef _WINDOWS
-	glewInit();
+	RenderContext* context = RenderContext::CreateWindowed("Friendship Spheres!", WINDOW_HEIGHT, WINDOW_WIDTH, true);
+#else
+	RenderContext* context = RenderContext::CreateWindowed("Friendship Spheres!", WINDOW_HEIGHT, WINDOW_WIDTH, false);
 #endif
-	glViewport(0, 0, WINDOW_HEIGHT, WINDOW_WIDTH);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	SetupGL();
 	ShaderProgram program;
 	program.Load(RESOURCE_FOLDER"vertex_textured.glsl", RESOURCE_FOLDER"fragment_textured.glsl");
-	GameState game;
+	chrono::high_resolution_clock::time_point loadStart = chrono::high_resolution_clock::now();
+	GameState game(loadThreads);
+	float menuReadyMs = -1; //time from loadStart to the first frame the menu could be drawn in
+	float assetsReadyMs = -1;
 	SDL_Event event;
 	bool done = false;
+	FrameStats frameStats(frameBudget, hitchHistory);
+	PerfOverlay perfOverlay(game.FontSprite());
+	float lastFrameMs = 0;
+	unsigned int lastFrameAllocations = 0;
 	while (!done) {
 		while (SDL_PollEvent(&event)) {
 			if (event.type == SDL_QUIT || event.type == SDL_WINDOWEVENT_CLOSE) {
 				done = true;
 			}
+			else if (event.type == SDL_KEYDOWN && event.key.keysym.scancode == SDL_SCANCODE_F2) { //F2 saves the profiler's zones so far
+				PROFILE_EXPORT("profile.json");
+			}
+			else if (event.type == SDL_KEYDOWN && event.key.keysym.scancode == SDL_SCANCODE_F1) { //F1 shows or hides the performance overlay
+				perfOverlay.Toggle();
+			}
 		}
-		glClear(GL_COLOR_BUFFER_BIT);
+		ResetRenderStats();
+		frameScratch.BeginFrame();
+		AllocationStats allocationsStart = ThreadAllocationStats();
+		chrono::high_resolution_clock::time_point frameStart = chrono::high_resolution_clock::now();
 		game.Update(event, done);
+		chrono::high_resolution_clock::time_point updated = chrono::high_resolution_clock::now();
+		glClear(GL_COLOR_BUFFER_BIT);
 		game.Draw();
-		glDisableVertexAttribArray(program.positionAttribute);
-
-		SDL_GL_SwapWindow(displayWindow);
+		CountedDisableVertexAttribArray(program.positionAttribute);
+		perfOverlay.Record(lastFrameMs, renderStats, game.LiveBullets(), game.Substeps(), lastFrameAllocations);
+		perfOverlay.Draw();
+		chrono::high_resolution_clock::time_point drawn = chrono::high_resolution_clock::now();
+
+		context->Swap();
+		chrono::high_resolution_clock::time_point swapped = chrono::high_resolution_clock::now();
+		frameStats.Record(chrono::duration<float, milli>(updated - frameStart).count(), chrono::duration<float, milli>(drawn - updated).count(),
+			chrono::duration<float, milli>(swapped - drawn).count(), game.CurrentState());
+		lastFrameMs = chrono::duration<float, milli>(swapped - frameStart).count();
+		lastFrameAllocations = (unsigned int)(ThreadAllocationStats().allocations - allocationsStart.allocations);
+		if (menuReadyMs < 0 && game.MenuAssetsReady()) {
+			menuReadyMs = chrono::duration<float, milli>(swapped - loadStart).count();
+		}
+		if (assetsReadyMs < 0 && game.AssetsReady()) {
+			assetsReadyMs = chrono::duration<float, milli>(swapped - loadStart).count();
+		}
+#ifdef GL_TRACE
+		GLTraceEndFrame();
+#endif
 	}
 
+	frameStats.PrintSummary(stdout, modeNames);
+	printf("startup: menu ready after %.1f ms, every asset after %.1f ms (%d load threads)\n", menuReadyMs, assetsReadyMs, game.LoadThreads());
+	textureCache.PrintStats(stdout);
+	textureMemory.Print(stdout);
+#ifdef GL_TRACE
+	GLTracePrintSummary(stdout);
+#endif
+	printf("match arena: %u of %u bytes at most, %d overflows\n", (unsigned int)game.Arena().HighWater(), (unsigned int)game.Arena().Capacity(),
+		game.Arena().Overflows());
+	printf("frame scratch: %u of %u bytes at most, %d overflows\n", (unsigned int)frameScratch.Peak(), (unsigned int)frameScratch.Capacity(),
+		frameScratch.Overflows());
+	PROFILE_EXPORT("profile.json");
+	delete context;
 	SDL_Quit();
 
 	return 0;
@@ -11,6 +11,8 @@
 #include <sstream>
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <math.h>
 #include "ShaderProgram.h"
 #include "Matrix.h"
 
@@ -23,7 +25,10 @@
 	#define RESOURCE_FOLDER "NYUCodebase.app/Contents/Resources/"
 #endif
 
-#define TIME_STEP_SIZE 0.016f
+#define PLAYER_SPEED 1.0f //world units per second
+#define JUMP_SPEED 1.0f
+#define GRAVITY 1.0f //world units per second squared
+#define CONTACT_SKIN 0.0001f //keeps a box resting exactly on a tile edge from counting as inside that tile
 #define WINDOW_WIDTH 640
 #define WINDOW_HEIGHT 360
 
@@ -33,6 +38,7 @@ SDL_Window* displayWindow;
 enum EntityType {PLAYER, ENEMY};
 class Entity {
 public:
+	friend class Game;
 	Entity(ShaderProgram& shaderProgram, float* pos, GLuint texture, EntityType entity) : texture(texture), type(entity) {
 		program = &shaderProgram;
 		for (int i = 0; i < 3; i++) {
@@ -71,30 +77,18 @@ public:
 		glDrawArrays(GL_TRIANGLES, 0, 6);
 	}
 	void setVelocity(float x, float y, float z= 0) {
-		velocity[1] = (y != -1 ? y : velocity[1]);
+		velocity[1] = y;
 		if (type == PLAYER) {
-			velocity[0] = (x != -1 ? x : velocity[0]);
-			velocity[2] = (z != -1 ? x : velocity[2]);
+			velocity[0] = x;
+			velocity[2] = z;
 		}
 	}
-	void move(float elapsed) {
-		if (velocity[0] > 0 && collisionFlags[3] != true && position[0] < 18.75) {
-			position[0] += velocity[0] * elapsed;
-		}
-		if (velocity[0] < 0 && collisionFlags[2] != true && position[0] > 0) {
-			position[0] += velocity[0] * elapsed;
-		}
-		if (collisionFlags[2] != true && position[2] > -10) {
-			position[1] += velocity[1] * elapsed;
-			velocity[1] -= elapsed*0.000001f;
-		}
-	}
-	float* getPoints() {
-		points[0] = vertices[1] + position[1];
-		points[1] = position[1];
-		points[2] = position[0];
-		points[3] = position[0] + vertices[3];
-		return points;
+	//Returns how far gravity carries the entity along y in elapsed seconds. Integrated exactly (v*t - g*t^2/2), so a jump
+	//reaches the same height and lands at the same time whatever the frame time.
+	float applyGravity(float elapsed) {
+		float distance = velocity[1] * elapsed - 0.5f * GRAVITY * elapsed * elapsed;
+		velocity[1] -= GRAVITY * elapsed;
+		return distance;
 	}
 	void translate(float x, float y) {
 		position[0] += x;
@@ -117,7 +111,6 @@ protected:
 	Matrix projectionMatrix;
 	float position[3];
 	float vertices[12];
-	float points[4];
 	float rotationValue;
 	float velocity[3]; //x,y,z
 	bool collisionFlags[4]; //top, bottom, left, right
@@ -171,6 +164,9 @@ private:
 	void readLayer(ifstream* map);
 	void drawBackground();
 	void worldToTileMap(float worldX, float worldY, int* gridX, int* gridY);
+	bool solidTile(int x, int y);
+	void sweepX(Entity* entity, float distance, bool& left, bool& right);
+	void sweepY(Entity* entity, float distance, bool& top, bool& bottom);
 };
 
 Game::Game(ifstream* map, GLuint* texture) {
@@ -204,52 +200,36 @@ Game::Game(ifstream* map, GLuint* texture) {
 	entities.push_back(new Entity(program, pos, textures[2], ENEMY));
 }
 void Game::Update(SDL_Event& event, bool& done) {
-	float ticks = SDL_GetTicks();
+	float ticks = SDL_GetTicks() / 1000.0f;
 	float elapsed = ticks - lastTicks;
 	bool t, b, r, l;
-	float buffer = 0.01f;
 	lastTicks = ticks;
 	const Uint8 *keyboard = SDL_GetKeyboardState(NULL);
 	float xV = 0;
-	float yV = -1;
+	float yV = entities[0]->velocity[1]; //keep rising or falling unless UP starts a jump
 	if (keyboard[SDL_SCANCODE_RIGHT]) {
-		xV = 0.001f;
+		xV = PLAYER_SPEED;
 	}
 	else if (keyboard[SDL_SCANCODE_LEFT]) {
-		xV = -0.001f;
+		xV = -PLAYER_SPEED;
 	}
 	else if (keyboard[SDL_SCANCODE_UP]) {
-		yV = 0.001f;
+		yV = JUMP_SPEED;
 	}
 	entities[0]->setVelocity(xV, yV, 0);
 	for (Entity* entity : entities) {
-		int x, y;
 		t = false;
 		b = false;
 		r = false;
 		l = false;
-		entity->move(elapsed);
-		float* places = entity->getPoints(); //top bottom left right
-		float* positions = entity->getPosition();
-		worldToTileMap(positions[0]+0.75, positions[1]+0.2, &x, &y);
-		if (tilemap[y][x] != 0) {
-			b = true;
-			entity->setVelocity(-1, 0, 0);
+		float fall = entity->applyGravity(elapsed);
+		sweepX(entity, entity->velocity[0] * elapsed, l, r); //x then y, so a box sliding along the floor never snags on it
+		sweepY(entity, fall, t, b);
+		if (l || r) {
+			entity->velocity[0] = 0;
 		}
-		worldToTileMap(positions[0] + 0.75, positions[1] + 1.5, &x, &y);
-		if (tilemap[y][x] != 0) {
-			t = true;
-			entity->setVelocity(-1, -0.0001f, 0);
-		}
-		worldToTileMap(positions[0] + 1.4, positions[1] + 0.75, &x, &y);
-		if (tilemap[y][x] != 0) {
-			r = true;
-			entity->setVelocity(0, -1, 0);
-		}
-		worldToTileMap(positions[0] - 0.1, positions[1] + 0.75, &x, &y);
-		if (tilemap[y][x] != 0) {
-			l = true;
-			entity->setVelocity(0, -1, 0);
+		if (t || b) {
+			entity->velocity[1] = 0;
 		}
 		entity->setFlags(t, b, r, l);
 	}
@@ -384,6 +364,86 @@ void Game::worldToTileMap(float worldX, float worldY, int* gridX, int* gridY) {
 	*gridX = (int)(worldX);
 	*gridY = ceil(-worldY - 1);
 }
+//Tile (x, y) covers world x in [x, x + 1] and world y in [-y - 1, -y]. Columns past either side of the map act as walls,
+//rows above or below it are open.
+bool Game::solidTile(int x, int y) {
+	if (x < 0 || x >= width) { return true; }
+	if (y < 0 || y >= height) { return false; }
+	return tilemap[y][x] != 0;
+}
+//Moves the entity distance units along x, stopping flush against the first solid column its leading edge crosses.
+//Only the tiles between the old and new leading edge are visited, so any elapsed time is handled the same way.
+void Game::sweepX(Entity* entity, float distance, bool& left, bool& right) {
+	if (distance == 0) { return; }
+	float boxWidth = entity->vertices[4];
+	float boxHeight = entity->vertices[1];
+	float x0 = entity->position[0];
+	float x1 = x0 + boxWidth;
+	int firstRow = max((int)floor(-(entity->position[1] + boxHeight) + CONTACT_SKIN), 0);
+	int lastRow = min((int)floor(-entity->position[1] - CONTACT_SKIN), height - 1);
+	if (distance > 0) {
+		int lastColumn = (int)ceil(x1 + distance) - 1;
+		for (int x = (int)floor(x1 - CONTACT_SKIN) + 1; x <= lastColumn; x++) {
+			for (int y = firstRow; y <= lastRow; y++) {
+				if (solidTile(x, y)) {
+					entity->position[0] = x - boxWidth;
+					right = true;
+					return;
+				}
+			}
+		}
+	}
+	else {
+		int lastColumn = (int)floor(x0 + distance);
+		for (int x = (int)floor(x0 + CONTACT_SKIN) - 1; x >= lastColumn; x--) {
+			for (int y = firstRow; y <= lastRow; y++) {
+				if (solidTile(x, y)) {
+					entity->position[0] = (float)(x + 1);
+					left = true;
+					return;
+				}
+			}
+		}
+	}
+	entity->position[0] += distance;
+}
+//Same as sweepX along y. Rows are counted downwards, so falling walks the rows in increasing order.
+void Game::sweepY(Entity* entity, float distance, bool& top, bool& bottom) {
+	if (distance == 0) { return; }
+	float boxWidth = entity->vertices[4];
+	float boxHeight = entity->vertices[1];
+	float y0 = entity->position[1];
+	float y1 = y0 + boxHeight;
+	int firstColumn = (int)floor(entity->position[0] + CONTACT_SKIN);
+	int lastColumn = (int)floor(entity->position[0] + boxWidth - CONTACT_SKIN);
+	if (distance < 0) {
+		int firstRow = max((int)ceil(-y0 - CONTACT_SKIN), 0);
+		int lastRow = min((int)ceil(-(y0 + distance)) - 1, height - 1);
+		for (int y = firstRow; y <= lastRow; y++) {
+			for (int x = firstColumn; x <= lastColumn; x++) {
+				if (solidTile(x, y)) {
+					entity->position[1] = (float)-y;
+					bottom = true;
+					return;
+				}
+			}
+		}
+	}
+	else {
+		int firstRow = min((int)floor(-y1 + CONTACT_SKIN) - 1, height - 1);
+		int lastRow = max((int)floor(-(y1 + distance)), 0);
+		for (int y = firstRow; y >= lastRow; y--) {
+			for (int x = firstColumn; x <= lastColumn; x++) {
+				if (solidTile(x, y)) {
+					entity->position[1] = -y - 1 - boxHeight;
+					top = true;
+					return;
+				}
+			}
+		}
+	}
+	entity->position[1] += distance;
+}
 
 
 int main(int argc, char *argv[])
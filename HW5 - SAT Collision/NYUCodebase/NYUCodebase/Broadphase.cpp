@@ -0,0 +1,67 @@
+#include "Broadphase.h"
+
+AABB ComputeAABB(const SATPolygon &poly) {
+	AABB box;
+	box.minX = box.maxX = poly.x[0];
+	box.minY = box.maxY = poly.y[0];
+	for(int i=1; i < poly.count; i++) {
+		box.minX = (poly.x[i] < box.minX) ? poly.x[i] : box.minX;
+		box.maxX = (poly.x[i] > box.maxX) ? poly.x[i] : box.maxX;
+		box.minY = (poly.y[i] < box.minY) ? poly.y[i] : box.minY;
+		box.maxY = (poly.y[i] > box.maxY) ? poly.y[i] : box.maxY;
+	}
+	return box;
+}
+
+int SweepAndPrune::Add(const AABB &box) {
+	boxes.push_back(box);
+	order.push_back((int)boxes.size() - 1);
+	return (int)boxes.size() - 1;
+}
+
+void SweepAndPrune::Update(int id, const AABB &box) {
+	boxes[id] = box;
+}
+
+int SweepAndPrune::Size() const {
+	return (int)boxes.size();
+}
+
+int SweepAndPrune::LastSwapCount() const {
+	return swaps;
+}
+
+void SweepAndPrune::SortAxis() {
+	swaps = 0;
+	for(int i=1; i < order.size(); i++) {
+		int id = order[i];
+		float key = boxes[id].minX;
+		int j = i - 1;
+		while(j >= 0 && boxes[order[j]].minX > key) {
+			order[j + 1] = order[j];
+			j--;
+			swaps++;
+		}
+		order[j + 1] = id;
+	}
+}
+
+void SweepAndPrune::FindPairs(std::vector<std::pair<int, int>> &pairs) {
+	pairs.clear();
+	SortAxis();
+	for(int i=0; i < order.size(); i++) {
+		const AABB &a = boxes[order[i]];
+		for(int j=i+1; j < order.size(); j++) {
+			const AABB &b = boxes[order[j]];
+			if(b.minX > a.maxX) { //everything after this starts further right, so nothing else can overlap a
+				break;
+			}
+			if(b.minY > a.maxY || b.maxY < a.minY) {
+				continue;
+			}
+			int first = order[i];
+			int second = order[j];
+			pairs.push_back(first < second ? std::make_pair(first, second) : std::make_pair(second, first));
+		}
+	}
+}
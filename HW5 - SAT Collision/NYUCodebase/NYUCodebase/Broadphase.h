@@ -0,0 +1,51 @@
+
+#pragma once
+#include <vector>
+#include <utility>
+#include "SatCollision.h"
+
+//AABB - world space axis aligned bounding box
+struct AABB {
+	float minX;
+	float minY;
+	float maxX;
+	float maxY;
+};
+
+/* ComputeAABB()
+	\description - Returns the bounding box of a polygon's vertices
+	\param poly  - polygon in world coordinates
+*/
+AABB ComputeAABB(const SATPolygon &poly);
+
+//SweepAndPrune - Broadphase that keeps its proxies sorted along x between frames. Shapes move little from one frame
+//to the next, so re-sorting with insertion sort is close to linear and only overlapping pairs reach the narrowphase.
+class SweepAndPrune {
+public:
+	/* Add()
+		\description - Registers a new proxy and returns its id (ids are dense, starting at 0)
+		\param box   - initial bounds of the proxy
+	*/
+	int Add(const AABB &box);
+
+	/* Update()
+		\description - Replaces the bounds of a proxy (the sorted order is repaired in FindPairs)
+		\param id    - id returned by Add
+		\param box   - new bounds
+	*/
+	void Update(int id, const AABB &box);
+
+	/* FindPairs()
+		\description - Re-sorts the axis list and writes every pair of proxies whose boxes overlap (lower id first)
+		\param pairs - output list, cleared before writing
+	*/
+	void FindPairs(std::vector<std::pair<int, int>> &pairs);
+
+	int Size() const;
+	int LastSwapCount() const; //number of insertion sort swaps done by the last FindPairs
+private:
+	std::vector<AABB> boxes;
+	std::vector<int> order; //proxy ids sorted by minX
+	int swaps = 0;
+	void SortAxis();
+};
@@ -0,0 +1,83 @@
+#include "ContactCache.h"
+
+bool SATContactCache::Collide(int idA, const SATPolygon &a, int idB, const SATPolygon &b, float &penX, float &penY) {
+	//always test the lower id first so the cached polygon index means the same thing whichever order we are called in
+	bool swapped = idB < idA;
+	const SATPolygon &first = swapped ? b : a;
+	const SATPolygon &second = swapped ? a : b;
+	int low = swapped ? idB : idA;
+	int high = swapped ? idA : idB;
+
+	if((size_t)(low + 1) * CONTACT_CACHE_WAYS > entries.size()) {
+		Entry unused;
+		unused.partner = -1;
+		unused.frame = 0;
+		entries.resize((size_t)(low + 1) * CONTACT_CACHE_WAYS, unused);
+	}
+	Entry *slots = &entries[(size_t)low * CONTACT_CACHE_WAYS];
+	Entry *entry = nullptr;
+	Entry *oldest = &slots[0];
+	for(int i=0; i < CONTACT_CACHE_WAYS; i++) {
+		if(slots[i].partner == high && slots[i].frame + 1 >= frame) { //tested this frame or the last one
+			entry = &slots[i];
+			break;
+		}
+		if(slots[i].frame < oldest->frame) {
+			oldest = &slots[i];
+		}
+	}
+	if(entry == nullptr) {
+		entry = oldest;
+		entry->partner = high;
+		entry->axis = SATAxisCache();
+	}
+	entry->frame = frame;
+	bool hadAxis = entry->axis.separating;
+
+	int axes = 0;
+	bool collided = CheckSATCollision(first, second, penX, penY, entry->axis, axes);
+	tests++;
+	axesTested += axes;
+	if(hadAxis && !collided && axes == 1) {
+		hits++;
+	}
+	if(collided && swapped) {
+		penX *= -1.0f;
+		penY *= -1.0f;
+	}
+	return collided;
+}
+
+void SATContactCache::EndFrame() {
+	frame++;
+}
+
+void SATContactCache::Clear() {
+	entries.clear();
+}
+
+void SATContactCache::ResetStats() {
+	tests = 0;
+	hits = 0;
+	axesTested = 0;
+}
+
+long long SATContactCache::Tests() const {
+	return tests;
+}
+
+long long SATContactCache::Hits() const {
+	return hits;
+}
+
+long long SATContactCache::AxesTested() const {
+	return axesTested;
+}
+
+double SATContactCache::HitRate() const {
+	return tests == 0 ? 0.0 : (double)hits / (double)tests;
+}
+
+double SATContactCache::AverageAxesPerTest() const {
+	return tests == 0 ? 0.0 : (double)axesTested / (double)tests;
+}
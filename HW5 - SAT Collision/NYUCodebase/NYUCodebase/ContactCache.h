@@ -0,0 +1,52 @@
+
+#pragma once
+#include <stddef.h>
+#include <vector>
+#include "SatCollision.h"
+
+#define CONTACT_CACHE_WAYS 4 //pairs remembered per shape, the least recently used one is replaced when a shape has more
+
+//SATContactCache - Per pair memory of the last separating (or minimum penetration) axis, keyed by the two shape ids.
+//Shapes barely move between frames, so the axis that separated them last frame usually still does and the pair is
+//rejected after projecting a single axis.
+//Ids are dense, so every shape owns CONTACT_CACHE_WAYS slots in one flat array for the pairs it is the lower id of.
+//Slots are stamped with the frame they were last used in, so pairs that left the broadphase simply go stale.
+//Only --bench uses it for now: in scenes where most broadphase pairs overlap, the lookups cost more than the axes saved.
+class SATContactCache {
+public:
+	/* Collide()
+		\description - Cached SAT test between shape idA and shape idB
+		\param idA   - id of the first shape
+		\param a     - world vertices of the first shape
+		\param idB   - id of the second shape
+		\param b     - world vertices of the second shape
+		\param penX  - x component of the minimum translation vector (points from b towards a)
+		\param penY  - y component of the minimum translation vector
+	*/
+	bool Collide(int idA, const SATPolygon &a, int idB, const SATPolygon &b, float &penX, float &penY);
+
+	/* EndFrame()
+		\description - Drops entries for pairs that were not tested since the last EndFrame (they left the broadphase)
+	*/
+	void EndFrame();
+
+	void Clear();
+	void ResetStats();
+	long long Tests() const;
+	long long Hits() const; //tests answered by the cached axis alone
+	long long AxesTested() const;
+	double HitRate() const;
+	double AverageAxesPerTest() const;
+private:
+	struct Entry {
+		int partner; //higher id of the pair, -1 if the slot was never used
+		unsigned int frame; //frame the pair was last tested in
+		SATAxisCache axis;
+	};
+
+	std::vector<Entry> entries; //CONTACT_CACHE_WAYS slots per shape, indexed by the lower id of a pair
+	unsigned int frame = 1;
+	long long tests = 0;
+	long long hits = 0;
+	long long axesTested = 0;
+};
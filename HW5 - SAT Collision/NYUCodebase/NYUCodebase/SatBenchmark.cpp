@@ -0,0 +1,466 @@
+#include "SatBenchmark.h"
+#include "SatCollision.h"
+#include "Broadphase.h"
+#include "ContactCache.h"
+#include "TransformedPolygon.h"
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+//Original implementation, kept only as the baseline for the benchmark (centroids are zero-initialized here so the
+//comparison is not reading garbage).
+namespace legacy {
+	bool TestSATSeparationForEdge(float edgeX, float edgeY, const std::vector<std::pair<float,float>> &points1, const std::vector<std::pair<float,float>> &points2, std::pair<float,float> &penetration) {
+		float normalX = -edgeY;
+		float normalY = edgeX;
+		float len = sqrtf(normalX*normalX + normalY*normalY);
+		normalX /= len;
+		normalY /= len;
+
+		std::vector<float> e1Projected;
+		std::vector<float> e2Projected;
+		for(int i=0; i < points1.size(); i++) {
+			e1Projected.push_back(points1[i].first * normalX + points1[i].second * normalY);
+		}
+		for(int i=0; i < points2.size(); i++) {
+			e2Projected.push_back(points2[i].first * normalX + points2[i].second * normalY);
+		}
+		std::sort(e1Projected.begin(), e1Projected.end());
+		std::sort(e2Projected.begin(), e2Projected.end());
+
+		float e1Min = e1Projected[0];
+		float e1Max = e1Projected[e1Projected.size()-1];
+		float e2Min = e2Projected[0];
+		float e2Max = e2Projected[e2Projected.size()-1];
+
+		float e1Width = fabs(e1Max-e1Min);
+		float e2Width = fabs(e2Max-e2Min);
+		float e1Center = e1Min + (e1Width/2.0);
+		float e2Center = e2Min + (e2Width/2.0);
+		float dist = fabs(e1Center-e2Center);
+		float p = dist - ((e1Width+e2Width)/2.0);
+		if(p >= 0) {
+			return false;
+		}
+		float penetrationMin1 = e1Max - e2Min;
+		float penetrationMin2 = e2Max - e1Min;
+		float penetrationAmount = penetrationMin1;
+		if(penetrationMin2 < penetrationAmount) {
+			penetrationAmount = penetrationMin2;
+		}
+		penetration.first = normalX * penetrationAmount;
+		penetration.second = normalY * penetrationAmount;
+		return true;
+	}
+
+	bool PenetrationSort(const std::pair<float,float> &p1, const std::pair<float,float> &p2) {
+		return sqrtf(p1.first*p1.first + p1.second*p1.second) < sqrtf(p2.first*p2.first + p2.second*p2.second);
+	}
+
+	bool CheckSATCollision(const std::vector<std::pair<float,float>> &e1Points, const std::vector<std::pair<float,float>> &e2Points, std::pair<float,float> &penetration) {
+		std::vector<std::pair<float,float>> penetrations;
+		for(int i=0; i < e1Points.size(); i++) {
+			int next = (i == e1Points.size()-1) ? 0 : i+1;
+			std::pair<float,float> p;
+			if(!TestSATSeparationForEdge(e1Points[next].first - e1Points[i].first, e1Points[next].second - e1Points[i].second, e1Points, e2Points, p)) {
+				return false;
+			}
+			penetrations.push_back(p);
+		}
+		for(int i=0; i < e2Points.size(); i++) {
+			int next = (i == e2Points.size()-1) ? 0 : i+1;
+			std::pair<float,float> p;
+			if(!TestSATSeparationForEdge(e2Points[next].first - e2Points[i].first, e2Points[next].second - e2Points[i].second, e1Points, e2Points, p)) {
+				return false;
+			}
+			penetrations.push_back(p);
+		}
+		std::sort(penetrations.begin(), penetrations.end(), PenetrationSort);
+		penetration = penetrations[0];
+
+		std::pair<float,float> e1Center(0.0f, 0.0f);
+		for(int i=0; i < e1Points.size(); i++) {
+			e1Center.first += e1Points[i].first;
+			e1Center.second += e1Points[i].second;
+		}
+		e1Center.first /= (float)e1Points.size();
+		e1Center.second /= (float)e1Points.size();
+		std::pair<float,float> e2Center(0.0f, 0.0f);
+		for(int i=0; i < e2Points.size(); i++) {
+			e2Center.first += e2Points[i].first;
+			e2Center.second += e2Points[i].second;
+		}
+		e2Center.first /= (float)e2Points.size();
+		e2Center.second /= (float)e2Points.size();
+
+		if((penetration.first * (e1Center.first - e2Center.first)) + (penetration.second * (e1Center.second - e2Center.second)) < 0.0f) {
+			penetration.first *= -1.0f;
+			penetration.second *= -1.0f;
+		}
+		return true;
+	}
+}
+
+//Builds a random convex polygon (3 to SAT_MAX_POINTS vertices on a rotated circle) around (cx, cy)
+static std::vector<std::pair<float,float>> RandomPolygon(std::mt19937 &rng, float cx, float cy) {
+	std::uniform_int_distribution<int> sides(3, SAT_MAX_POINTS);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	int count = sides(rng);
+	float radius = 0.25f + unit(rng);
+	float rotation = unit(rng) * 6.2831853f;
+	std::vector<std::pair<float,float>> points;
+	for(int i=0; i < count; i++) {
+		float angle = rotation + 6.2831853f * (float)i / (float)count;
+		points.push_back(std::make_pair(cx + radius * cosf(angle), cy + radius * sinf(angle)));
+	}
+	return points;
+}
+
+int RunSATBenchmark(int pairs, int runs) {
+	std::mt19937 rng(3113);
+	std::uniform_real_distribution<float> offset(-2.5f, 2.5f);
+
+	std::vector<std::vector<std::pair<float,float>>> first;
+	std::vector<std::vector<std::pair<float,float>>> second;
+	std::vector<SATPolygon> firstPolys(pairs);
+	std::vector<SATPolygon> secondPolys(pairs);
+	for(int i=0; i < pairs; i++) {
+		first.push_back(RandomPolygon(rng, 0.0f, 0.0f));
+		second.push_back(RandomPolygon(rng, offset(rng), offset(rng)));
+		for(int j=0; j < first[i].size(); j++) {
+			SetSATPoint(firstPolys[i], j, first[i][j].first, first[i][j].second);
+		}
+		for(int j=0; j < second[i].size(); j++) {
+			SetSATPoint(secondPolys[i], j, second[i][j].first, second[i][j].second);
+		}
+	}
+
+	//Correctness check against the original implementation
+	int hits = 0;
+	int mismatches = 0;
+	for(int i=0; i < pairs; i++) {
+		std::pair<float,float> oldPen(0.0f, 0.0f);
+		float newX = 0.0f, newY = 0.0f;
+		bool oldHit = legacy::CheckSATCollision(first[i], second[i], oldPen);
+		bool newHit = CheckSATCollision(firstPolys[i], secondPolys[i], newX, newY);
+		hits += newHit ? 1 : 0;
+		float oldLen = sqrtf(oldPen.first*oldPen.first + oldPen.second*oldPen.second);
+		float newLen = sqrtf(newX*newX + newY*newY);
+		if(oldHit != newHit || (newHit && fabs(oldLen - newLen) > 1e-3f)) {
+			mismatches++;
+		}
+	}
+
+	typedef std::chrono::high_resolution_clock Clock;
+	int sink = 0;
+
+	Clock::time_point start = Clock::now();
+	for(int run=0; run < runs; run++) {
+		for(int i=0; i < pairs; i++) {
+			std::pair<float,float> pen;
+			sink += legacy::CheckSATCollision(first[i], second[i], pen) ? 1 : 0;
+		}
+	}
+	double legacySeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	start = Clock::now();
+	for(int run=0; run < runs; run++) {
+		for(int i=0; i < pairs; i++) {
+			std::pair<float,float> pen;
+			sink += CheckSATCollision(first[i], second[i], pen) ? 1 : 0;
+		}
+	}
+	double wrapperSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	start = Clock::now();
+	for(int run=0; run < runs; run++) {
+		for(int i=0; i < pairs; i++) {
+			float penX, penY;
+			sink += CheckSATCollision(firstPolys[i], secondPolys[i], penX, penY) ? 1 : 0;
+		}
+	}
+	double kernelSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	double tests = (double)pairs * runs;
+	printf("SAT benchmark: %d pairs x %d runs, %d colliding, %d mismatches vs original (checksum %d)\n", pairs, runs, hits, mismatches, sink);
+	printf("  original (vector + sort) : %12.0f pairs/s\n", tests / legacySeconds);
+	printf("  vector wrapper           : %12.0f pairs/s (%.2fx)\n", tests / wrapperSeconds, legacySeconds / wrapperSeconds);
+	printf("  SATPolygon kernel        : %12.0f pairs/s (%.2fx)\n", tests / kernelSeconds, legacySeconds / kernelSeconds);
+	return mismatches == 0 ? 0 : 1;
+}
+
+float GenerateScene(std::vector<SceneShape> &shapes, int count, unsigned int seed) {
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> sides(3, SAT_MAX_POINTS);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	float worldSize = sqrtf((float)count * 4.0f); //about four square units of room per shape
+
+	shapes.clear();
+	shapes.resize(count);
+	for(int i=0; i < count; i++) {
+		SceneShape &shape = shapes[i];
+		int pointCount = sides(rng);
+		for(int j=0; j < pointCount; j++) {
+			float angle = 6.2831853f * (float)j / (float)pointCount;
+			SetSATPoint(shape.local, j, 0.5f * cosf(angle), 0.5f * sinf(angle));
+		}
+		shape.position[0] = unit(rng) * worldSize;
+		shape.position[1] = unit(rng) * worldSize;
+		shape.velocity[0] = (unit(rng) - 0.5f) * 2.0f;
+		shape.velocity[1] = (unit(rng) - 0.5f) * 2.0f;
+		shape.rotation = unit(rng) * 6.2831853f;
+		shape.spin = (unit(rng) - 0.5f) * 4.0f;
+		shape.scale = 0.5f + unit(rng);
+	}
+	StepScene(shapes, 0.0f, worldSize);
+	return worldSize;
+}
+
+void StepScene(std::vector<SceneShape> &shapes, float elapsed, float worldSize) {
+	for(int i=0; i < shapes.size(); i++) {
+		SceneShape &shape = shapes[i];
+		for(int axis=0; axis < 2; axis++) {
+			shape.position[axis] += shape.velocity[axis] * elapsed;
+			if((shape.position[axis] < 0.0f && shape.velocity[axis] < 0.0f) || (shape.position[axis] > worldSize && shape.velocity[axis] > 0.0f)) {
+				shape.velocity[axis] *= -1.0f;
+			}
+		}
+		shape.rotation += shape.spin * elapsed;
+		float c = cosf(shape.rotation) * shape.scale;
+		float s = sinf(shape.rotation) * shape.scale;
+		for(int j=0; j < shape.local.count; j++) {
+			float x = shape.local.x[j];
+			float y = shape.local.y[j];
+			SetSATPoint(shape.world, j, x * c - y * s + shape.position[0], x * s + y * c + shape.position[1]);
+		}
+	}
+}
+
+int RunBroadphaseBenchmark(int shapeCount, int frames) {
+	typedef std::chrono::high_resolution_clock Clock;
+	std::vector<SceneShape> shapes;
+	float worldSize = GenerateScene(shapes, shapeCount, 3113);
+
+	SweepAndPrune broadphase;
+	for(int i=0; i < shapes.size(); i++) {
+		broadphase.Add(ComputeAABB(shapes[i].world));
+	}
+
+	std::vector<std::pair<int, int>> pairs;
+	broadphase.FindPairs(pairs); //first sort starts from random order, keep it out of the frame coherent timings
+	double broadSeconds = 0.0;
+	double narrowSeconds = 0.0;
+	long long narrowCalls = 0;
+	long long collisions = 0;
+	long long swaps = 0;
+	for(int frame=0; frame < frames; frame++) {
+		StepScene(shapes, 1.0f / 60.0f, worldSize);
+
+		Clock::time_point start = Clock::now();
+		for(int i=0; i < shapes.size(); i++) {
+			broadphase.Update(i, ComputeAABB(shapes[i].world));
+		}
+		broadphase.FindPairs(pairs);
+		Clock::time_point mid = Clock::now();
+		for(int i=0; i < pairs.size(); i++) {
+			float penX, penY;
+			collisions += CheckSATCollision(shapes[pairs[i].first].world, shapes[pairs[i].second].world, penX, penY) ? 1 : 0;
+		}
+		Clock::time_point end = Clock::now();
+
+		broadSeconds += std::chrono::duration<double>(mid - start).count();
+		narrowSeconds += std::chrono::duration<double>(end - mid).count();
+		narrowCalls += pairs.size();
+		swaps += broadphase.LastSwapCount();
+	}
+
+	double allPairs = (double)shapeCount * (shapeCount - 1) / 2.0;
+	double callsPerFrame = (double)narrowCalls / frames;
+	printf("Broadphase benchmark: %d shapes, %d frames\n", shapeCount, frames);
+	printf("  all pairs / frame          : %14.0f\n", allPairs);
+	printf("  narrowphase calls / frame  : %14.1f (%.4f%% culled)\n", callsPerFrame, 100.0 * (1.0 - callsPerFrame / allPairs));
+	printf("  collisions / frame         : %14.1f\n", (double)collisions / frames);
+	printf("  insertion sort swaps/frame : %14.1f\n", (double)swaps / frames);
+	printf("  broadphase ms / frame      : %14.3f\n", 1000.0 * broadSeconds / frames);
+	printf("  narrowphase ms / frame     : %14.3f\n", 1000.0 * narrowSeconds / frames);
+	return 0;
+}
+
+int RunCoherenceBenchmark(int shapeCount, int frames) {
+	typedef std::chrono::high_resolution_clock Clock;
+	std::vector<SceneShape> shapes;
+	float worldSize = GenerateScene(shapes, shapeCount, 3113);
+
+	SweepAndPrune broadphase;
+	for(int i=0; i < shapes.size(); i++) {
+		broadphase.Add(ComputeAABB(shapes[i].world));
+	}
+	std::vector<std::pair<int, int>> pairs;
+	SATContactCache cache;
+
+	long long fullAxes = 0;
+	long long separated = 0;
+	long long mismatches = 0;
+	double fullSeconds = 0.0;
+	double cachedSeconds = 0.0;
+	for(int frame=0; frame < frames; frame++) {
+		StepScene(shapes, 1.0f / 60.0f, worldSize);
+		for(int i=0; i < shapes.size(); i++) {
+			broadphase.Update(i, ComputeAABB(shapes[i].world));
+		}
+		broadphase.FindPairs(pairs);
+
+		int fullHits = 0;
+		Clock::time_point start = Clock::now();
+		for(int i=0; i < pairs.size(); i++) {
+			SATAxisCache fresh;
+			int axes = 0;
+			float penX, penY;
+			fullHits += CheckSATCollision(shapes[pairs[i].first].world, shapes[pairs[i].second].world, penX, penY, fresh, axes) ? 1 : 0;
+			fullAxes += axes;
+		}
+		Clock::time_point mid = Clock::now();
+		int cachedHits = 0;
+		for(int i=0; i < pairs.size(); i++) {
+			float penX, penY;
+			cachedHits += cache.Collide(pairs[i].first, shapes[pairs[i].first].world, pairs[i].second, shapes[pairs[i].second].world, penX, penY) ? 1 : 0;
+		}
+		cache.EndFrame();
+		Clock::time_point end = Clock::now();
+
+		fullSeconds += std::chrono::duration<double>(mid - start).count();
+		cachedSeconds += std::chrono::duration<double>(end - mid).count();
+		mismatches += (fullHits != cachedHits) ? 1 : 0;
+		separated += (long long)pairs.size() - fullHits;
+	}
+
+	printf("Axis cache benchmark: %d shapes, %d frames, %lld pair tests\n", shapeCount, frames, cache.Tests());
+	printf("  cache hit rate          : %8.2f%% of all pairs, %.2f%% of separated pairs\n", 100.0 * cache.HitRate(), separated == 0 ? 0.0 : 100.0 * cache.Hits() / separated);
+	printf("  axes / pair (full SAT)  : %8.3f\n", (double)fullAxes / (double)cache.Tests());
+	printf("  axes / pair (cached)    : %8.3f\n", cache.AverageAxesPerTest());
+	printf("  narrowphase ms / frame  : %8.3f full, %8.3f cached\n", 1000.0 * fullSeconds / frames, 1000.0 * cachedSeconds / frames);
+	printf("  frames with different results: %lld\n", mismatches);
+	return mismatches == 0 ? 0 : 1;
+}
+
+//Per pair transform the HW5 triangles used before TransformedPolygon: recompute into a vector, then copy it
+static void LegacyWorldCoordinates(std::vector<std::pair<float,float>> &world, const float *vertices, float x, float y, float rotation, float scale) {
+	float c = cos(rotation);
+	float s = sin(rotation);
+	world.clear();
+	for(int i=0; i < 6; i+=2) {
+		float X = vertices[i+0];
+		float Y = vertices[i+1];
+		world.push_back(std::make_pair(scale * X * c - scale * Y * s + scale * x * c - scale * y * s, scale * X * s + scale * Y * c + scale * x * s + scale * y * c));
+	}
+}
+
+int RunTransformCacheBenchmark(int shapeCount, int frames) {
+	typedef std::chrono::high_resolution_clock Clock;
+	const float triVertices[6] = { 0.5f, -0.5f, 0.0f, 0.5f, -0.5f, -0.5f };
+	std::mt19937 rng(3113);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	float worldSize = sqrtf((float)shapeCount); //dense scene, every triangle overlaps a few neighbours
+
+	std::vector<float> positions(shapeCount * 2);
+	std::vector<float> velocities(shapeCount * 2);
+	std::vector<float> rotations(shapeCount);
+	std::vector<TransformedPolygon> shapes(shapeCount);
+	for(int i=0; i < shapeCount; i++) {
+		positions[i*2] = unit(rng) * worldSize;
+		positions[i*2+1] = unit(rng) * worldSize;
+		velocities[i*2] = unit(rng) - 0.5f;
+		velocities[i*2+1] = unit(rng) - 0.5f;
+		rotations[i] = unit(rng) * 6.2831853f;
+		for(int j=0; j < 3; j++) {
+			shapes[i].SetLocalPoint(j, triVertices[j*2], triVertices[j*2+1]);
+		}
+	}
+
+	SweepAndPrune broadphase;
+	for(int i=0; i < shapeCount; i++) {
+		shapes[i].SetTransform(positions[i*2], positions[i*2+1], rotations[i], 1.0f);
+		broadphase.Add(ComputeAABB(shapes[i].World()));
+	}
+	std::vector<std::pair<int, int>> pairs;
+	broadphase.FindPairs(pairs);
+	int cachedBefore = 0;
+	for(int i=0; i < shapeCount; i++) {
+		cachedBefore += shapes[i].TransformCount();
+	}
+
+	std::vector<AABB> boxes(shapeCount);
+	std::vector<std::pair<float,float>> worldA;
+	std::vector<std::pair<float,float>> worldB;
+	long long legacyTransforms = 0;
+	long long pairTests = 0;
+	double legacySeconds = 0.0;
+	double cachedSeconds = 0.0;
+	int sink = 0;
+	for(int frame=0; frame < frames; frame++) {
+		for(int i=0; i < shapeCount; i++) {
+			positions[i*2] += velocities[i*2] / 60.0f;
+			positions[i*2+1] += velocities[i*2+1] / 60.0f;
+			shapes[i].SetTransform(positions[i*2], positions[i*2+1], rotations[i], 1.0f);
+		}
+
+		//cached: bounds and every pair test share one transform per shape (broadphase sorting is left out of both timings)
+		Clock::time_point start = Clock::now();
+		for(int i=0; i < shapeCount; i++) {
+			boxes[i] = ComputeAABB(shapes[i].World());
+		}
+		Clock::time_point sorted = Clock::now();
+		for(int i=0; i < shapeCount; i++) {
+			broadphase.Update(i, boxes[i]);
+		}
+		broadphase.FindPairs(pairs);
+		Clock::time_point pairStart = Clock::now();
+		for(int i=0; i < pairs.size(); i++) {
+			float penX, penY;
+			sink += CheckSATCollision(shapes[pairs[i].first].World(), shapes[pairs[i].second].World(), penX, penY) ? 1 : 0;
+		}
+		Clock::time_point mid = Clock::now();
+
+		//legacy: transform once for the bounds, then both shapes again (plus a copy) for every pair
+		for(int i=0; i < shapeCount; i++) {
+			LegacyWorldCoordinates(worldA, triVertices, positions[i*2], positions[i*2+1], rotations[i], 1.0f);
+			legacyTransforms++;
+			AABB &box = boxes[i];
+			box.minX = box.maxX = worldA[0].first;
+			box.minY = box.maxY = worldA[0].second;
+			for(int j=1; j < worldA.size(); j++) {
+				box.minX = fmin(box.minX, worldA[j].first);
+				box.maxX = fmax(box.maxX, worldA[j].first);
+				box.minY = fmin(box.minY, worldA[j].second);
+				box.maxY = fmax(box.maxY, worldA[j].second);
+			}
+		}
+		for(int i=0; i < pairs.size(); i++) {
+			int a = pairs[i].first;
+			int b = pairs[i].second;
+			LegacyWorldCoordinates(worldA, triVertices, positions[a*2], positions[a*2+1], rotations[a], 1.0f);
+			LegacyWorldCoordinates(worldB, triVertices, positions[b*2], positions[b*2+1], rotations[b], 1.0f);
+			legacyTransforms += 2;
+			std::vector<std::pair<float,float>> othersPoints = worldB;
+			std::pair<float,float> penetration;
+			sink += CheckSATCollision(worldA, othersPoints, penetration) ? 1 : 0;
+		}
+		Clock::time_point end = Clock::now();
+
+		cachedSeconds += std::chrono::duration<double>((sorted - start) + (mid - pairStart)).count();
+		legacySeconds += std::chrono::duration<double>(end - mid).count();
+		pairTests += pairs.size();
+	}
+
+	long long cachedTransforms = -cachedBefore;
+	for(int i=0; i < shapeCount; i++) {
+		cachedTransforms += shapes[i].TransformCount();
+	}
+	printf("Transform cache benchmark: %d triangles, %d frames, %.1f pair tests / frame (checksum %d)\n", shapeCount, frames, (double)pairTests / frames, sink);
+	printf("  transforms / frame : %10.1f per pair test, %10.1f cached\n", (double)legacyTransforms / frames, (double)cachedTransforms / frames);
+	printf("  ms / frame         : %10.3f per pair test, %10.3f cached\n", 1000.0 * legacySeconds / frames, 1000.0 * cachedSeconds / frames);
+	return 0;
+}
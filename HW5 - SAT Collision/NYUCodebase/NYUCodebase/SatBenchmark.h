@@ -0,0 +1,60 @@
+
+#pragma once
+#include <vector>
+#include "SatCollision.h"
+
+//SceneShape - rotating convex shape used by the generated benchmark scenes
+struct SceneShape {
+	SATPolygon local; //model space vertices
+	SATPolygon world; //world space vertices, refreshed by StepScene
+	float position[2];
+	float velocity[2];
+	float rotation;
+	float spin; //radians per second
+	float scale;
+};
+
+/* GenerateScene()
+	\description - Scatters rotating convex polygons (3 to SAT_MAX_POINTS sides) over a square world sized to keep the density fixed
+	\param shapes - output list, cleared before writing
+	\param count  - number of shapes to generate
+	\param seed   - seed for the generator so runs are repeatable
+	\return       - side length of the generated world
+*/
+float GenerateScene(std::vector<SceneShape> &shapes, int count, unsigned int seed);
+
+/* StepScene()
+	\description    - Moves and rotates every shape, bounces them off the world edges and recomputes their world vertices
+	\param shapes   - scene to update
+	\param elapsed  - seconds to advance
+	\param worldSize - side length returned by GenerateScene
+*/
+void StepScene(std::vector<SceneShape> &shapes, float elapsed, float worldSize);
+
+/* RunSATBenchmark()
+	\description - Times the SAT kernel against the original vector/sort implementation and prints polygon pair tests per second
+	\param pairs - number of polygon pairs to generate
+	\param runs  - number of passes over the pair list
+*/
+int RunSATBenchmark(int pairs = 100000, int runs = 20);
+
+/* RunBroadphaseBenchmark()
+	\description - Steps a generated scene through the sweep and prune broadphase and prints pairs culled versus narrowphase calls
+	\param shapeCount - number of shapes in the scene
+	\param frames     - number of frames to simulate
+*/
+int RunBroadphaseBenchmark(int shapeCount, int frames);
+
+/* RunCoherenceBenchmark()
+	\description - Runs the broadphase pairs of a generated scene through the per pair axis cache and prints its hit rate and axes tested per pair
+	\param shapeCount - number of shapes in the scene
+	\param frames     - number of frames to simulate
+*/
+int RunCoherenceBenchmark(int shapeCount, int frames);
+
+/* RunTransformCacheBenchmark()
+	\description - Compares recomputing world vertices for every pair test against the cached TransformedPolygon vertices
+	\param shapeCount - number of triangles in the scene
+	\param frames     - number of frames to simulate
+*/
+int RunTransformCacheBenchmark(int shapeCount, int frames);
@@ -1,126 +1,266 @@
 #include "SatCollision.h"
 #include <math.h>
-#include <algorithm>
-
-bool TestSATSeparationForEdge(float edgeX, float edgeY, const std::vector<std::pair<float,float>> &points1, const std::vector<std::pair<float,float>> &points2, std::pair<float,float> &penetration) {
-	float normalX = -edgeY;
-	float normalY = edgeX;
-	float len = sqrtf(normalX*normalX + normalY*normalY);
-	normalX /= len;
-	normalY /= len;
-	
-	std::vector<float> e1Projected;
-	std::vector<float> e2Projected;
-	
-	for(int i=0; i < points1.size(); i++) {
-		e1Projected.push_back(points1[i].first * normalX + points1[i].second * normalY);
-	}
-	for(int i=0; i < points2.size(); i++) {
-		e2Projected.push_back(points2[i].first * normalX + points2[i].second * normalY);
-	}
-	
-	std::sort(e1Projected.begin(), e1Projected.end());
-	std::sort(e2Projected.begin(), e2Projected.end());
-	
-	float e1Min = e1Projected[0];
-	float e1Max = e1Projected[e1Projected.size()-1];
-	float e2Min = e2Projected[0];
-	float e2Max = e2Projected[e2Projected.size()-1];
-	
-	float e1Width = fabs(e1Max-e1Min);
-	float e2Width = fabs(e2Max-e2Min);
-	float e1Center = e1Min + (e1Width/2.0);
-	float e2Center = e2Min + (e2Width/2.0);
-	float dist = fabs(e1Center-e2Center);
-	float p = dist - ((e1Width+e2Width)/2.0);
-	
-	if(p >= 0) {
-		return false;
+#include <float.h>
+#include <assert.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SAT_USE_SSE
+	#include <emmintrin.h>
+#endif
+
+void SetSATPoint(SATPolygon &poly, int index, float x, float y) {
+	assert(index >= 0 && index < SAT_MAX_POINTS);
+	if(index < 0 || index >= SAT_MAX_POINTS) { //the polygon cannot hold it, callers with bigger polygons use the vector version
+		return;
+	}
+	for(int i=index; i < SAT_MAX_POINTS; i++) { //unused lanes repeat the last vertex so they never change the min/max
+		poly.x[i] = x;
+		poly.y[i] = y;
+	}
+	poly.count = index + 1;
+}
+
+#ifdef SAT_USE_SSE
+static inline float HorizontalMin(__m128 v) {
+	v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+	v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+	return _mm_cvtss_f32(v);
+}
+
+static inline float HorizontalMax(__m128 v) {
+	v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+	v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+	return _mm_cvtss_f32(v);
+}
+#endif
+
+//Projects every vertex onto (normalX, normalY) and returns the extents. The axis does not need to be normalized.
+static inline void ProjectPolygon(const SATPolygon &poly, float normalX, float normalY, float &projMin, float &projMax) {
+#ifdef SAT_USE_SSE
+	__m128 nx = _mm_set1_ps(normalX);
+	__m128 ny = _mm_set1_ps(normalY);
+	__m128 lo = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(poly.x), nx), _mm_mul_ps(_mm_loadu_ps(poly.y), ny));
+	__m128 mn = lo;
+	__m128 mx = lo;
+	if(poly.count > 4) {
+		__m128 hi = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(poly.x + 4), nx), _mm_mul_ps(_mm_loadu_ps(poly.y + 4), ny));
+		mn = _mm_min_ps(mn, hi);
+		mx = _mm_max_ps(mx, hi);
+	}
+	projMin = HorizontalMin(mn);
+	projMax = HorizontalMax(mx);
+#else
+	projMin = FLT_MAX;
+	projMax = -FLT_MAX;
+	for(int i=0; i < poly.count; i++) {
+		float p = poly.x[i] * normalX + poly.y[i] * normalY;
+		projMin = (p < projMin) ? p : projMin;
+		projMax = (p > projMax) ? p : projMax;
+	}
+#endif
+}
+
+//Projects both polygons on the normal of edge i of edgeSource. Returns false if the axis separates them, otherwise
+//writes the penetration on that axis. Penetration on an unnormalized axis n is amount/|n|, so its squared length is
+//amount^2/|n|^2 and no square root is needed. Degenerate edges are reported as overlapping with no penetration.
+static bool OverlapOnEdgeNormal(const SATPolygon &edgeSource, int i, const SATPolygon &e1, const SATPolygon &e2, float &penetrationSq, float &penX, float &penY) {
+	int next = (i == edgeSource.count-1) ? 0 : i+1;
+	float normalX = -(edgeSource.y[next] - edgeSource.y[i]);
+	float normalY = edgeSource.x[next] - edgeSource.x[i];
+	float lenSq = normalX*normalX + normalY*normalY;
+	if(lenSq <= 0.0f) {
+		penetrationSq = FLT_MAX;
+		return true;
 	}
-	
+
+	float e1Min, e1Max, e2Min, e2Max;
+	ProjectPolygon(e1, normalX, normalY, e1Min, e1Max);
+	ProjectPolygon(e2, normalX, normalY, e2Min, e2Max);
+
 	float penetrationMin1 = e1Max - e2Min;
 	float penetrationMin2 = e2Max - e1Min;
-	
-	float penetrationAmount = penetrationMin1;
-	if(penetrationMin2 < penetrationAmount) {
-		penetrationAmount = penetrationMin2;
-	}
-	
-	penetration.first = normalX * penetrationAmount;
-	penetration.second = normalY * penetrationAmount;
-	
+	float penetrationAmount = (penetrationMin2 < penetrationMin1) ? penetrationMin2 : penetrationMin1;
+	if(penetrationAmount <= 0.0f) {
+		return false;
+	}
+	float scale = penetrationAmount / lenSq;
+	penetrationSq = penetrationAmount * scale;
+	penX = normalX * scale;
+	penY = normalY * scale;
+	return true;
+}
+
+//Full SAT over the edge normals of both polygons. axis receives the separating axis if there is one, otherwise the
+//axis of minimum penetration. skip is an edge the caller already found overlapping (polygon -1 for none), it is not
+//projected again and its penetration starts off as the best.
+static bool RunSAT(const SATPolygon &e1, const SATPolygon &e2, float &penX, float &penY, SATAxisCache &axis, int &axesTested,
+	const SATAxisCache &skip, float skipSq, float skipX, float skipY) {
+	const SATPolygon *sources[2] = { &e1, &e2 };
+	float bestSq = FLT_MAX;
+	float bestX = 0.0f;
+	float bestY = 0.0f;
+	if(skip.polygon != -1 && skipSq < bestSq) {
+		bestSq = skipSq;
+		bestX = skipX;
+		bestY = skipY;
+		axis.polygon = skip.polygon;
+		axis.edge = skip.edge;
+	}
+	for(int polygon=0; polygon < 2; polygon++) {
+		for(int i=0; i < sources[polygon]->count; i++) {
+			if(polygon == skip.polygon && i == skip.edge) {
+				continue;
+			}
+			float penetrationSq, x, y;
+			axesTested++;
+			if(!OverlapOnEdgeNormal(*sources[polygon], i, e1, e2, penetrationSq, x, y)) {
+				axis.polygon = polygon;
+				axis.edge = i;
+				axis.separating = true;
+				return false;
+			}
+			if(penetrationSq < bestSq) {
+				bestSq = penetrationSq;
+				bestX = x;
+				bestY = y;
+				axis.polygon = polygon;
+				axis.edge = i;
+			}
+		}
+	}
+	if(bestSq == FLT_MAX) { //every edge was degenerate
+		axis.polygon = -1;
+		return false;
+	}
+	axis.separating = false;
+
+	float e1CenterX = 0.0f, e1CenterY = 0.0f;
+	for(int i=0; i < e1.count; i++) {
+		e1CenterX += e1.x[i];
+		e1CenterY += e1.y[i];
+	}
+	float e2CenterX = 0.0f, e2CenterY = 0.0f;
+	for(int i=0; i < e2.count; i++) {
+		e2CenterX += e2.x[i];
+		e2CenterY += e2.y[i];
+	}
+	float baX = e1CenterX / (float)e1.count - e2CenterX / (float)e2.count;
+	float baY = e1CenterY / (float)e1.count - e2CenterY / (float)e2.count;
+
+	if(bestX * baX + bestY * baY < 0.0f) {
+		bestX *= -1.0f;
+		bestY *= -1.0f;
+	}
+	penX = bestX;
+	penY = bestY;
 	return true;
 }
 
-bool PenetrationSort(const std::pair<float,float> &p1, const std::pair<float,float> &p2) {
-	return sqrtf(p1.first*p1.first + p1.second*p1.second) < sqrtf(p2.first*p2.first + p2.second*p2.second);
+bool CheckSATCollision(const SATPolygon &e1, const SATPolygon &e2, float &penX, float &penY) {
+	SATAxisCache axis;
+	SATAxisCache none;
+	int axesTested = 0;
+	return RunSAT(e1, e2, penX, penY, axis, axesTested, none, FLT_MAX, 0.0f, 0.0f);
 }
 
-bool CheckSATCollision(const std::vector<std::pair<float,float>> &e1Points, const std::vector<std::pair<float,float>> &e2Points, std::pair<float,float> &penetration) {
-	std::vector<std::pair<float,float>> penetrations;
-	for(int i=0; i < e1Points.size(); i++) {
-		float edgeX, edgeY;
-		
-		if(i == e1Points.size()-1) {
-			edgeX = e1Points[0].first - e1Points[i].first;
-			edgeY = e1Points[0].second - e1Points[i].second;
-		} else {
-			edgeX = e1Points[i+1].first - e1Points[i].first;
-			edgeY = e1Points[i+1].second - e1Points[i].second;
-		}
-		std::pair<float,float> penetration;
-		bool result = TestSATSeparationForEdge(edgeX, edgeY, e1Points, e2Points, penetration);
-		if(!result) {
-			return false;
-		}
-		penetrations.push_back(penetration);
-	}
-	for(int i=0; i < e2Points.size(); i++) {
-		float edgeX, edgeY;
-		
-		if(i == e2Points.size()-1) {
-			edgeX = e2Points[0].first - e2Points[i].first;
-			edgeY = e2Points[0].second - e2Points[i].second;
-		} else {
-			edgeX = e2Points[i+1].first - e2Points[i].first;
-			edgeY = e2Points[i+1].second - e2Points[i].second;
+bool CheckSATCollision(const SATPolygon &e1, const SATPolygon &e2, float &penX, float &penY, SATAxisCache &cache, int &axesTested) {
+	axesTested = 0;
+	//an overlapping pair usually still overlaps, so its penetration axis is only remembered, not pre-tested
+	SATAxisCache tested;
+	float testedSq = FLT_MAX, testedX = 0.0f, testedY = 0.0f;
+	if(cache.separating && (cache.polygon == 0 || cache.polygon == 1)) {
+		const SATPolygon &source = (cache.polygon == 0) ? e1 : e2;
+		if(cache.edge < source.count) {
+			axesTested++;
+			if(!OverlapOnEdgeNormal(source, cache.edge, e1, e2, testedSq, testedX, testedY)) {
+				return false; //last frame's axis still separates, no need for the rest
+			}
+			tested = cache; //it overlaps now, so the full pass starts from its penetration instead of projecting it again
 		}
-		std::pair<float,float> penetration;
-		bool result = TestSATSeparationForEdge(edgeX, edgeY, e1Points, e2Points, penetration);
-		
-		if(!result) {
-			return false;
+	}
+	return RunSAT(e1, e2, penX, penY, cache, axesTested, tested, testedSq, testedX, testedY);
+}
+
+//Projects a polygon of any size onto (normalX, normalY), for polygons too big for a SATPolygon
+static void ProjectPoints(const std::vector<std::pair<float,float>> &points, float normalX, float normalY, float &projMin, float &projMax) {
+	projMin = FLT_MAX;
+	projMax = -FLT_MAX;
+	for(size_t i=0; i < points.size(); i++) {
+		float p = points[i].first * normalX + points[i].second * normalY;
+		projMin = (p < projMin) ? p : projMin;
+		projMax = (p > projMax) ? p : projMax;
+	}
+}
+
+//Scalar SAT straight on the vertex lists, the same test as RunSAT for polygons with more than SAT_MAX_POINTS vertices
+static bool CheckLargeSATCollision(const std::vector<std::pair<float,float>> &e1Points, const std::vector<std::pair<float,float>> &e2Points, std::pair<float,float> &penetration) {
+	const std::vector<std::pair<float,float>> *sources[2] = { &e1Points, &e2Points };
+	float bestSq = FLT_MAX;
+	float bestX = 0.0f;
+	float bestY = 0.0f;
+	for(int polygon=0; polygon < 2; polygon++) {
+		const std::vector<std::pair<float,float>> &points = *sources[polygon];
+		for(size_t i=0; i < points.size(); i++) {
+			size_t next = (i == points.size()-1) ? 0 : i+1;
+			float normalX = -(points[next].second - points[i].second);
+			float normalY = points[next].first - points[i].first;
+			float lenSq = normalX*normalX + normalY*normalY;
+			if(lenSq <= 0.0f) {
+				continue;
+			}
+			float e1Min, e1Max, e2Min, e2Max;
+			ProjectPoints(e1Points, normalX, normalY, e1Min, e1Max);
+			ProjectPoints(e2Points, normalX, normalY, e2Min, e2Max);
+			float penetrationMin1 = e1Max - e2Min;
+			float penetrationMin2 = e2Max - e1Min;
+			float penetrationAmount = (penetrationMin2 < penetrationMin1) ? penetrationMin2 : penetrationMin1;
+			if(penetrationAmount <= 0.0f) {
+				return false;
+			}
+			float scale = penetrationAmount / lenSq;
+			if(penetrationAmount * scale < bestSq) {
+				bestSq = penetrationAmount * scale;
+				bestX = normalX * scale;
+				bestY = normalY * scale;
+			}
 		}
-		penetrations.push_back(penetration);
-	}
-	
-	std::sort(penetrations.begin(), penetrations.end(), PenetrationSort);
-	penetration = penetrations[0];
-	
-	std::pair<float,float> e1Center;
-	for(int i=0; i < e1Points.size(); i++) {
-		e1Center.first += e1Points[i].first;
-		e1Center.second += e1Points[i].second;
-	}
-	e1Center.first /= (float)e1Points.size();
-	e1Center.second /= (float)e1Points.size();
-	
-	std::pair<float,float> e2Center;
-	for(int i=0; i < e2Points.size(); i++) {
-		e2Center.first += e2Points[i].first;
-		e2Center.second += e2Points[i].second;
-	}
-	e2Center.first /= (float)e2Points.size();
-	e2Center.second /= (float)e2Points.size();
-
-	std::pair<float,float> ba;
-	ba.first = e1Center.first - e2Center.first;
-	ba.second = e1Center.second - e2Center.second;
-	
-	if( (penetration.first * ba.first) + (penetration.second * ba.second) < 0.0f) {
-		penetration.first *= -1.0f;
-		penetration.second *= -1.0f;
-	}
-	
+	}
+	if(bestSq == FLT_MAX) { //every edge was degenerate
+		return false;
+	}
+
+	float baX = 0.0f, baY = 0.0f;
+	for(size_t i=0; i < e1Points.size(); i++) {
+		baX += e1Points[i].first / (float)e1Points.size();
+		baY += e1Points[i].second / (float)e1Points.size();
+	}
+	for(size_t i=0; i < e2Points.size(); i++) {
+		baX -= e2Points[i].first / (float)e2Points.size();
+		baY -= e2Points[i].second / (float)e2Points.size();
+	}
+	if(bestX * baX + bestY * baY < 0.0f) {
+		bestX *= -1.0f;
+		bestY *= -1.0f;
+	}
+	penetration.first = bestX;
+	penetration.second = bestY;
 	return true;
 }
+
+bool CheckSATCollision(const std::vector<std::pair<float,float>> &e1Points, const std::vector<std::pair<float,float>> &e2Points, std::pair<float,float> &penetration) {
+	if(e1Points.empty() || e2Points.empty()) {
+		return false;
+	}
+	if(e1Points.size() > SAT_MAX_POINTS || e2Points.size() > SAT_MAX_POINTS) { //too big for the SIMD kernel
+		return CheckLargeSATCollision(e1Points, e2Points, penetration);
+	}
+	SATPolygon e1;
+	SATPolygon e2;
+	for(int i=0; i < (int)e1Points.size(); i++) {
+		SetSATPoint(e1, i, e1Points[i].first, e1Points[i].second);
+	}
+	for(int i=0; i < (int)e2Points.size(); i++) {
+		SetSATPoint(e2, i, e2Points[i].first, e2Points[i].second);
+	}
+	return CheckSATCollision(e1, e2, penetration.first, penetration.second);
+}
@@ -1,5 +1,51 @@
 
+#pragma once
 #include <vector>
 #include <utility>
 
+#define SAT_MAX_POINTS 8 //Max number of vertices a SATPolygon can hold (multiple of 4 so it fills whole SIMD lanes)
+
+//SATPolygon - fixed capacity, structure-of-arrays vertex span used by the SAT kernel (no heap allocation)
+struct SATPolygon {
+	float x[SAT_MAX_POINTS];
+	float y[SAT_MAX_POINTS];
+	int count;
+};
+
+//SATAxisCache - remembers which edge normal separated (or least penetrated) a pair so it can be tried first next frame.
+//Bytes rather than ints (edge is below SAT_MAX_POINTS), so a contact cache slot stays small.
+struct SATAxisCache {
+	signed char polygon = -1; //0 for the first polygon, 1 for the second, -1 if nothing is cached
+	unsigned char edge = 0;
+	bool separating = false; //false when the pair was overlapping and edge is the minimum penetration axis
+};
+
+/* SetSATPoint()
+	\description - Writes a vertex into the polygon and pads the unused lanes with it so min/max projections stay correct
+	\param poly  - polygon being filled
+	\param index - vertex index (must be < SAT_MAX_POINTS)
+	\param x     - world x coordinate
+	\param y     - world y coordinate
+*/
+void SetSATPoint(SATPolygon &poly, int index, float x, float y);
+
+/* CheckSATCollision()
+	\description   - Separating axis test between two convex polygons
+	\param e1      - first polygon
+	\param e2      - second polygon
+	\param penX    - x component of the minimum translation vector (points from e2 towards e1)
+	\param penY    - y component of the minimum translation vector
+*/
+bool CheckSATCollision(const SATPolygon &e1, const SATPolygon &e2, float &penX, float &penY);
+
+/* CheckSATCollision()
+	\description      - Same test, but tries the axis stored in cache before running the full SAT and updates the cache
+	\param cache      - axis remembered for this pair of polygons (always pass them in the same order)
+	\param axesTested - number of edge normals that were projected
+*/
+bool CheckSATCollision(const SATPolygon &e1, const SATPolygon &e2, float &penX, float &penY, SATAxisCache &cache, int &axesTested);
+
+/* CheckSATCollision()
+	\description - Same test on vertex lists of any size, polygons with more than SAT_MAX_POINTS vertices take a scalar path
+*/
 bool CheckSATCollision(const std::vector<std::pair<float,float>> &e1Points, const std::vector<std::pair<float,float>> &e2Points, std::pair<float,float> &penetration);
@@ -0,0 +1,47 @@
+#include "TransformedPolygon.h"
+#include <math.h>
+
+TransformedPolygon::TransformedPolygon() : rotation(0), scale(1), dirty(true), transforms(0) {
+	translation[0] = 0;
+	translation[1] = 0;
+	local.count = 0;
+	world.count = 0;
+}
+
+void TransformedPolygon::SetLocalPoint(int index, float x, float y) {
+	SetSATPoint(local, index, x, y);
+	dirty = true;
+}
+
+void TransformedPolygon::SetTransform(float x, float y, float rotate, float size) {
+	if (x == translation[0] && y == translation[1] && rotate == rotation && size == scale) {
+		return;
+	}
+	translation[0] = x;
+	translation[1] = y;
+	rotation = rotate;
+	scale = size;
+	dirty = true;
+}
+
+const SATPolygon& TransformedPolygon::World() {
+	if (dirty) {
+		//Same order as the model matrix (Scale * Rotate * Translate), so the polygon lines up with what is drawn
+		float c = cos(rotation) * scale;
+		float s = sin(rotation) * scale;
+		float Tx = translation[0];
+		float Ty = translation[1];
+		for (int i = 0; i < local.count; i++) {
+			float X = local.x[i] + Tx;
+			float Y = local.y[i] + Ty;
+			SetSATPoint(world, i, X * c - Y * s, X * s + Y * c);
+		}
+		dirty = false;
+		transforms++;
+	}
+	return world;
+}
+
+int TransformedPolygon::TransformCount() const {
+	return transforms;
+}
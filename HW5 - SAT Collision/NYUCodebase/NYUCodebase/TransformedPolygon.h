@@ -0,0 +1,43 @@
+
+#pragma once
+#include "SatCollision.h"
+
+//TransformedPolygon - Model space polygon plus a world space copy that is only recomputed after the position,
+//rotation or scale changed. Every pair test reads the same cached vertices, so a shape is transformed at most once
+//per frame no matter how many pairs it is part of.
+class TransformedPolygon {
+public:
+	TransformedPolygon();
+
+	/* SetLocalPoint()
+		\description - Sets a model space vertex (write them in order, starting at 0)
+		\param index - vertex index
+		\param x     - model x coordinate
+		\param y     - model y coordinate
+	*/
+	void SetLocalPoint(int index, float x, float y);
+
+	/* SetTransform()
+		\description  - Updates the transform, marking the world vertices dirty only if something actually changed
+		\param x      - x translation
+		\param y      - y translation
+		\param rotate - rotation in radians
+		\param size   - uniform scale
+	*/
+	void SetTransform(float x, float y, float rotate, float size);
+
+	/* World()
+		\description - Returns the world space vertices, recomputing them first if the transform changed
+	*/
+	const SATPolygon& World();
+
+	int TransformCount() const; //number of times the world vertices were recomputed
+private:
+	SATPolygon local;
+	SATPolygon world;
+	float translation[2];
+	float rotation;
+	float scale;
+	bool dirty;
+	int transforms;
+};
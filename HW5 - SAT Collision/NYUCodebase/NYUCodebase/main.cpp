@@ -6,9 +6,13 @@
 #include <SDL_image.h>
 #include <vector>
 #include <math.h>
+#include <string.h>
 #include "ShaderProgram.h"
 #include "Matrix.h"
 #include "SatCollision.h"
+#include "SatBenchmark.h"
+#include "Broadphase.h"
+#include "TransformedPolygon.h"
 #ifdef _WINDOWS
 	#define RESOURCE_FOLDER ""
 #else
@@ -36,6 +40,10 @@ public:
 		TriVertices[3] = 0.5f;
 		TriVertices[4] = -0.5f;
 		TriVertices[5] = -0.5f;
+		for (int i = 0; i < 3; i++) {
+			shape.SetLocalPoint(i, TriVertices[i * 2], TriVertices[i * 2 + 1]);
+		}
+		shape.SetTransform(position[0], position[1], rotation, scale);
 	}
 	void Update(float elapsed) {
 		for (int i = 0; i < 3; i++) {
@@ -45,6 +53,7 @@ public:
 		modelMatrix.Scale(scale, scale, 1);
 		modelMatrix.Rotate(rotation);
 		modelMatrix.Translate(position[0], position[1], position[2]);
+		shape.SetTransform(position[0], position[1], rotation, scale); //world vertices are recomputed lazily, only if we moved
 	}
 	void Draw() {
 		program->SetModelMatrix(modelMatrix);
@@ -54,11 +63,8 @@ public:
 		glDisableVertexAttribArray(program->positionAttribute);
 	}
 	bool Collision(Triangle& other) {
-		computeWorldCoordinate();
-		other.computeWorldCoordinate();
 		pair<float, float> penetration;
-		vector<pair<float, float>> othersPoints = other.world;
-		bool collided = CheckSATCollision(world, othersPoints, penetration);
+		bool collided = CheckSATCollision(shape.World(), other.shape.World(), penetration.first, penetration.second); //SATContactCache is slower here, see RunCoherenceBenchmark
 		if (collided) {
 			for (int i = 0; i < 2; i++) {
 				if (velocity[i] == 0 || other.velocity[i] == 0) {}
@@ -75,10 +81,14 @@ public:
 			position[1] -= penetration.second * 0.5f;
 			other.position[0] += penetration.first * 0.5f;
 			other.position[1] += penetration.second * 0.5f;
-
+			shape.SetTransform(position[0], position[1], rotation, scale);
+			other.shape.SetTransform(other.position[0], other.position[1], other.rotation, other.scale);
 		}
 		return collided;
 	}
+	AABB GetBounds() {
+		return ComputeAABB(shape.World());
+	}
 private:
 	float position[3];
 	float rotation;
@@ -87,26 +97,20 @@ private:
 	float velocity[3];
 	float TriVertices[6];
 	ShaderProgram* program;
-	vector<pair<float, float>> world;
-	void computeWorldCoordinate() {
-		float Sx = scale;
-		float Sy = scale;
-		float c = cos(rotation); //cos
-		float s = sin(rotation); //sin
-		float Tx = position[0];
-		float Ty = position[1];
-		world.clear();
-		for (int i = 0; i < 6; i+=2) {
-			float X = TriVertices[i+0];
-			float Y = TriVertices[i+1];
-			float worldX = Sx * X * c - Sx * Y * s + Sx * Tx*c - Sx * Ty*s;
-			float worldY = Sy * X * s + Sy * Y * c + Sy * Tx*s + Sy * Ty*c;
-			world.push_back(make_pair(worldX, worldY));
-		}
-	}
+	TransformedPolygon shape; //cached world space vertices used for collisions
 };
 int main(int argc, char *argv[])
 {
+	if (argc > 1 && strcmp(argv[1], "--bench") == 0) { //run the collision benchmarks without opening a window
+		int result = RunSATBenchmark();
+		RunBroadphaseBenchmark(1000, 300);
+		RunBroadphaseBenchmark(10000, 100);
+		RunCoherenceBenchmark(1000, 300);
+		RunCoherenceBenchmark(10000, 100);
+		RunTransformCacheBenchmark(1000, 300);
+		RunTransformCacheBenchmark(10000, 100);
+		return result;
+	}
 	SDL_Init(SDL_INIT_VIDEO);
 	displayWindow = SDL_CreateWindow("My Game", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 640, 360, SDL_WINDOW_OPENGL);
 	SDL_GLContext context = SDL_GL_CreateContext(displayWindow);
@@ -128,6 +132,12 @@ int main(int argc, char *argv[])
 	pos[0] = 2;
 	pos[1] = -1;
 	Triangle e3(pos, 0, 0.5, 0.001f, 0, program);
+	vector<Triangle*> triangles = { &e1, &e2, &e3 };
+	SweepAndPrune broadphase;
+	for (Triangle* triangle : triangles) {
+		broadphase.Add(triangle->GetBounds());
+	}
+	vector<pair<int, int>> pairs;
 	projectionMatrix.SetOrthoProjection(-3.55, 3.55, -2.0f, 2.0f, -1.0f, 1.0f);
 	glUseProgram(program.programID);
 	SDL_Event event;
@@ -145,15 +155,17 @@ int main(int argc, char *argv[])
 		glClear(GL_COLOR_BUFFER_BIT);
 		program.SetProjectionMatrix(projectionMatrix);
 		program.SetViewMatrix(viewMatrix);
-		e1.Update(elapsed);
-		e2.Update(elapsed);
-		e3.Update(elapsed);
-		e1.Collision(e2);
-		e2.Collision(e3);
-		e3.Collision(e1);
-		e1.Draw();
-		e2.Draw();
-		e3.Draw();
+		for (int i = 0; i < triangles.size(); i++) {
+			triangles[i]->Update(elapsed);
+			broadphase.Update(i, triangles[i]->GetBounds());
+		}
+		broadphase.FindPairs(pairs); //only pairs whose bounding boxes overlap go through SAT
+		for (pair<int, int> p : pairs) {
+			triangles[p.first]->Collision(*triangles[p.second]);
+		}
+		for (Triangle* triangle : triangles) {
+			triangle->Draw();
+		}
 		SDL_GL_SwapWindow(displayWindow);
 	}
 
@@ -0,0 +1,247 @@
+#include "AssetPack.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifdef _WINDOWS
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+using namespace std;
+
+AssetPack assetPack;
+
+//AssetPackHeader - start of a pack, followed by count AssetPackEntry records and then namesSize bytes of names
+struct AssetPackHeader {
+	char magic[4]; //"NYPK"
+	unsigned int version;
+	unsigned int count;
+	unsigned int namesSize;
+};
+
+//AssetPackEntry - one file in the index
+struct AssetPackEntry {
+	unsigned int nameOffset; //into the names, which follow the index
+	unsigned int nameLength;
+	unsigned long long offset; //from the start of the pack
+	unsigned long long size;
+};
+
+void* MapFile(const char* path, size_t& size) {
+	void* mapping = nullptr;
+	size = 0;
+#ifdef _WINDOWS
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		return nullptr;
+	}
+	LARGE_INTEGER fileSize;
+	if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+		size = (size_t)fileSize.QuadPart;
+		HANDLE view = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (view != NULL) {
+			mapping = MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(view); //the view keeps the mapping alive
+		}
+	}
+	CloseHandle(file);
+#else
+	int file = open(path, O_RDONLY);
+	if (file < 0) {
+		return nullptr;
+	}
+	struct stat info;
+	if (fstat(file, &info) == 0 && info.st_size > 0) {
+		size = (size_t)info.st_size;
+		mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (mapping == MAP_FAILED) {
+			mapping = nullptr;
+		}
+	}
+	close(file);
+#endif
+	return mapping;
+}
+
+void UnmapFile(void* mapping, size_t size) {
+#ifdef _WINDOWS
+	UnmapViewOfFile(mapping);
+#else
+	munmap(mapping, size);
+#endif
+}
+
+//The file name part of a path
+static const char* FileName(const char* path) {
+	const char* name = path;
+	for (const char* c = path; *c != '\0'; c++) {
+		if (*c == '/' || *c == '\\') {
+			name = c + 1;
+		}
+	}
+	return name;
+}
+
+static int CompareNames(const char* a, size_t aLength, const char* b, size_t bLength) {
+	int order = memcmp(a, b, aLength < bLength ? aLength : bLength);
+	if (order != 0) {
+		return order;
+	}
+	return aLength < bLength ? -1 : (aLength > bLength ? 1 : 0);
+}
+
+AssetPack::AssetPack() : mapping(nullptr), size(0), entries(nullptr), names(nullptr), count(0), modified(0) {}
+
+AssetPack::~AssetPack() {
+	Close();
+}
+
+bool AssetPack::Open(const char* path) {
+	Close();
+	mapping = MapFile(path, size);
+	if (mapping == nullptr) {
+		return false;
+	}
+	const AssetPackHeader* header = (const AssetPackHeader*)mapping;
+	bool valid = size >= sizeof(AssetPackHeader) && memcmp(header->magic, "NYPK", 4) == 0 && header->version == ASSET_PACK_VERSION;
+	size_t indexEnd = valid ? sizeof(AssetPackHeader) + (size_t)header->count * sizeof(AssetPackEntry) : 0;
+	valid = valid && indexEnd + header->namesSize <= size;
+	if (valid) {
+		entries = (const AssetPackEntry*)((const char*)mapping + sizeof(AssetPackHeader));
+		names = (const char*)mapping + indexEnd;
+		for (unsigned int i = 0; i < header->count && valid; i++) {
+			valid = (unsigned long long)entries[i].nameOffset + entries[i].nameLength <= header->namesSize &&
+				entries[i].offset <= size && entries[i].size <= size - entries[i].offset;
+		}
+	}
+	if (!valid) {
+		fprintf(stderr, "%s is not an asset pack of version %d, loading loose files\n", path, ASSET_PACK_VERSION);
+		Close();
+		return false;
+	}
+	count = header->count;
+	struct stat info;
+	modified = (stat(path, &info) == 0) ? (long long)info.st_mtime : 0;
+	return true;
+}
+
+void AssetPack::Close() {
+	if (mapping != nullptr) {
+		UnmapFile(mapping, size);
+	}
+	mapping = nullptr;
+	size = 0;
+	entries = nullptr;
+	names = nullptr;
+	count = 0;
+	modified = 0;
+}
+
+AssetSpan AssetPack::Find(const char* path) const {
+	AssetSpan span = { nullptr, 0 };
+	const char* name = FileName(path);
+	size_t nameLength = strlen(name);
+	int low = 0;
+	int high = count - 1;
+	while (low <= high) {
+		int middle = (low + high) / 2;
+		int order = CompareNames(names + entries[middle].nameOffset, entries[middle].nameLength, name, nameLength);
+		if (order == 0) {
+			span.data = (const unsigned char*)mapping + entries[middle].offset;
+			span.size = (size_t)entries[middle].size;
+			return span;
+		}
+		if (order < 0) {
+			low = middle + 1;
+		}
+		else {
+			high = middle - 1;
+		}
+	}
+	return span;
+}
+
+int AssetPack::Entries() const {
+	return count;
+}
+
+long long AssetPack::Modified() const {
+	return modified;
+}
+
+int WriteAssetPack(const char* packPath, int count, char* files[]) {
+	vector<int> order;
+	for (int i = 0; i < count; i++) {
+		order.push_back(i);
+	}
+	sort(order.begin(), order.end(), [files](int a, int b) { return strcmp(FileName(files[a]), FileName(files[b])) < 0; });
+
+	vector<AssetPackEntry> entries(count);
+	string names;
+	vector<vector<unsigned char>> contents(count);
+	for (int i = 0; i < count; i++) {
+		const char* path = files[order[i]];
+		const char* name = FileName(path);
+		if (i > 0 && strcmp(name, FileName(files[order[i - 1]])) == 0) {
+			fprintf(stderr, "%s is in the pack twice, packed files need different names\n", name);
+			return 1;
+		}
+		FILE* file = fopen(path, "rb");
+		if (file == nullptr) {
+			fprintf(stderr, "cannot open %s\n", path);
+			return 1;
+		}
+		unsigned char buffer[65536];
+		size_t read;
+		while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+			contents[i].insert(contents[i].end(), buffer, buffer + read);
+		}
+		fclose(file);
+		entries[i].nameOffset = names.size();
+		entries[i].nameLength = strlen(name);
+		entries[i].size = contents[i].size();
+		names += name;
+	}
+
+	AssetPackHeader header;
+	memcpy(header.magic, "NYPK", 4);
+	header.version = ASSET_PACK_VERSION;
+	header.count = count;
+	header.namesSize = names.size();
+	unsigned long long offset = sizeof(header) + count * sizeof(AssetPackEntry) + names.size();
+	for (int i = 0; i < count; i++) {
+		offset = (offset + ASSET_PACK_ALIGNMENT - 1) & ~(unsigned long long)(ASSET_PACK_ALIGNMENT - 1);
+		entries[i].offset = offset;
+		offset += entries[i].size;
+	}
+
+	FILE* pack = fopen(packPath, "wb");
+	if (pack == nullptr) {
+		fprintf(stderr, "cannot write %s\n", packPath);
+		return 1;
+	}
+	bool written = fwrite(&header, sizeof(header), 1, pack) == 1 &&
+		(count == 0 || fwrite(entries.data(), sizeof(AssetPackEntry), count, pack) == (size_t)count) &&
+		fwrite(names.data(), 1, names.size(), pack) == names.size();
+	unsigned long long position = sizeof(header) + count * sizeof(AssetPackEntry) + names.size();
+	const char zeros[ASSET_PACK_ALIGNMENT] = { 0 };
+	for (int i = 0; i < count && written; i++) {
+		written = fwrite(zeros, 1, entries[i].offset - position, pack) == entries[i].offset - position &&
+			fwrite(contents[i].data(), 1, contents[i].size(), pack) == contents[i].size();
+		position = entries[i].offset + entries[i].size;
+	}
+	written = (fclose(pack) == 0) && written;
+	if (!written) {
+		fprintf(stderr, "writing %s failed\n", packPath);
+		remove(packPath);
+		return 1;
+	}
+	printf("packed %d files into %s, %llu bytes\n", count, packPath, position);
+	return 0;
+}
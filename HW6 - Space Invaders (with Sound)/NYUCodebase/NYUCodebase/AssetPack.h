@@ -0,0 +1,74 @@
+
+#pragma once
+
+#include <stddef.h>
+
+#define ASSET_PACK_FILE "assets.pack" //looked for in the resource folder, loose files are used when it is missing
+#define ASSET_PACK_VERSION 1
+#define ASSET_PACK_ALIGNMENT 16 //every file's data starts on a multiple of this
+
+//AssetSpan - a file's bytes inside the mapped pack, valid for as long as the pack stays open. data is NULL if the file is not packed
+struct AssetSpan {
+	const unsigned char* data;
+	size_t size;
+};
+
+/* MapFile()
+	\description - Maps a whole file read-only (mmap, or MapViewOfFile on Windows)
+	\param path  - file to map
+	\param size  - set to the file's size
+	\return      - the mapping, NULL if the file could not be opened or is empty
+*/
+void* MapFile(const char* path, size_t& size);
+
+/* UnmapFile()
+	\description - Unmaps a file mapped by MapFile
+*/
+void UnmapFile(void* mapping, size_t size);
+
+struct AssetPackEntry;
+
+//AssetPack - every asset of a game in one file: a header, an index sorted by file name, the names and then the files' data.
+//The pack is mapped once and files are handed out as spans into the mapping, so nothing is copied or opened again.
+//The pack is flat: files are found by their name without the directory.
+class AssetPack {
+public:
+	AssetPack();
+	~AssetPack();
+
+	/* Open()
+		\description - Maps a pack written by WriteAssetPack and checks its index
+		\param path  - pack file
+		\return      - false if it is missing or damaged, Find then finds nothing
+	*/
+	bool Open(const char* path);
+
+	void Close();
+
+	/* Find()
+		\description - Looks a file up by name (binary search of the index)
+		\param path  - path the game would have opened, its directory is ignored
+	*/
+	AssetSpan Find(const char* path) const;
+
+	int Entries() const;
+	long long Modified() const; //modification time of the pack file, so caches built from its files notice a new pack
+private:
+	void* mapping;
+	size_t size;
+	const AssetPackEntry* entries; //the index
+	const char* names;
+	int count;
+	long long modified;
+};
+
+extern AssetPack assetPack;
+
+/* WriteAssetPack()
+	\description    - The packing tool: writes files into a pack, sorted by name
+	\param packPath - pack to write
+	\param count    - number of files
+	\param files    - paths of the files, their names (without directories) must all differ
+	\return         - 0 on success, 1 on failure (reported on stderr)
+*/
+int WriteAssetPack(const char* packPath, int count, char* files[]);
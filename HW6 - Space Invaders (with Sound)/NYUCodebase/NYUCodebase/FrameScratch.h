@@ -0,0 +1,84 @@
+
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+#define FRAME_SCRATCH_BYTES (256 * 1024) //size of each of the two buffers
+
+//FrameScratch - double-buffered linear allocator for data that is only needed while a frame is drawn.
+//The buffer being filled is reset when the frame after next starts, so anything taken during a frame stays valid
+//through the following one. Only the thread that draws may use it.
+class FrameScratch {
+public:
+	/* FrameScratch()
+		\description    - Constructor, reserves both buffers up front
+		\param capacity - size of each buffer in bytes
+	*/
+	FrameScratch(size_t capacity);
+	~FrameScratch();
+
+	/* BeginFrame()
+		\description - Switches to the other buffer and empties it, call once at the start of every frame
+	*/
+	void BeginFrame();
+
+	/* Allocate()
+		\description     - Takes size bytes from the current buffer, or from the heap if it is full (counted in Overflows)
+		\param size      - bytes needed
+		\param alignment - alignment needed, a power of two
+	*/
+	void* Allocate(size_t size, size_t alignment);
+
+	/* Deallocate()
+		\description - Gives the memory back if it was the last allocation made (so scoped vectors are reused within a frame),
+		               anything else is only reclaimed when its buffer is reset
+	*/
+	void Deallocate(void* memory, size_t size);
+
+	size_t Capacity() const;
+	size_t FramePeak() const; //most bytes in use at once during the last finished frame
+	size_t Peak() const; //most bytes in use at once during any frame
+	int Overflows() const; //allocations that did not fit and came from the heap
+private:
+	char* buffers[2];
+	int current;
+	size_t capacity;
+	size_t used;
+	size_t framePeak; //of the frame being drawn
+	size_t lastFramePeak;
+	size_t peak;
+	int overflows;
+};
+
+extern FrameScratch frameScratch;
+
+//ScratchAllocator - STL allocator that takes its memory from frameScratch
+template <class T>
+struct ScratchAllocator {
+	typedef T value_type;
+
+	ScratchAllocator() {}
+	template <class U>
+	ScratchAllocator(const ScratchAllocator<U>&) {}
+
+	T* allocate(size_t count) {
+		return (T*)frameScratch.Allocate(count * sizeof(T), alignof(T));
+	}
+	void deallocate(T* memory, size_t count) {
+		frameScratch.Deallocate(memory, count * sizeof(T));
+	}
+};
+
+template <class T, class U>
+bool operator==(const ScratchAllocator<T>&, const ScratchAllocator<U>&) {
+	return true;
+}
+template <class T, class U>
+bool operator!=(const ScratchAllocator<T>&, const ScratchAllocator<U>&) {
+	return false;
+}
+
+//ScratchVector - vector for vertex data built during a frame, it must not outlive the frame after the one that made it
+template <class T>
+using ScratchVector = std::vector<T, ScratchAllocator<T>>;
@@ -0,0 +1,672 @@
+#include "PngDecoder.h"
+#include "stb_image.h"
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define PNG_USE_SSE
+	#include <emmintrin.h>
+#endif
+
+#define PNG_FAST_BITS 10 //Huffman codes up to this long are decoded with a single table lookup
+#define PNG_SLACK 16 //bytes past the end of a buffer that inflate's match copies and the 3 byte pixel loads may touch
+
+using namespace std;
+
+//Huffman - a canonical Huffman code, as inflate's blocks describe them
+struct Huffman {
+	unsigned short fast[1 << PNG_FAST_BITS]; //(length << 9) | symbol for every bit pattern that starts with a short code, 0 for longer codes
+	unsigned short firstCode[16];
+	unsigned short firstSymbol[16];
+	unsigned int maxCode[17]; //codes of each length, shifted to 16 bits, are below this
+	unsigned char lengths[288];
+	unsigned short symbols[288]; //in code order
+};
+
+//BitReader - the deflate stream, least significant bit first, read 64 bits at a time
+struct BitReader {
+	const unsigned char* next;
+	const unsigned char* end;
+	unsigned long long bits;
+	int count;
+	int overrun; //zero bytes fed in past the end, a stream that reads them is damaged
+};
+
+static const unsigned short lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163,
+	195, 227, 258 };
+static const unsigned char lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const unsigned short distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049,
+	3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const unsigned char distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+//Tops the bit buffer up to at least 56 bits
+static inline void Refill(BitReader& reader) {
+	if (reader.end - reader.next >= 8) { //load 8 bytes and keep the whole ones, the rest are loaded again next time
+		unsigned long long word;
+		memcpy(&word, reader.next, 8); //little endian, like every platform the games build for
+		reader.bits |= word << reader.count;
+		reader.next += (63 - reader.count) >> 3;
+		reader.count |= 56;
+		return;
+	}
+	while (reader.count < 56) {
+		if (reader.next < reader.end) {
+			reader.bits |= (unsigned long long)*reader.next++ << reader.count;
+		}
+		else {
+			reader.overrun++;
+		}
+		reader.count += 8;
+	}
+}
+
+static inline unsigned int Bits(BitReader& reader, int count) {
+	unsigned int value = (unsigned int)(reader.bits & ((1ull << count) - 1));
+	reader.bits >>= count;
+	reader.count -= count;
+	return value;
+}
+
+static int Reverse(int code, int length) {
+	int reversed = 0;
+	for (int i = 0; i < length; i++) {
+		reversed = (reversed << 1) | ((code >> i) & 1);
+	}
+	return reversed;
+}
+
+static bool BuildHuffman(Huffman& huffman, const unsigned char* codeLengths, int count) {
+	int sizes[17] = { 0 };
+	memset(huffman.fast, 0, sizeof(huffman.fast));
+	for (int i = 0; i < count; i++) {
+		sizes[codeLengths[i]]++;
+	}
+	sizes[0] = 0;
+	int nextCode[16];
+	int code = 0;
+	int symbol = 0;
+	for (int length = 1; length < 16; length++) {
+		nextCode[length] = code;
+		huffman.firstCode[length] = (unsigned short)code;
+		huffman.firstSymbol[length] = (unsigned short)symbol;
+		code += sizes[length];
+		if (sizes[length] != 0 && code - 1 >= (1 << length)) { //more codes of this length than there is room for
+			return false;
+		}
+		huffman.maxCode[length] = code << (16 - length);
+		code <<= 1;
+		symbol += sizes[length];
+	}
+	huffman.maxCode[16] = 0x10000;
+	for (int i = 0; i < count; i++) {
+		int length = codeLengths[i];
+		if (length == 0) {
+			continue;
+		}
+		int index = nextCode[length] - huffman.firstCode[length] + huffman.firstSymbol[length];
+		huffman.lengths[index] = (unsigned char)length;
+		huffman.symbols[index] = (unsigned short)i;
+		if (length <= PNG_FAST_BITS) {
+			for (int j = Reverse(nextCode[length], length); j < (1 << PNG_FAST_BITS); j += 1 << length) {
+				huffman.fast[j] = (unsigned short)((length << 9) | i);
+			}
+		}
+		nextCode[length]++;
+	}
+	return true;
+}
+
+//A code longer than PNG_FAST_BITS, found by comparing against each length's last code
+static int DecodeSlow(BitReader& reader, const Huffman& huffman) {
+	unsigned int code = Reverse((int)(reader.bits & 0xFFFF), 16);
+	int length = PNG_FAST_BITS + 1;
+	while (code >= huffman.maxCode[length]) {
+		length++;
+	}
+	if (length >= 16) {
+		return -1;
+	}
+	int index = (code >> (16 - length)) - huffman.firstCode[length] + huffman.firstSymbol[length];
+	if (index >= 288 || huffman.lengths[index] != length) {
+		return -1;
+	}
+	reader.bits >>= length;
+	reader.count -= length;
+	return huffman.symbols[index];
+}
+
+//Needs 15 bits in the buffer
+static inline int Decode(BitReader& reader, const Huffman& huffman) {
+	unsigned short entry = huffman.fast[reader.bits & ((1 << PNG_FAST_BITS) - 1)];
+	if (entry != 0) {
+		int length = entry >> 9;
+		reader.bits >>= length;
+		reader.count -= length;
+		return entry & 511;
+	}
+	return DecodeSlow(reader, huffman);
+}
+
+static bool ReadDynamicHuffman(BitReader& reader, Huffman& literals, Huffman& distances) {
+	static const unsigned char order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+	Refill(reader);
+	int literalCount = Bits(reader, 5) + 257;
+	int distanceCount = Bits(reader, 5) + 1;
+	int codeLengthCount = Bits(reader, 4) + 4;
+	unsigned char codeLengthLengths[19] = { 0 };
+	for (int i = 0; i < codeLengthCount; i++) {
+		Refill(reader);
+		codeLengthLengths[order[i]] = (unsigned char)Bits(reader, 3);
+	}
+	Huffman codeLengths;
+	if (!BuildHuffman(codeLengths, codeLengthLengths, 19)) {
+		return false;
+	}
+	unsigned char lengths[288 + 32];
+	int total = literalCount + distanceCount;
+	int count = 0;
+	while (count < total) {
+		Refill(reader);
+		int symbol = Decode(reader, codeLengths);
+		if (symbol < 0) {
+			return false;
+		}
+		if (symbol < 16) {
+			lengths[count++] = (unsigned char)symbol;
+			continue;
+		}
+		int repeat;
+		unsigned char value = 0;
+		if (symbol == 16) { //the previous length 3 to 6 times
+			if (count == 0) {
+				return false;
+			}
+			repeat = 3 + Bits(reader, 2);
+			value = lengths[count - 1];
+		}
+		else if (symbol == 17) {
+			repeat = 3 + Bits(reader, 3);
+		}
+		else {
+			repeat = 11 + Bits(reader, 7);
+		}
+		if (count + repeat > total) {
+			return false;
+		}
+		memset(lengths + count, value, repeat);
+		count += repeat;
+	}
+	return lengths[256] != 0 && BuildHuffman(literals, lengths, literalCount) && BuildHuffman(distances, lengths + literalCount, distanceCount);
+}
+
+static bool InflateBlock(BitReader& reader, const Huffman& literals, const Huffman& distances, unsigned char* out, unsigned char*& position,
+	unsigned char* end) {
+	unsigned char* write = position;
+	for (;;) {
+		Refill(reader); //56 bits cover the longest length and distance with their extra bits
+		int symbol = Decode(reader, literals);
+		if (symbol < 256) {
+			if (symbol < 0 || write >= end) {
+				return false;
+			}
+			*write++ = (unsigned char)symbol;
+			continue;
+		}
+		if (symbol == 256) {
+			break;
+		}
+		symbol -= 257;
+		if (symbol >= 29) {
+			return false;
+		}
+		size_t length = lengthBase[symbol] + Bits(reader, lengthExtra[symbol]);
+		int distanceSymbol = Decode(reader, distances);
+		if (distanceSymbol < 0 || distanceSymbol >= 30) {
+			return false;
+		}
+		size_t distance = distanceBase[distanceSymbol] + Bits(reader, distanceExtra[distanceSymbol]);
+		if (distance > (size_t)(write - out) || length > (size_t)(end - write)) {
+			return false;
+		}
+		const unsigned char* from = write - distance;
+		if (distance >= 8) { //8 bytes at a time, up to 7 of them into the slack past the end
+			unsigned char* to = write;
+			unsigned char* stop = write + length;
+			do {
+				memcpy(to, from, 8);
+				to += 8;
+				from += 8;
+			} while (to < stop);
+		}
+		else if (distance == 1) {
+			memset(write, write[-1], length);
+		}
+		else { //a repeating pattern, like the 4 byte pixels of a run: copied 8 at a time from a whole number of patterns back once one is written
+			size_t stride = distance * ((8 + distance - 1) / distance);
+			size_t i = 0;
+			for (; i < length && i < stride - distance; i++) {
+				write[i] = from[i];
+			}
+			for (; i < length; i += 8) {
+				memcpy(write + i, write + i - stride, 8);
+			}
+		}
+		write += length;
+	}
+	position = write;
+	return true;
+}
+
+//Inflates a zlib stream into out, which holds exactly outSize bytes plus PNG_SLACK. The Adler-32 checksum is not checked, as in stb_image
+static bool Inflate(const unsigned char* data, size_t size, unsigned char* out, size_t outSize) {
+	if (size < 2 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[0] & 15) != 8 || (data[1] & 32) != 0) {
+		return false;
+	}
+	BitReader reader = { data + 2, data + size, 0, 0, 0 };
+	unsigned char* position = out;
+	unsigned char* end = out + outSize;
+	bool last;
+	do {
+		Refill(reader);
+		last = Bits(reader, 1) != 0;
+		int type = Bits(reader, 2);
+		if (type == 0) { //stored: byte aligned, a length, its complement and the bytes
+			Bits(reader, reader.count & 7);
+			size_t length = Bits(reader, 16);
+			if ((length ^ 0xFFFF) != Bits(reader, 16) || length > (size_t)(end - position)) {
+				return false;
+			}
+			while (length > 0 && reader.count >= 8) {
+				*position++ = (unsigned char)Bits(reader, 8);
+				length--;
+			}
+			if (length > 0) {
+				if (reader.overrun > 0 || length > (size_t)(reader.end - reader.next)) {
+					return false;
+				}
+				memcpy(position, reader.next, length);
+				position += length;
+				reader.next += length;
+				reader.bits = 0; //drop the bytes loaded ahead of next
+			}
+		}
+		else if (type == 3) {
+			return false;
+		}
+		else {
+			Huffman literals;
+			Huffman distances;
+			if (type == 1) { //fixed codes
+				unsigned char lengths[288 + 30];
+				memset(lengths, 8, 144);
+				memset(lengths + 144, 9, 112);
+				memset(lengths + 256, 7, 24);
+				memset(lengths + 280, 8, 8);
+				memset(lengths + 288, 5, 30);
+				BuildHuffman(literals, lengths, 288);
+				BuildHuffman(distances, lengths + 288, 30);
+			}
+			else if (!ReadDynamicHuffman(reader, literals, distances)) {
+				return false;
+			}
+			if (!InflateBlock(reader, literals, distances, out, position, end)) {
+				return false;
+			}
+		}
+		if (reader.overrun > reader.count / 8) { //read into the zeros past the end
+			return false;
+		}
+	} while (!last);
+	return position == end;
+}
+
+static inline int Paeth(int left, int up, int upLeft) {
+	int distanceLeft = abs(up - upLeft);
+	int distanceUp = abs(left - upLeft);
+	int distanceUpLeft = abs(left + up - 2 * upLeft);
+	if (distanceLeft <= distanceUp && distanceLeft <= distanceUpLeft) {
+		return left;
+	}
+	return distanceUp <= distanceUpLeft ? up : upLeft;
+}
+
+#ifdef PNG_USE_SSE
+static inline __m128i Load32(const unsigned char* source) {
+	int value;
+	memcpy(&value, source, 4);
+	return _mm_cvtsi32_si128(value);
+}
+
+static inline void StorePixel(unsigned char* destination, __m128i pixel, int bytes) {
+	int value = _mm_cvtsi128_si32(pixel);
+	memcpy(destination, &value, bytes);
+}
+
+static inline __m128i Select(__m128i mask, __m128i yes, __m128i no) {
+	return _mm_or_si128(_mm_and_si128(mask, yes), _mm_andnot_si128(mask, no));
+}
+
+//Sub, Avg and Paeth for 3 and 4 byte pixels: each pixel depends on the one before it, so they go a pixel at a time with the
+//arithmetic of a whole pixel in one register (Avg and Paeth in 16 bit lanes). Loads of 3 byte pixels read one byte into the slack
+static bool UnfilterSse(int filter, const unsigned char* row, const unsigned char* prior, unsigned char* out, size_t length, int bpp) {
+	__m128i zero = _mm_setzero_si128();
+	if (filter == 1 && bpp == 4) { //a running sum of pixels, 4 at a time with two shifted adds
+		__m128i left = zero;
+		size_t i = 0;
+		for (; i + 16 <= length; i += 16) {
+			__m128i x = _mm_loadu_si128((const __m128i*)(row + i));
+			x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+			x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+			x = _mm_add_epi8(x, left);
+			_mm_storeu_si128((__m128i*)(out + i), x);
+			left = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+		}
+		for (; i < length; i += 4) {
+			left = _mm_add_epi8(left, Load32(row + i));
+			StorePixel(out + i, left, 4);
+		}
+		return true;
+	}
+	if (filter == 1) {
+		__m128i left = zero;
+		for (size_t i = 0; i < length; i += bpp) {
+			left = _mm_add_epi8(left, Load32(row + i));
+			StorePixel(out + i, left, bpp);
+		}
+		return true;
+	}
+	if (filter == 3) { //_mm_avg_epu8 rounds up, the filter rounds down
+		__m128i one = _mm_set1_epi8(1);
+		__m128i left = zero;
+		for (size_t i = 0; i < length; i += bpp) {
+			__m128i up = Load32(prior + i);
+			__m128i average = _mm_sub_epi8(_mm_avg_epu8(left, up), _mm_and_si128(_mm_xor_si128(left, up), one));
+			left = _mm_add_epi8(Load32(row + i), average);
+			StorePixel(out + i, left, bpp);
+		}
+		return true;
+	}
+	__m128i left = zero;
+	__m128i upLeft = zero;
+	for (size_t i = 0; i < length; i += bpp) {
+		__m128i up = _mm_unpacklo_epi8(Load32(prior + i), zero);
+		__m128i toLeft = _mm_sub_epi16(up, upLeft); //left's distance from the prediction left + up - upLeft
+		__m128i toUp = _mm_sub_epi16(left, upLeft);
+		__m128i toUpLeft = _mm_add_epi16(toLeft, toUp);
+		toLeft = _mm_max_epi16(toLeft, _mm_sub_epi16(zero, toLeft));
+		toUp = _mm_max_epi16(toUp, _mm_sub_epi16(zero, toUp));
+		toUpLeft = _mm_max_epi16(toUpLeft, _mm_sub_epi16(zero, toUpLeft));
+		__m128i smallest = _mm_min_epi16(toUpLeft, _mm_min_epi16(toLeft, toUp));
+		__m128i nearest = Select(_mm_cmpeq_epi16(smallest, toUp), up, upLeft); //ties go to left, then up
+		nearest = Select(_mm_cmpeq_epi16(smallest, toLeft), left, nearest);
+		__m128i pixel = _mm_add_epi8(Load32(row + i), _mm_packus_epi16(nearest, nearest));
+		StorePixel(out + i, pixel, bpp);
+		left = _mm_unpacklo_epi8(pixel, zero);
+		upLeft = up;
+	}
+	return true;
+}
+#endif
+
+//Undoes one row's filter into out. prior is the row above after unfiltering, zeros for the first row
+static bool Unfilter(int filter, const unsigned char* row, const unsigned char* prior, unsigned char* out, size_t length, int bpp) {
+	size_t i = 0;
+	switch (filter) {
+	case 0:
+		memcpy(out, row, length);
+		return true;
+	case 2:
+#ifdef PNG_USE_SSE
+		for (; i + 16 <= length; i += 16) {
+			__m128i sum = _mm_add_epi8(_mm_loadu_si128((const __m128i*)(row + i)), _mm_loadu_si128((const __m128i*)(prior + i)));
+			_mm_storeu_si128((__m128i*)(out + i), sum);
+		}
+#endif
+		for (; i < length; i++) {
+			out[i] = (unsigned char)(row[i] + prior[i]);
+		}
+		return true;
+	case 1:
+	case 3:
+	case 4:
+#ifdef PNG_USE_SSE
+		if (bpp >= 3) {
+			return UnfilterSse(filter, row, prior, out, length, bpp);
+		}
+#endif
+		for (; i < (size_t)bpp; i++) { //the first pixel has nothing to its left
+			int up = prior[i];
+			out[i] = (unsigned char)(row[i] + (filter == 1 ? 0 : (filter == 3 ? up >> 1 : up)));
+		}
+		for (; i < length; i++) {
+			int left = out[i - bpp];
+			int up = prior[i];
+			int predicted = filter == 1 ? left : (filter == 3 ? (left + up) >> 1 : Paeth(left, up, prior[i - bpp]));
+			out[i] = (unsigned char)(row[i] + predicted);
+		}
+		return true;
+	default:
+		return false;
+	}
+}
+
+static unsigned int BigEndian32(const unsigned char* bytes) {
+	return ((unsigned int)bytes[0] << 24) | ((unsigned int)bytes[1] << 16) | ((unsigned int)bytes[2] << 8) | bytes[3];
+}
+
+unsigned char* DecodePng(const unsigned char* data, size_t size, int& width, int& height) {
+	static const unsigned char signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	if (size < 8 || memcmp(data, signature, 8) != 0) {
+		return nullptr;
+	}
+	unsigned int imageWidth = 0;
+	unsigned int imageHeight = 0;
+	int colorType = -1;
+	unsigned char palette[256][4];
+	for (int i = 0; i < 256; i++) {
+		palette[i][0] = palette[i][1] = palette[i][2] = 0;
+		palette[i][3] = 255;
+	}
+	bool keyed = false; //grey or RGB with a tRNS colour that is drawn transparent
+	unsigned char key[3] = { 0, 0, 0 };
+	const unsigned char* compressed = nullptr; //the one IDAT chunk, or joined holds them all
+	size_t compressedSize = 0;
+	vector<unsigned char> joined;
+	size_t position = 8;
+	for (;;) {
+		if (size - position < 12) {
+			return nullptr;
+		}
+		size_t length = BigEndian32(data + position);
+		const unsigned char* type = data + position + 4;
+		const unsigned char* chunk = data + position + 8;
+		if (length > size - position - 12) {
+			return nullptr;
+		}
+		if (memcmp(type, "IHDR", 4) == 0) {
+			if (length != 13) {
+				return nullptr;
+			}
+			imageWidth = BigEndian32(chunk);
+			imageHeight = BigEndian32(chunk + 4);
+			colorType = chunk[9];
+			bool supported = chunk[8] == 8 && (colorType == 0 || colorType == 2 || colorType == 3 || colorType == 4 || colorType == 6) &&
+				chunk[10] == 0 && chunk[11] == 0 && chunk[12] == 0; //8 bits per channel, deflate, no interlacing
+			if (!supported || imageWidth == 0 || imageHeight == 0 || (unsigned long long)imageWidth * imageHeight > (1 << 28)) {
+				return nullptr;
+			}
+		}
+		else if (memcmp(type, "PLTE", 4) == 0) {
+			for (size_t i = 0; i < length / 3 && i < 256; i++) {
+				memcpy(palette[i], chunk + i * 3, 3);
+			}
+		}
+		else if (memcmp(type, "tRNS", 4) == 0) {
+			if (colorType == 3) {
+				for (size_t i = 0; i < length && i < 256; i++) {
+					palette[i][3] = chunk[i];
+				}
+			}
+			else if ((colorType == 0 && length >= 2) || (colorType == 2 && length >= 6)) { //16 bit samples, the low byte at 8 bits
+				keyed = true;
+				for (int i = 0; i < (colorType == 0 ? 1 : 3); i++) {
+					key[i] = chunk[i * 2 + 1];
+				}
+			}
+		}
+		else if (memcmp(type, "IDAT", 4) == 0) {
+			if (compressed == nullptr) {
+				compressed = chunk;
+				compressedSize = length;
+			}
+			else {
+				if (joined.empty()) {
+					joined.assign(compressed, compressed + compressedSize);
+				}
+				joined.insert(joined.end(), chunk, chunk + length);
+				compressed = joined.data();
+				compressedSize = joined.size();
+			}
+		}
+		else if (memcmp(type, "IEND", 4) == 0) {
+			break;
+		}
+		else if ((type[0] & 32) == 0) { //a critical chunk this decoder does not know
+			return nullptr;
+		}
+		position += 12 + length;
+	}
+	if (colorType < 0 || compressed == nullptr) {
+		return nullptr;
+	}
+
+	static const int channelCounts[7] = { 1, 0, 3, 1, 2, 0, 4 };
+	int bpp = channelCounts[colorType];
+	size_t stride = (size_t)imageWidth * bpp;
+	unique_ptr<unsigned char[]> raw(new unsigned char[imageHeight * (stride + 1) + PNG_SLACK]); //not cleared, inflate writes all of it
+	if (!Inflate(compressed, compressedSize, raw.get(), imageHeight * (stride + 1))) {
+		return nullptr;
+	}
+
+	unsigned char* pixels = (unsigned char*)malloc((size_t)imageWidth * imageHeight * 4);
+	if (pixels == nullptr) {
+		return nullptr;
+	}
+	vector<unsigned char> rows(2 * (stride + PNG_SLACK), 0); //RGBA is unfiltered straight into pixels, the rest into these and then expanded
+	const unsigned char* prior = rows.data() + stride + PNG_SLACK; //zeros above the first row
+	for (unsigned int y = 0; y < imageHeight; y++) {
+		const unsigned char* row = raw.get() + y * (stride + 1);
+		unsigned char* out = (bpp == 4) ? pixels + y * stride : rows.data() + (y & 1) * (stride + PNG_SLACK);
+		if (!Unfilter(row[0], row + 1, prior, out, stride, bpp)) {
+			free(pixels);
+			return nullptr;
+		}
+		prior = out;
+		if (bpp == 4) {
+			continue;
+		}
+		unsigned char* destination = pixels + (size_t)y * imageWidth * 4;
+		for (unsigned int x = 0; x < imageWidth; x++, destination += 4) {
+			const unsigned char* source = out + x * bpp;
+			switch (colorType) {
+			case 0:
+				destination[0] = destination[1] = destination[2] = source[0];
+				destination[3] = (keyed && source[0] == key[0]) ? 0 : 255;
+				break;
+			case 2:
+				memcpy(destination, source, 3);
+				destination[3] = (keyed && source[0] == key[0] && source[1] == key[1] && source[2] == key[2]) ? 0 : 255;
+				break;
+			case 3:
+				memcpy(destination, palette[source[0]], 4);
+				break;
+			default:
+				destination[0] = destination[1] = destination[2] = source[0];
+				destination[3] = source[1];
+				break;
+			}
+		}
+	}
+	width = (int)imageWidth;
+	height = (int)imageHeight;
+	return pixels;
+}
+
+unsigned char* DecodeImage(const unsigned char* data, size_t size, int& width, int& height) {
+	unsigned char* pixels = DecodePng(data, size, width, height);
+	if (pixels == nullptr) {
+		int comp;
+		pixels = stbi_load_from_memory(data, (int)size, &width, &height, &comp, STBI_rgb_alpha);
+	}
+	return pixels;
+}
+
+int RunDecodeBenchmark(int count, const char* const files[], int iterations) {
+	typedef chrono::high_resolution_clock Clock;
+	printf("PNG decode benchmark, %d decodes of each image, MB/s of RGBA output\n", iterations);
+	double stbTotal = 0;
+	double decoderTotal = 0;
+	double megabytesTotal = 0;
+	int result = 0;
+	for (int i = 0; i < count; i++) {
+		vector<unsigned char> file;
+		FILE* in = fopen(files[i], "rb");
+		if (in != nullptr) {
+			unsigned char buffer[65536];
+			size_t read;
+			while ((read = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+				file.insert(file.end(), buffer, buffer + read);
+			}
+			fclose(in);
+		}
+		int width = 0;
+		int height = 0;
+		int comp;
+		unsigned char* expected = file.empty() ? nullptr : stbi_load_from_memory(file.data(), (int)file.size(), &width, &height, &comp, STBI_rgb_alpha);
+		if (expected == nullptr) {
+			fprintf(stderr, "cannot decode %s\n", files[i]);
+			result = 1;
+			continue;
+		}
+		int decodedWidth = 0;
+		int decodedHeight = 0;
+		unsigned char* decoded = DecodePng(file.data(), file.size(), decodedWidth, decodedHeight);
+		const char* name = strrchr(files[i], '/') ? strrchr(files[i], '/') + 1 : files[i];
+		if (decoded == nullptr || decodedWidth != width || decodedHeight != height || memcmp(decoded, expected, (size_t)width * height * 4) != 0) {
+			printf("  %-16s %s\n", name, decoded == nullptr ? "not handled, stb_image is used" : "DIFFERENT PIXELS from stb_image");
+			result = (decoded == nullptr) ? result : 1;
+			stbi_image_free(expected);
+			free(decoded);
+			continue;
+		}
+		stbi_image_free(expected);
+		free(decoded);
+
+		Clock::time_point start = Clock::now();
+		for (int j = 0; j < iterations; j++) {
+			stbi_image_free(stbi_load_from_memory(file.data(), (int)file.size(), &width, &height, &comp, STBI_rgb_alpha));
+		}
+		Clock::time_point middle = Clock::now();
+		for (int j = 0; j < iterations; j++) {
+			free(DecodePng(file.data(), file.size(), width, height));
+		}
+		Clock::time_point end = Clock::now();
+		double stbSeconds = chrono::duration<double>(middle - start).count();
+		double decoderSeconds = chrono::duration<double>(end - middle).count();
+		double megabytes = (double)width * height * 4 * iterations / (1024 * 1024);
+		printf("  %-16s %5dx%-5d stb_image %7.1f MB/s   DecodePng %7.1f MB/s   %.2fx\n", name, width, height, megabytes / stbSeconds,
+			megabytes / decoderSeconds, stbSeconds / decoderSeconds);
+		stbTotal += stbSeconds;
+		decoderTotal += decoderSeconds;
+		megabytesTotal += megabytes;
+	}
+	if (decoderTotal > 0) {
+		printf("  %-16s             stb_image %7.1f MB/s   DecodePng %7.1f MB/s   %.2fx\n", "all", megabytesTotal / stbTotal,
+			megabytesTotal / decoderTotal, stbTotal / decoderTotal);
+	}
+	return result;
+}
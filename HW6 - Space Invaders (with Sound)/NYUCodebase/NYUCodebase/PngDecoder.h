@@ -0,0 +1,28 @@
+
+#pragma once
+
+#include <stddef.h>
+
+#define DECODE_BENCH_ITERATIONS 20 //decodes of each image per decoder in --decode-bench
+
+/* DecodePng()
+	\description - Decodes an 8 bit, non-interlaced PNG (grey, RGB, palette, grey and alpha or RGBA) to RGBA, with a table driven inflate
+	               and SSE2 unfiltering. Gives the same pixels as stb_image
+	\param data  - the PNG file's bytes
+	\param width - set to the image's width
+	\return      - RGBA pixels allocated with malloc, NULL if the data is damaged or not a PNG this decoder handles
+*/
+unsigned char* DecodePng(const unsigned char* data, size_t size, int& width, int& height);
+
+/* DecodeImage()
+	\description - Decodes an image to RGBA with DecodePng, or with stb_image for anything DecodePng does not handle
+	\return      - pixels to free with stbi_image_free (both decoders allocate with malloc), NULL if the image cannot be decoded
+*/
+unsigned char* DecodeImage(const unsigned char* data, size_t size, int& width, int& height);
+
+/* RunDecodeBenchmark()
+	\description - Decodes each file with stb_image and with DecodePng, checks both give the same pixels and prints MB/s of RGBA for each
+	\param files - paths of the images
+	\return      - 0, or 1 if a file cannot be read or the decoders disagree
+*/
+int RunDecodeBenchmark(int count, const char* const files[], int iterations);
@@ -0,0 +1,53 @@
+
+#pragma once
+
+/*
+ *
+ * Frame-phase profiler
+ *   PROFILE_ZONE("name")   - times the rest of the enclosing scope (the name must be a string literal)
+ *   PROFILE_EXPORT("path") - writes every thread's recorded zones as Chrome trace JSON (open with chrome://tracing or ui.perfetto.dev)
+ * Zones are only recorded when the build defines PROFILER_ENABLED, otherwise both macros expand to nothing.
+ *
+ */
+
+#ifdef PROFILER_ENABLED
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_EXPORT(path) ProfilerExport(path)
+
+/* ProfilerNow()
+	\description - Nanoseconds since the profiler was first used
+*/
+long long ProfilerNow();
+
+/* ProfilerRecord()
+	\description - Adds a finished zone to the calling thread's ring buffer (the oldest zone is overwritten when it is full)
+*/
+void ProfilerRecord(const char* name, long long start, long long end);
+
+/* ProfilerExport()
+	\description - Writes the zones in every thread's ring buffer to path as Chrome trace JSON.
+	               Zones being recorded by other threads while this runs may be missing from the file.
+*/
+bool ProfilerExport(const char* path);
+
+//ProfileZone - records the time between its construction and destruction
+class ProfileZone {
+public:
+	ProfileZone(const char* name) : name(name), start(ProfilerNow()) {}
+	~ProfileZone() {
+		ProfilerRecord(name, start, ProfilerNow());
+	}
+private:
+	const char* name;
+	long long start;
+};
+
+#else
+
+#define PROFILE_ZONE(name)
+#define PROFILE_EXPORT(path)
+
+#endif
@@ -1,5 +1,6 @@
 
 #include "ShaderProgram.h"
+#include "AssetPack.h"
 
 void ShaderProgram::Load(const char *vertexShaderFile, const char *fragmentShaderFile) {
     
@@ -39,6 +40,12 @@ void ShaderProgram::Cleanup() {
 }
 
 GLuint ShaderProgram::LoadShaderFromFile(const std::string &shaderFile, GLenum type) {
+    //Compile straight from the asset pack when the shader is in it
+    AssetSpan packed = assetPack.Find(shaderFile.c_str());
+    if(packed.data != NULL) {
+        return LoadShaderFromMemory((const char *)packed.data, (GLint)packed.size, type);
+    }
+
     //Open a file stream with the file name
     std::ifstream infile(shaderFile);
     
@@ -55,17 +62,18 @@ GLuint ShaderProgram::LoadShaderFromFile(const std::string &shaderFile, GLenum t
 }
 
 GLuint ShaderProgram::LoadShaderFromString(const std::string &shaderContents, GLenum type) {
+    // Get the pointer to the C string from the STL string
+    return LoadShaderFromMemory(shaderContents.c_str(), (GLint) shaderContents.size(), type);
+}
+
+GLuint ShaderProgram::LoadShaderFromMemory(const char *shaderContents, GLint length, GLenum type) {
     
     
     // Create a shader of specified type
     GLuint shaderID = glCreateShader(type);
     
-    // Get the pointer to the C string from the STL string
-    const char *shaderString = shaderContents.c_str();
-    GLint shaderStringLength = (GLint) shaderContents.size();
-    
-    // Set the shader source to the string and compile shader
-    glShaderSource(shaderID, 1, &shaderString, &shaderStringLength);
+    // Set the shader source to the text (it does not need to end in a 0) and compile shader
+    glShaderSource(shaderID, 1, &shaderContents, &length);
     glCompileShader(shaderID);
     
     // Check if the shader compiled properly
@@ -0,0 +1,78 @@
+
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+#include <mutex>
+#include <string>
+
+#define TEXTURE_CACHE_DIRECTORY "texture_cache" //where decoded images are kept, relative to the working directory
+#define TEXTURE_CACHE_VERSION 1 //bump when the cache file layout changes, older files are then rebuilt
+
+//DecodedImage - RGBA pixels of an image, either decoded by stb_image or mapped straight from a texture cache file
+struct DecodedImage {
+	unsigned char* pixels; //NULL if the image could not be loaded
+	int width;
+	int height;
+	void* mapping; //the mapped cache file the pixels are in, NULL when stb_image decoded them
+	size_t mappingSize;
+};
+
+//TextureCache - keeps every decoded image in a file of its own, named after the image's path and checked against its size and
+//modification time (the pack's, for images in assetPack). A hit maps that file instead of decoding the PNG, a miss (or a stale file)
+//decodes it and rewrites the file.
+//Load and Free may be called from any thread.
+class TextureCache {
+public:
+	/* TextureCache()
+		\description     - Constructor, the directory is created on the first miss
+		\param directory - directory the cache files are kept in
+	*/
+	TextureCache(const char* directory);
+
+	/* Load()
+		\description    - Loads an image as RGBA, from the cache when it is up to date
+		\param filePath - image file
+		\param image    - set to the pixels, which stay valid until Free
+		\return         - false if the image could not be decoded
+	*/
+	bool Load(const char* filePath, DecodedImage& image);
+
+	/* Free()
+		\description - Unmaps or frees the pixels of an image from Load
+	*/
+	void Free(DecodedImage& image);
+
+	/* SetEnabled()
+		\description - With the cache off every Load decodes and nothing is written (counted as misses)
+	*/
+	void SetEnabled(bool enabled);
+
+	int Hits();
+	int Misses();
+
+	/* PrintStats()
+		\description - Prints the hits and misses and the time spent loading each
+	*/
+	void PrintStats(FILE* out);
+
+	/* PrintStatsJSON()
+		\description - Prints the same numbers as a JSON object (no trailing newline)
+	*/
+	void PrintStatsJSON(FILE* out);
+private:
+	std::string CachePath(const char* filePath) const;
+	bool Map(const std::string& cachePath, const char* filePath, long long sourceSize, long long sourceModified, DecodedImage& image);
+	void Write(const std::string& cachePath, const char* filePath, long long sourceSize, long long sourceModified, const DecodedImage& image);
+
+	std::string directory;
+	bool enabled;
+	bool directoryMade;
+	std::mutex lock; //guards the counters and directoryMade
+	int hits;
+	int misses;
+	double hitMs;
+	double missMs;
+};
+
+extern TextureCache textureCache;
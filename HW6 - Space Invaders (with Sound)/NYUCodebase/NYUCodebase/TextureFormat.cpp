@@ -0,0 +1,285 @@
+#include "TextureFormat.h"
+#include <algorithm>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+TextureMemory textureMemory = { 0, 0, 0 };
+
+static bool compressTextures = false;
+static int formatTolerance = 0; //most a channel may change by, 0 unless SetLossyTextureFormats
+
+void TextureMemory::Add(TextureFormat format, int width, int height) {
+	textures++;
+	bytes += TextureFormatBytes(format, width, height);
+	rgba8Bytes += (size_t)width * height * 4;
+}
+
+void TextureMemory::Print(FILE* out) const {
+	fprintf(out, "texture memory: %d textures, %u bytes (%u as RGBA8)\n", textures, (unsigned int)bytes, (unsigned int)rgba8Bytes);
+}
+
+void SetTextureCompression(bool compress) {
+	compressTextures = compress;
+}
+
+void SetLossyTextureFormats(bool lossy) {
+	formatTolerance = lossy ? TEXTURE_LOSSY_TOLERANCE : 0;
+}
+
+static bool CompressionSupported() {
+	const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+	return extensions != NULL && strstr(extensions, "GL_EXT_texture_compression_s3tc") != NULL;
+}
+
+//Channel value after a round trip through bits bits
+static int Quantized(int value, int bits) {
+	int levels = (1 << bits) - 1;
+	int stored = (value * levels + 127) / 255;
+	return (stored * 255 + levels / 2) / levels;
+}
+
+static int Luminance(const unsigned char* pixel) {
+	return (pixel[0] + pixel[1] + pixel[2] + 1) / 3;
+}
+
+TextureFormat ChooseTextureFormat(const unsigned char* pixels, int width, int height) {
+	bool grey = true;
+	bool opaque = true;
+	bool fits565 = true;
+	bool fits4444 = true;
+	for (size_t i = 0; i < (size_t)width * height; i++) {
+		const unsigned char* pixel = pixels + i * 4;
+		int luminance = Luminance(pixel);
+		opaque = opaque && 255 - pixel[3] <= formatTolerance;
+		for (int channel = 0; channel < 3; channel++) {
+			grey = grey && abs(pixel[channel] - luminance) <= formatTolerance;
+			fits565 = fits565 && abs(pixel[channel] - Quantized(pixel[channel], channel == 1 ? 6 : 5)) <= formatTolerance;
+		}
+		for (int channel = 0; channel < 4; channel++) {
+			fits4444 = fits4444 && abs(pixel[channel] - Quantized(pixel[channel], 4)) <= formatTolerance;
+		}
+	}
+	if (grey && opaque) {
+		return TEXTURE_LUMINANCE8;
+	}
+	if (grey) {
+		return TEXTURE_LUMINANCE8_ALPHA8;
+	}
+	if (opaque && fits565) {
+		return TEXTURE_RGB565;
+	}
+	if (fits4444) {
+		return TEXTURE_RGBA4444;
+	}
+	if (compressTextures && width >= TEXTURE_COMPRESS_MIN_SIZE && height >= TEXTURE_COMPRESS_MIN_SIZE && CompressionSupported()) {
+		return TEXTURE_DXT5;
+	}
+	return TEXTURE_RGBA8;
+}
+
+static unsigned short Pack565(int r, int g, int b) {
+	return (unsigned short)((((r * 31 + 127) / 255) << 11) | (((g * 63 + 127) / 255) << 5) | ((b * 31 + 127) / 255));
+}
+
+//One 4x4 block as DXT5: an alpha block (two endpoints, 3 bit indices) and a colour block (two 565 endpoints, 2 bit indices)
+static void CompressBlock(const unsigned char* pixels, int width, int height, int blockX, int blockY, unsigned char* out) {
+	unsigned char block[16][4];
+	for (int y = 0; y < 4; y++) {
+		for (int x = 0; x < 4; x++) { //blocks past the edge repeat the last row and column
+			int sourceX = min(blockX + x, width - 1);
+			int sourceY = min(blockY + y, height - 1);
+			memcpy(block[y * 4 + x], pixels + ((size_t)sourceY * width + sourceX) * 4, 4);
+		}
+	}
+
+	int alphaMax = 0;
+	int alphaMin = 255;
+	int low[3] = { 255, 255, 255 };
+	int high[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; i++) {
+		alphaMax = max(alphaMax, (int)block[i][3]);
+		alphaMin = min(alphaMin, (int)block[i][3]);
+		if (block[i][3] == 0) { //the colour of invisible texels does not matter, so it does not widen the box
+			continue;
+		}
+		for (int channel = 0; channel < 3; channel++) {
+			low[channel] = min(low[channel], (int)block[i][channel]);
+			high[channel] = max(high[channel], (int)block[i][channel]);
+		}
+	}
+	if (alphaMax == 0) { //all invisible, the colour is never seen
+		low[0] = low[1] = low[2] = high[0] = high[1] = high[2] = 0;
+	}
+
+	//Alpha: a0 > a1 selects eight levels, a0 and a1 plus six between them
+	int alphas[8];
+	alphas[0] = alphaMax;
+	alphas[1] = alphaMin;
+	for (int i = 2; i < 8; i++) {
+		alphas[i] = ((8 - i) * alphaMax + (i - 1) * alphaMin) / 7;
+	}
+	unsigned long long alphaBits = 0;
+	for (int i = 0; i < 16; i++) {
+		int best = 0;
+		for (int code = 1; code < 8; code++) {
+			if (abs(alphas[code] - block[i][3]) < abs(alphas[best] - block[i][3])) {
+				best = code;
+			}
+		}
+		alphaBits |= (unsigned long long)best << (3 * i);
+	}
+	out[0] = (unsigned char)alphaMax;
+	out[1] = (unsigned char)alphaMin;
+	for (int i = 0; i < 6; i++) {
+		out[2 + i] = (unsigned char)(alphaBits >> (8 * i));
+	}
+
+	//Colour: a diagonal of the block's bounding box, pulled in by a sixteenth so the ends are not wasted on outliers. The diagonal
+	//runs against green for red or blue when they fall as green rises
+	int center[3];
+	for (int channel = 0; channel < 3; channel++) {
+		center[channel] = (low[channel] + high[channel] + 1) / 2;
+	}
+	int covariance[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; i++) {
+		if (block[i][3] == 0) {
+			continue;
+		}
+		for (int channel = 0; channel < 3; channel += 2) {
+			covariance[channel] += (block[i][channel] - center[channel]) * (block[i][1] - center[1]);
+		}
+	}
+	for (int channel = 0; channel < 3; channel++) {
+		int inset = (high[channel] - low[channel]) / 16;
+		high[channel] -= inset;
+		low[channel] += inset;
+		if (covariance[channel] < 0) {
+			swap(low[channel], high[channel]);
+		}
+	}
+	unsigned short color0 = Pack565(high[0], high[1], high[2]);
+	unsigned short color1 = Pack565(low[0], low[1], low[2]);
+	int palette[4][3];
+	for (int channel = 0; channel < 3; channel++) {
+		int bits = channel == 1 ? 6 : 5;
+		palette[0][channel] = Quantized(high[channel], bits);
+		palette[1][channel] = Quantized(low[channel], bits);
+		palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+		palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+	}
+	unsigned int colorBits = 0;
+	for (int i = 0; i < 16; i++) {
+		int best = 0;
+		int bestDistance = INT_MAX;
+		for (int code = 0; code < 4; code++) {
+			int distance = 0;
+			for (int channel = 0; channel < 3; channel++) {
+				int difference = palette[code][channel] - block[i][channel];
+				distance += difference * difference;
+			}
+			if (distance < bestDistance) {
+				bestDistance = distance;
+				best = code;
+			}
+		}
+		colorBits |= (unsigned int)best << (2 * i);
+	}
+	out[8] = (unsigned char)color0;
+	out[9] = (unsigned char)(color0 >> 8);
+	out[10] = (unsigned char)color1;
+	out[11] = (unsigned char)(color1 >> 8);
+	for (int i = 0; i < 4; i++) {
+		out[12 + i] = (unsigned char)(colorBits >> (8 * i));
+	}
+}
+
+void ConvertTexture(TextureFormat format, const unsigned char* pixels, int width, int height, TextureUpload& upload) {
+	size_t count = (size_t)width * height;
+	upload.compressed = false;
+	upload.type = GL_UNSIGNED_BYTE;
+	upload.data.clear();
+	switch (format) {
+	case TEXTURE_LUMINANCE8:
+		upload.internalFormat = GL_LUMINANCE8;
+		upload.format = GL_LUMINANCE;
+		upload.data.resize(count);
+		for (size_t i = 0; i < count; i++) {
+			upload.data[i] = (unsigned char)Luminance(pixels + i * 4);
+		}
+		break;
+	case TEXTURE_LUMINANCE8_ALPHA8:
+		upload.internalFormat = GL_LUMINANCE8_ALPHA8;
+		upload.format = GL_LUMINANCE_ALPHA;
+		upload.data.resize(count * 2);
+		for (size_t i = 0; i < count; i++) {
+			upload.data[i * 2] = (unsigned char)Luminance(pixels + i * 4);
+			upload.data[i * 2 + 1] = pixels[i * 4 + 3];
+		}
+		break;
+	case TEXTURE_RGB565:
+		upload.internalFormat = GL_RGB565;
+		upload.format = GL_RGB;
+		upload.type = GL_UNSIGNED_SHORT_5_6_5;
+		upload.data.resize(count * 2);
+		for (size_t i = 0; i < count; i++) {
+			unsigned short packed = Pack565(pixels[i * 4], pixels[i * 4 + 1], pixels[i * 4 + 2]);
+			memcpy(&upload.data[i * 2], &packed, 2);
+		}
+		break;
+	case TEXTURE_RGBA4444:
+		upload.internalFormat = GL_RGBA4;
+		upload.format = GL_RGBA;
+		upload.type = GL_UNSIGNED_SHORT_4_4_4_4;
+		upload.data.resize(count * 2);
+		for (size_t i = 0; i < count; i++) {
+			unsigned short packed = 0;
+			for (int channel = 0; channel < 4; channel++) {
+				packed = (unsigned short)((packed << 4) | ((pixels[i * 4 + channel] * 15 + 127) / 255));
+			}
+			memcpy(&upload.data[i * 2], &packed, 2);
+		}
+		break;
+	case TEXTURE_DXT5: {
+		upload.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		upload.format = GL_RGBA;
+		upload.compressed = true;
+		int blocksWide = (width + 3) / 4;
+		int blocksHigh = (height + 3) / 4;
+		upload.data.resize((size_t)blocksWide * blocksHigh * 16);
+		for (int y = 0; y < blocksHigh; y++) {
+			for (int x = 0; x < blocksWide; x++) {
+				CompressBlock(pixels, width, height, x * 4, y * 4, &upload.data[((size_t)y * blocksWide + x) * 16]);
+			}
+		}
+		break;
+	}
+	default:
+		upload.internalFormat = GL_RGBA8;
+		upload.format = GL_RGBA;
+		break;
+	}
+}
+
+size_t TextureFormatBytes(TextureFormat format, int width, int height) {
+	size_t count = (size_t)width * height;
+	switch (format) {
+	case TEXTURE_LUMINANCE8:
+		return count;
+	case TEXTURE_LUMINANCE8_ALPHA8:
+	case TEXTURE_RGB565:
+	case TEXTURE_RGBA4444:
+		return count * 2;
+	case TEXTURE_DXT5:
+		return (size_t)((width + 3) / 4) * ((height + 3) / 4) * 16;
+	default:
+		return count * 4;
+	}
+}
+
+const char* TextureFormatName(TextureFormat format) {
+	static const char* const names[] = { "LUMINANCE8", "LUMINANCE8_ALPHA8", "RGB565", "RGBA4444", "DXT5", "RGBA8" };
+	return names[format];
+}
@@ -9,8 +9,19 @@
 #include <time.h>       /* time */
 #include <vector>
 #include <string>
+#include <chrono>
+#include <float.h>
+#include <algorithm>
+#include <string.h>
 #include "ShaderProgram.h"
 #include "Matrix.h"
+#include "FrameCapture.h"
+#include "Profiler.h"
+#include "FrameScratch.h"
+#include "TextureCache.h"
+#include "AssetPack.h"
+#include "TextureFormat.h"
+#include "PngDecoder.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -32,6 +43,7 @@
 #define RIGHT 1
 #define UP 1
 #define DOWN -1
+#define FORMATION_COLUMNS 6 //columns the enemy grid starts with, Formation::Add widens it if the spawn layout needs more
 
 SDL_Window* displayWindow;
 GLuint gameShapes;
@@ -42,24 +54,79 @@ class TextEntity;
 class KillableObject;
 class Ship;
 class Bullet;
+class Formation;
 
 GLuint LoadTexture(const char *filePath) {
-	int w, h, comp;
-	unsigned char* image = stbi_load(filePath, &w, &h, &comp, STBI_rgb_alpha);
-	if (image == NULL) {
+	PROFILE_ZONE("LoadTexture");
+	DecodedImage image; //mapped from the texture cache, decoded only the first time or when the file has changed
+	if (!textureCache.Load(filePath, image)) {
 		std::cout << "Unable to load image. Make sure the path is correct\n";
 		assert(false);
 	}
+	TextureFormat format = ChooseTextureFormat(image.pixels, image.width, image.height); //font.png is grey, so it fits in luminance and alpha
+	TextureUpload upload;
+	ConvertTexture(format, image.pixels, image.width, image.height, upload);
+	const unsigned char* data = upload.data.empty() ? image.pixels : upload.data.data();
 	GLuint retTexture;
 	glGenTextures(1, &retTexture);
 	glBindTexture(GL_TEXTURE_2D, retTexture);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if (upload.compressed) {
+		glCompressedTexImage2D(GL_TEXTURE_2D, 0, upload.internalFormat, image.width, image.height, 0, upload.data.size(), data);
+	}
+	else {
+		glTexImage2D(GL_TEXTURE_2D, 0, upload.internalFormat, image.width, image.height, 0, upload.format, upload.type, data);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	textureMemory.Add(format, image.width, image.height);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	stbi_image_free(image);
+	textureCache.Free(image);
 	return retTexture;
 }
 
+//Sounds and music come from the asset pack when they are in it, SDL_mixer reads them straight from the mapped pack
+Mix_Chunk* LoadSound(const char *filePath) {
+	AssetSpan packed = assetPack.Find(filePath);
+	if (packed.data != NULL) {
+		return Mix_LoadWAV_RW(SDL_RWFromConstMem(packed.data, (int)packed.size), 1);
+	}
+	return Mix_LoadWAV(filePath);
+}
+
+Mix_Music* LoadMusic(const char *filePath) {
+	AssetSpan packed = assetPack.Find(filePath);
+	if (packed.data != NULL) { //the music streams from the pack while it plays, the pack stays mapped until exit
+		return Mix_LoadMUS_RW(SDL_RWFromConstMem(packed.data, (int)packed.size), 1);
+	}
+	return Mix_LoadMUS(filePath);
+}
+
+//Formation - Enemy ships kept in a columns x rows grid. Every column caches the x extents of its ships, so a bullet
+//is only tested against the ships (and the bullets) of the columns it overlaps.
+class Formation {
+public:
+	Formation(int gridColumns);
+	~Formation();
+	void Add(Ship* ship, int column, int row);
+	void Clear();
+	int Count() const;
+	const std::vector<Ship*>& Ships() const;
+	void Collision(Ship* player);
+	static int Benchmark(int gridColumns, int gridRows, int frames);
+private:
+	int columns;
+	int rows;
+	std::vector<Ship*> grid; //row major, nullptr for empty or destroyed slots
+	std::vector<Ship*> ships; //living ships in creation order (used for moving, shooting and drawing)
+	std::vector<float> columnMin;
+	std::vector<float> columnMax;
+	bool extentsDirty;
+	void RefreshExtents();
+	bool ColumnOverlaps(int column, float xMin, float xMax) const;
+	void RemoveDead(Ship* player);
+	static void LegacyCollision(std::vector<Ship*>& enemies, Ship* player);
+};
 class GameState {
 public:
 	GameState();
@@ -83,7 +150,7 @@ private:
 
 	//in-game elements
 	const int MAX_ENEMIES;
-	std::vector<Ship*> enemies;
+	Formation enemies;
 	Ship* player;
 	Mix_Chunk* playerSound;
 	Mix_Chunk* enemySound;
@@ -110,11 +177,12 @@ protected:
 	float position[3];
 	float vertices[12];
 	float rotationValue;
-	virtual void getTexture(std::vector<float>& textureCoordinates) = 0;
+	virtual void getTexture(ScratchVector<float>& textureCoordinates) = 0;
 };
 class KillableObject : public Entity {
 public:
 	friend class GameState;
+	friend class Formation;
 	KillableObject(ShaderProgram& shaderProgram, float* pos, float rotate, int hpValue);
 	virtual void move(float elapsed);
 	bool Immovable();
@@ -131,12 +199,14 @@ class Ship : public KillableObject {
 public:
 	friend class GameState;
 	friend class Bullet;
+	friend class Formation;
 	Ship(ShaderProgram& shaderProgram, float* pos, float xVelocity, bool player);
+	~Ship();
 	virtual void move(float elapsed, int movementDirection);
 	virtual void draw();
 	void shoot();
 protected:
-	virtual void getTexture(std::vector<float>& textureCoordinates);
+	virtual void getTexture(ScratchVector<float>& textureCoordinates);
 private:
 	float lastFire;
 	float fireRate;
@@ -147,22 +217,24 @@ class Bullet : public KillableObject {
 public:
 	friend class GameState;
 	friend class Ship;
+	friend class Formation;
 	Bullet(ShaderProgram& shaderProgram, float* pos, int damage, float yVelocity, bool player, int movementDirection);
 	bool collision(const Bullet& other);
 	bool collision(const Ship& ship);
 protected:
-	virtual void getTexture(std::vector<float>& textureCoordinates);
+	virtual void getTexture(ScratchVector<float>& textureCoordinates);
 private:
 	bool isPlayers;
 	int damage;
 };
 
 //Game State
-GameState::GameState() : MAX_ENEMIES(11), currentMode(MENU_MODE), nextMode(MENU_MODE) {
+GameState::GameState() : MAX_ENEMIES(11), currentMode(MENU_MODE), nextMode(MENU_MODE), enemies(FORMATION_COLUMNS) {
+	PROFILE_ZONE("GameState::GameState");
 	Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 4096);
-	enemySound = Mix_LoadWAV("enemyGun.wav");
-	playerSound = Mix_LoadWAV("playerGun.wav");
-	music = Mix_LoadMUS(RESOURCE_FOLDER"nier.mp3"); //Credits to  Square Enix for making this in their OST for NieR: Automata
+	enemySound = LoadSound("enemyGun.wav");
+	playerSound = LoadSound("playerGun.wav");
+	music = LoadMusic(RESOURCE_FOLDER"nier.mp3"); //Credits to  Square Enix for making this in their OST for NieR: Automata
 	Mix_PlayMusic(music, -1);
 	lastTicks = 0;
 
@@ -187,16 +259,13 @@ GameState::~GameState() {
 	if (player) {
 		delete player;
 	}
-	for (Ship* enemy : enemies) {
-		if (enemy) {
-			delete enemy;
-		}
-	}
+	enemies.Clear();
 	Mix_FreeChunk(playerSound);
 	Mix_FreeChunk(enemySound);
 	Mix_FreeMusic(music);
 }
 void GameState::Update(SDL_Event& event, bool& done) {
+	PROFILE_ZONE("GameState::Update");
 	srand(time(NULL));
 	float ticks = (float)SDL_GetTicks() / 1000.0f;
 	float elapsed = ticks - lastTicks;
@@ -225,19 +294,25 @@ void GameState::Update(SDL_Event& event, bool& done) {
 		break;
 	case GAME_MODE:
 		if (newGame) {
+			PROFILE_ZONE("StartGame");
 			float shiftPos = -11.3f;
 			float playerPos[3] = { 0, -6, 0 };
 			player = new Ship(*currentProgram, playerPos, .03f, true);
 			float enemyPos[3] = { -14, 6, 0 };
+			int column = 0;
+			int row = 0;
 			for (int enemyNumber = 0; enemyNumber < MAX_ENEMIES; enemyNumber++) {
-				enemies.push_back(new Ship(*currentProgram, enemyPos, 0, false));
+				enemies.Add(new Ship(*currentProgram, enemyPos, 0, false), column, row);
 				if (enemyPos[0] >= 8) {
 					enemyPos[0] = shiftPos;
 					enemyPos[1] -= 4;
 					shiftPos = (shiftPos == -11.3f) ? -14 : -11.3f;
+					column = 0;
+					row++;
 				}
 				else {
 					enemyPos[0] += 5;
+					column++;
 				}
 			}
 			nextMode = GAME_MODE;
@@ -248,13 +323,14 @@ void GameState::Update(SDL_Event& event, bool& done) {
 				player->shoot();
 				Mix_PlayChannel(-1, playerSound, 0);
 			}
-			for (Ship* enemy : enemies) {
+			for (Ship* enemy : enemies.Ships()) {
 				if (rand() % 100 <= 10) {
 					enemy->shoot();
 					Mix_PlayChannel(-1, enemySound, 0);
 				}
 			}
 			while (elapsed > TIME_STEP_SIZE) {
+				PROFILE_ZONE("FixedStep");
 				if (keyboard[SDL_SCANCODE_RIGHT]) {
 					player->move(TIME_STEP_SIZE, RIGHT);
 				}
@@ -264,7 +340,7 @@ void GameState::Update(SDL_Event& event, bool& done) {
 				else {
 					player->move(TIME_STEP_SIZE, NO_MOVEMENT);
 				}
-				for (Ship* enemy : enemies) {
+				for (Ship* enemy : enemies.Ships()) {
 					enemy->move(TIME_STEP_SIZE, NO_MOVEMENT);
 				}
 				Collision();
@@ -279,24 +355,24 @@ void GameState::Update(SDL_Event& event, bool& done) {
 			else {
 				player->move(elapsed, NO_MOVEMENT);
 			}
-			for (Ship* enemy : enemies) {
+			for (Ship* enemy : enemies.Ships()) {
 				enemy->move(elapsed, NO_MOVEMENT);
 			}
 			Collision();
 		}
 		break;
-	case GAME_OVER_MODE:
+	case GAME_OVER_MODE: {
+		PROFILE_ZONE("EndGame");
 		delete player;
-		for (Ship* enemy : enemies) {
-			delete enemy;
-		}
-		enemies.clear();
+		enemies.Clear();
 		newGame = true;
 		nextMode = MENU_MODE;
 		break;
 	}
+	}
 }
 void GameState::Draw() {
+	PROFILE_ZONE("GameState::Draw");
 	TextEntity TextDrawer(*currentProgram, fonts);
 	float pos[3] = { 0, 0, 0 };
 	switch (currentMode) {
@@ -315,7 +391,7 @@ void GameState::Draw() {
 	case GAME_MODE:
 		currentProgram = &gameProgram;
 		player->draw();
-		for (Ship* enemy : enemies) {
+		for (Ship* enemy : enemies.Ships()) {
 			enemy->draw();
 		}
 		break;
@@ -324,6 +400,176 @@ void GameState::Draw() {
 	}
 }
 void GameState::Collision() {
+	PROFILE_ZONE("GameState::Collision");
+	enemies.Collision(player);
+ 	if (player->alive == false || enemies.Count() == 0) {
+		nextMode = GAME_OVER_MODE;
+	}
+}
+
+//Formation
+Formation::Formation(int gridColumns) : columns(gridColumns), rows(0), extentsDirty(true) {
+	columnMin.resize(columns);
+	columnMax.resize(columns);
+}
+Formation::~Formation() {
+	Clear();
+}
+void Formation::Add(Ship* ship, int column, int row) {
+	assert(column >= 0 && row >= 0);
+	if (column >= columns) { //more ships in a row than the grid was made for, copy the rows into wider ones
+		int wider = column + 1;
+		std::vector<Ship*> widerGrid(rows * wider, nullptr);
+		for (int r = 0; r < rows; r++) {
+			std::copy(grid.begin() + r * columns, grid.begin() + (r + 1) * columns, widerGrid.begin() + r * wider);
+		}
+		grid.swap(widerGrid);
+		columns = wider;
+		columnMin.resize(columns);
+		columnMax.resize(columns);
+	}
+	if (row >= rows) {
+		rows = row + 1;
+		grid.resize(rows * columns, nullptr);
+	}
+	grid[row * columns + column] = ship;
+	ships.push_back(ship);
+	extentsDirty = true;
+}
+void Formation::Clear() {
+	for (Ship* ship : ships) {
+		delete ship;
+	}
+	ships.clear();
+	grid.clear();
+	rows = 0;
+	extentsDirty = true;
+}
+int Formation::Count() const {
+	return ships.size();
+}
+const std::vector<Ship*>& Formation::Ships() const {
+	return ships;
+}
+void Formation::RefreshExtents() { //enemies never move sideways, so this only reruns after a ship is added or destroyed
+	for (int column = 0; column < columns; column++) {
+		columnMin[column] = FLT_MAX;
+		columnMax[column] = -FLT_MAX;
+		for (int row = 0; row < rows; row++) {
+			Ship* ship = grid[row * columns + column];
+			if (ship) {
+				columnMin[column] = fmin(columnMin[column], ship->position[0]);
+				columnMax[column] = fmax(columnMax[column], ship->position[0] + 3.0f);
+			}
+		}
+	}
+	extentsDirty = false;
+}
+bool Formation::ColumnOverlaps(int column, float xMin, float xMax) const {
+	return !(columnMax[column] < xMin || columnMin[column] > xMax);
+}
+void Formation::Collision(Ship* player) {
+	if (extentsDirty) {
+		RefreshExtents();
+	}
+	for (Bullet* laser : player->bullets) { //player bullets only look at the columns under them
+		float xMin = laser->position[0];
+		float xMax = laser->position[0] + 0.8f;
+		for (int column = 0; column < columns && laser->alive; column++) {
+			if (!ColumnOverlaps(column, xMin, xMax)) {
+				continue;
+			}
+			for (int row = 0; row < rows && laser->alive; row++) { //bullet-bullet collision
+				Ship* enemy = grid[row * columns + column];
+				if (!enemy || !enemy->alive) {
+					continue;
+				}
+				for (Bullet* bullet : enemy->bullets) {
+					if (bullet->alive && bullet->collision(*laser)) {
+						bullet->alive = false;
+						laser->alive = false;
+						break;
+					}
+				}
+			}
+		}
+		for (int column = 0; column < columns && laser->alive; column++) {
+			if (!ColumnOverlaps(column, xMin, xMax)) {
+				continue;
+			}
+			for (int row = 0; row < rows; row++) { //bullet-enemy collision
+				Ship* enemy = grid[row * columns + column];
+				if (enemy && enemy->alive && laser->collision(*enemy)) {
+					enemy->alive = false;
+					laser->alive = false;
+					break;
+				}
+			}
+		}
+	}
+
+	float playerMin = player->position[0] - 3.0f; //player is rotated by 180 degrees so it extends to the left
+	float playerMax = player->position[0];
+	for (int column = 0; column < columns; column++) { //bullet - player collision, only columns above the player
+		if (!ColumnOverlaps(column, playerMin, playerMax)) {
+			continue;
+		}
+		for (int row = 0; row < rows; row++) {
+			Ship* enemy = grid[row * columns + column];
+			if (!enemy || !enemy->alive) {
+				continue;
+			}
+			for (Bullet* bullet : enemy->bullets) {
+				if (bullet->alive && bullet->collision(*player)) {
+					player->hp -= bullet->damage;
+					player->readjustLivingStatus();
+					bullet->alive = false;
+					break;
+				}
+			}
+		}
+	}
+	RemoveDead(player);
+}
+void Formation::RemoveDead(Ship* player) { //deletes everything marked dead in one pass instead of erasing mid-loop
+	int kept = 0;
+	for (Bullet* laser : player->bullets) {
+		if (laser->alive) {
+			player->bullets[kept++] = laser;
+		}
+		else {
+			delete laser;
+		}
+	}
+	player->bullets.resize(kept);
+
+	for (int slot = 0; slot < grid.size(); slot++) {
+		if (grid[slot] && !grid[slot]->alive) {
+			grid[slot] = nullptr;
+			extentsDirty = true;
+		}
+	}
+	kept = 0;
+	for (Ship* enemy : ships) {
+		if (!enemy->alive) {
+			delete enemy;
+			continue;
+		}
+		int bulletsKept = 0;
+		for (Bullet* bullet : enemy->bullets) {
+			if (bullet->alive) {
+				enemy->bullets[bulletsKept++] = bullet;
+			}
+			else {
+				delete bullet;
+			}
+		}
+		enemy->bullets.resize(bulletsKept);
+		ships[kept++] = enemy;
+	}
+	ships.resize(kept);
+}
+void Formation::LegacyCollision(std::vector<Ship*>& enemies, Ship* player) { //previous all-pairs version, kept for the benchmark
 	for (int enemyNumber = 0; enemyNumber < enemies.size(); enemyNumber++) { //bullet-bullet collision
 		for (int bulletNumber = 0; bulletNumber < enemies[enemyNumber]->bullets.size(); bulletNumber++) {
 			for (int laserNumber = 0; laserNumber < player->bullets.size(); laserNumber++) {
@@ -337,7 +583,6 @@ void GameState::Collision() {
 			}
 		}
 	}
-
 	for (int bulletNumber = 0; bulletNumber < player->bullets.size(); bulletNumber++) { //bullet-enemy collision
 		for (int enemyNumber = 0; enemyNumber < enemies.size(); enemyNumber++) {
 			if (player->bullets[bulletNumber]->collision(*enemies[enemyNumber])) {
@@ -349,7 +594,6 @@ void GameState::Collision() {
 			}
 		}
 	}
-
 	for (int enemyNumber = 0; enemyNumber < enemies.size(); enemyNumber++) { //bullet - player collision
 		for (int bulletNumber = 0; bulletNumber < enemies[enemyNumber]->bullets.size(); bulletNumber++) {
 			if (enemies[enemyNumber]->bullets[bulletNumber]->collision(*player)) {
@@ -361,10 +605,71 @@ void GameState::Collision() {
 			}
 		}
 	}
+}
+int Formation::Benchmark(int gridColumns, int gridRows, int frames) { //no window needed, nothing here touches OpenGL
+	ShaderProgram program;
+	double legacySeconds = 0;
+	double formationSeconds = 0;
+	int legacyKills = 0;
+	int formationKills = 0;
+	for (int frame = 0; frame < frames; frame++) {
+		frameScratch.BeginFrame();
+		ScratchVector<float> textureCoordinates; //getTexture also sets up the vertices the collision checks use
+		std::vector<Ship*> legacyEnemies;
+		Formation formation(gridColumns);
+		Ship* players[2];
+		for (int copy = 0; copy < 2; copy++) { //build the same scene twice, once for each version
+			srand(frame);
+			float playerPos[3] = { 0, -6, 0 };
+			players[copy] = new Ship(program, playerPos, .03f, true);
+			players[copy]->hp = 1000000;
+			players[copy]->getTexture(textureCoordinates);
+			for (int row = 0; row < gridRows; row++) {
+				for (int column = 0; column < gridColumns; column++) {
+					float enemyPos[3] = { -14.0f + column * 5.0f + (row % 2) * 2.7f, 6.0f + row * 4.0f, 0 };
+					Ship* enemy = new Ship(program, enemyPos, 0, false);
+					enemy->getTexture(textureCoordinates);
+					if (rand() % 100 < 20) { //some ships have a bullet on the way down
+						float bulletPos[3] = { enemyPos[0] + 1.2f, enemyPos[1] - 3.0f - (float)(rand() % 1500) / 100.0f, 0 };
+						enemy->bullets.push_back(new Bullet(program, bulletPos, 4, 0.01f, false, DOWN));
+						enemy->bullets.back()->getTexture(textureCoordinates);
+					}
+					if (copy == 0) {
+						legacyEnemies.push_back(enemy);
+					}
+					else {
+						formation.Add(enemy, column, row);
+					}
+				}
+			}
+			for (int laser = 0; laser < 30; laser++) {
+				float laserPos[3] = { -14.0f + (float)(rand() % (gridColumns * 500)) / 100.0f, -5.5f + (float)(rand() % (gridRows * 400 + 1200)) / 100.0f, 0 };
+				players[copy]->bullets.push_back(new Bullet(program, laserPos, 10, 0.05f, true, UP));
+				players[copy]->bullets.back()->getTexture(textureCoordinates);
+			}
+		}
 
- 	if (player->alive == false || enemies.size() == 0) {
-		nextMode = GAME_OVER_MODE;
+		int before = legacyEnemies.size();
+		auto start = std::chrono::high_resolution_clock::now();
+		LegacyCollision(legacyEnemies, players[0]);
+		auto mid = std::chrono::high_resolution_clock::now();
+		formation.Collision(players[1]);
+		auto end = std::chrono::high_resolution_clock::now();
+		legacySeconds += std::chrono::duration<double>(mid - start).count();
+		formationSeconds += std::chrono::duration<double>(end - mid).count();
+		legacyKills += before - legacyEnemies.size();
+		formationKills += before - formation.Count();
+
+		for (Ship* enemy : legacyEnemies) {
+			delete enemy;
+		}
+		delete players[0];
+		delete players[1];
 	}
+	printf("Formation collision benchmark: %dx%d ships, 30 player bullets, %d frames\n", gridColumns, gridRows, frames);
+	printf("  all pairs  : %10.3f ms / frame, %d ships destroyed\n", 1000.0 * legacySeconds / frames, legacyKills);
+	printf("  formation  : %10.3f ms / frame, %d ships destroyed (%.1fx)\n", 1000.0 * formationSeconds / frames, formationKills, legacySeconds / formationSeconds);
+	return 0;
 }
 
 //Text Entity
@@ -373,10 +678,13 @@ TextEntity::TextEntity(ShaderProgram& shaderProgram, GLuint& textureID) {
 	texture = textureID;
 }
 void TextEntity::Draw(const std::string& text, float* position, float size) {
+	PROFILE_ZONE("TextEntity::Draw");
 	float spacing = -0.8f;
 	float texture_size = 1.0 / 16.0f;
-	std::vector<float> vertexData;
-	std::vector<float> texCoordData;
+	ScratchVector<float> vertexData;
+	ScratchVector<float> texCoordData;
+	vertexData.reserve(text.size() * 12);
+	texCoordData.reserve(text.size() * 12);
 	for (int i = 0; i < text.size(); i++) {
 		int spriteIndex = (int)text[i];
 		float texture_x = (float)(spriteIndex % 16) / 16.0f;
@@ -420,10 +728,12 @@ Entity::Entity(ShaderProgram& shaderProgram, float* pos, float rotate) {
 	modelMatrix.Identity();
 }
 void Entity::draw() {
+	PROFILE_ZONE("Entity::draw");
 	glBindTexture(GL_TEXTURE_2D, texture);
 	glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices);
 	glEnableVertexAttribArray(program->positionAttribute);
-	std::vector<float> textureCoordinates;
+	ScratchVector<float> textureCoordinates;
+	textureCoordinates.reserve(12); //getTexture adds one quad
 	getTexture(textureCoordinates);
 	glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, textureCoordinates.data());
 	glEnableVertexAttribArray(program->texCoordAttribute);
@@ -514,7 +824,7 @@ bool Bullet::collision(const Ship& ship) {
 	}
 	return true;
 }
-void Bullet::getTexture(std::vector<float>& textureCoordinates) {
+void Bullet::getTexture(ScratchVector<float>& textureCoordinates) {
 	float x, y, w, h;
 	float imageSize = 1024.0f;
 	if (isPlayers) { //laserBlue07
@@ -578,6 +888,11 @@ Ship::Ship(ShaderProgram& shaderProgram, float* pos, float xVelocity, bool playe
 	}
 }
 
+Ship::~Ship() {
+	for (Bullet* bullet : bullets) {
+		delete bullet;
+	}
+}
 void Ship::move(float elapsed, int movementDirection) {
 	direction = movementDirection;
 	KillableObject::move(elapsed);
@@ -611,7 +926,7 @@ void Ship::shoot() {
 		lastFire = ticks;
 	}
 }
-void Ship::getTexture(std::vector<float>& textureCoordinates) {
+void Ship::getTexture(ScratchVector<float>& textureCoordinates) {
 	float x, y, w, h;
 	float imageSize = 1024.0f;
 	if (isPlayer) { //enemyBlue2
@@ -661,6 +976,44 @@ void Ship::getTexture(std::vector<float>& textureCoordinates) {
 
 int main(int argc, char *argv[])
 {
+	if (argc > 1 && strcmp(argv[1], "--bench") == 0) { //collision benchmark, runs without a window
+		return Formation::Benchmark(50, 20, 200);
+	}
+	if (argc > 2 && strcmp(argv[1], "--pack") == 0) { //packing tool: --pack assets.pack file..., run in the resource folder
+		return WriteAssetPack(argv[2], argc - 3, argv + 3);
+	}
+	if (argc > 1 && strcmp(argv[1], "--decode-bench") == 0) { //PNG decoders compared: --decode-bench [iterations] [file...], the game's images by default
+		static const char* const images[] = { RESOURCE_FOLDER"font.png", RESOURCE_FOLDER"sheet.png" };
+		int first = (argc > 2 && atoi(argv[2]) > 0) ? 3 : 2;
+		int iterations = (first == 3) ? atoi(argv[2]) : DECODE_BENCH_ITERATIONS;
+		if (argc > first) {
+			return RunDecodeBenchmark(argc - first, argv + first, iterations);
+		}
+		return RunDecodeBenchmark(sizeof(images) / sizeof(images[0]), images, iterations);
+	}
+	assetPack.Open(RESOURCE_FOLDER ASSET_PACK_FILE); //textures, shaders and sounds are read from the pack if there is one
+	if (argc > 1 && strcmp(argv[1], "--compare") == 0) { //compares frames captured with --capture against golden frames
+		return RunCompare(argc, argv);
+	}
+	const char* captureDirectory = nullptr; //--capture dir [--capture-every n] writes frames for golden image comparison
+	int captureEvery = 1;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+			captureDirectory = argv[++i];
+		}
+		else if (strcmp(argv[i], "--capture-every") == 0 && i + 1 < argc) {
+			captureEvery = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--compress-textures") == 0) { //DXT5 for sheet.png, which no lossless format fits
+			SetTextureCompression(true);
+		}
+		else if (strcmp(argv[i], "--lossy-textures") == 0) { //smaller formats that are off by up to TEXTURE_LOSSY_TOLERANCE
+			SetLossyTextureFormats(true);
+		}
+	}
+	if (captureDirectory != nullptr && !PrepareCaptureDirectory(captureDirectory)) {
+		return 1;
+	}
 	SDL_Init(SDL_INIT_VIDEO);
 	displayWindow = SDL_CreateWindow("My Game", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 640, 360, SDL_WINDOW_OPENGL);
 	SDL_GLContext context = SDL_GL_CreateContext(displayWindow);
@@ -675,13 +1028,21 @@ int main(int argc, char *argv[])
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	fonts = LoadTexture(RESOURCE_FOLDER"font.png");
 	gameShapes = LoadTexture(RESOURCE_FOLDER"sheet.png");
+	FrameCapture* capture = nullptr;
+	if (captureDirectory != nullptr) {
+		capture = new FrameCapture(WINDOW_WIDTH, WINDOW_HEIGHT, captureDirectory, captureEvery);
+	}
 	bool done = false;
 	while (!done) {
 		while (SDL_PollEvent(&event)) {
 			if (event.type == SDL_QUIT || event.type == SDL_WINDOWEVENT_CLOSE) {
 				done = true;
 			}
+			else if (event.type == SDL_KEYDOWN && event.key.keysym.scancode == SDL_SCANCODE_F2) { //F2 saves the profiler's zones so far
+				PROFILE_EXPORT("profile.json");
+			}
 		}
+		frameScratch.BeginFrame();
 		game.Update(event, done);
 		glClear(GL_COLOR_BUFFER_BIT);
 		game.Draw();
@@ -693,9 +1054,29 @@ int main(int argc, char *argv[])
 
 		//glDisableVertexAttribArray(program.positionAttribute);
 
-		SDL_GL_SwapWindow(displayWindow);
+		if (capture != nullptr) {
+			capture->Capture();
+		}
+		{
+			PROFILE_ZONE("SwapWindow");
+			SDL_GL_SwapWindow(displayWindow);
+		}
 	}
+	PROFILE_EXPORT("profile.json");
+	int captureFailures = 0;
+	if (capture != nullptr) {
+		capture->Finish(); //writes the frames still in flight
+		captureFailures = capture->Failed();
+		if (captureFailures > 0) {
+			fprintf(stderr, "capture: %d frames could not be written\n", captureFailures);
+		}
+		delete capture;
+	}
+	printf("frame scratch: %u of %u bytes at most, %d overflows\n", (unsigned int)frameScratch.Peak(), (unsigned int)frameScratch.Capacity(),
+		frameScratch.Overflows());
+	textureCache.PrintStats(stdout);
+	textureMemory.Print(stdout);
 
 	SDL_Quit();
-	return 0;
+	return captureFailures > 0 ? 1 : 0;
 }